@@ -1,7 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+#include "tileconv.h"
+
 /**
  * Naive 1D convolution implementation.
  */
@@ -20,36 +23,6 @@ void naive_convolution_1d(int *A, int size_A, int *B, int size_B, int *C) {
     }
 }
 
-/**
- * Tiled 1D convolution implementation.
- */
-void tiled_convolution_1d(int *A, int size_A, int *B, int size_B, int *C, int tile_A, int tile_B) {
-    // Initialize C array elements to 0
-    for (int k = 0; k < size_A - size_B + 1; k++) {
-        C[k] = 0;
-    }
-    
-    // Process kernel B in tiles of size tile_B
-    for (register int i = 0; i < size_B / tile_B; i++) {
-        for (register int j = 0; j < size_A - size_B + 1; j++) {
-            for (register int k = 0; k < tile_B; k++) {
-                // Reversed kernel for convolution (size_B - 1 - (i * tile_B + k))
-                int kernel_idx = size_B - 1 - (i * tile_B + k);
-                C[j] += A[j + i * tile_B + k] * B[kernel_idx];
-            }
-        }
-    }
-    
-    // Process the remainder of kernel B (if size_B is not a multiple of tile_B)
-    for (register int i = 0; i < size_A - size_B + 1; i++) {
-        for (register int k = size_B - size_B % tile_B; k < size_B; k++) {
-            // Reversed kernel for convolution (size_B - 1 - k)
-            int kernel_idx = size_B - 1 - k;
-            C[i] += A[i + k] * B[kernel_idx];
-        }
-    }
-}
-
 /**
  * Helper function to print an array
  */
@@ -74,31 +47,116 @@ int arrays_equal(int *A, int *B, int size) {
     return 1;
 }
 
+/**
+ * Helper function to read the monotonic wall clock in seconds
+ */
+double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
 /**
  * Helper function to measure execution time
  */
 double measure_time(void (*func)(int*, int, int*, int, int*), int *A, int size_A, int *B, int size_B, int *C, int iterations) {
-    clock_t start, end;
-    double total_time = 0.0;
+    double start, total_time = 0.0;
     
     for (int iter = 0; iter < iterations; iter++) {
-        start = clock();
+        start = wall_time();
         func(A, size_A, B, size_B, C);
-        end = clock();
-        total_time += ((double) (end - start)) / CLOCKS_PER_SEC;
+        total_time += wall_time() - start;
+    }
+    
+    return total_time / iterations;
+}
+
+/**
+ * Helper function to measure execution time of a prepared plan.
+ * The plan is created once outside the timed region, as a long-running caller would.
+ */
+double measure_time_plan(const tc_plan *plan, int *A, int *C, int iterations) {
+    double start, total_time = 0.0;
+    
+    for (int iter = 0; iter < iterations; iter++) {
+        start = wall_time();
+        tc_execute(plan, A, C);
+        total_time += wall_time() - start;
     }
     
     return total_time / iterations;
 }
 
 /**
- * Wrapper for tiled convolution to match the function signature for timing
+ * Helper function to open hardware counters when TILECONV_PERF is set to a value other than 0
+ */
+tc_perf *open_counters(void) {
+    const char *env = getenv("TILECONV_PERF");
+    if (!env || strcmp(env, "0") == 0) {
+        return NULL;
+    }
+    tc_perf *perf = tc_perf_open();
+    if (!perf) {
+        printf("Hardware counters are not available on this system\n");
+    }
+    return perf;
+}
+
+/**
+ * Helper function to count one run of a prepared plan and print IPC and misses per MAC
  */
-void tiled_wrapper(int *A, int size_A, int *B, int size_B, int *C) {
-    // Use fixed tile sizes for the wrapper
-    int tile_A = 64;
-    int tile_B = 32;
-    tiled_convolution_1d(A, size_A, B, size_B, C, tile_A, tile_B);
+void count_plan(tc_perf *perf, const char *label, const tc_plan *plan, int *A, int *C, double macs) {
+    tc_perf_counts counts;
+    tc_perf_start(perf);
+    tc_execute(plan, A, C);
+    tc_perf_stop(perf, &counts);
+    tc_perf_print(label, &counts, macs);
+}
+
+/**
+ * Helper function to run the streaming API on A in random-sized chunks,
+ * as a sensor feed would deliver it, and check the outputs against expected.
+ * Reports the time until the first output and the total streaming time.
+ */
+void run_streaming(int *A, int size_A, int *B, int size_B, int *expected, const tc_options *opts, const char *label) {
+    tc_stream *stream = tc_stream_create(TC_CONVOLUTION, B, size_B, 0, opts);
+    int max_chunk = 4096;
+    int *out = (int*)malloc((max_chunk + (stream ? tc_stream_latency(stream) : 0)) * sizeof(int));
+    if (!stream || !out) {
+        printf("Failed to create %s stream\n", label);
+        tc_stream_destroy(stream);
+        free(out);
+        return;
+    }
+    
+    int size_C = size_A - size_B + 1;
+    int produced = 0, matches = 1;
+    double first_output = -1.0;
+    double start = wall_time();
+    for (int pos = 0; pos < size_A; ) {
+        int count = 1 + rand() % max_chunk;
+        if (count > size_A - pos) count = size_A - pos;
+        int written = tc_stream_push(stream, A + pos, count, out);
+        if (pos + count == size_A) {
+            written += tc_stream_flush(stream, out + written);
+        }
+        if (written > 0 && first_output < 0) {
+            first_output = wall_time() - start;
+        }
+        for (int i = 0; i < written; i++) {
+            if (produced + i >= size_C || out[i] != expected[produced + i]) matches = 0;
+        }
+        produced += written;
+        pos += count;
+    }
+    double total = wall_time() - start;
+    if (produced != size_C) matches = 0;
+    
+    printf("Streaming (%s, chunks of 1-%d samples): first output after %.6f seconds, %.6f seconds total, %s\n",
+           label, max_chunk, first_output, total, matches ? "matches naive" : "MISMATCH");
+    
+    tc_stream_destroy(stream);
+    free(out);
 }
 
 int main() {
@@ -148,7 +206,25 @@ int main() {
     
     // Perform both convolution methods
     naive_convolution_1d(A, size_A, B, size_B, C_naive);
-    tiled_convolution_1d(A, size_A, B, size_B, C_tiled, tile_A, tile_B);
+    
+    // Build the tiled plan once; it is reused for the timing runs below
+    tc_options opts;
+    tc_options_init(&opts);
+    opts.tile_A[0] = tile_A;
+    opts.tile_B[0] = tile_B;
+    opts.engine = TC_ENGINE_DIRECT;
+    // Declare the input range so the plan can prove its accumulator cannot overflow
+    opts.input_min = 0;
+    opts.input_max = 99;
+    tc_plan *plan = tc_plan_create_1d(TC_CONVOLUTION, size_A, B, size_B, &opts);
+    if (!plan) {
+        printf("Failed to create tiled convolution plan\n");
+        return 1;
+    }
+    printf("Accumulator: %s (%s for inputs in [0, 99])\n",
+           tc_plan_accum(plan) == TC_ACCUM_INT64 ? "int64" : "int32",
+           tc_plan_overflow_free(plan) ? "overflow-free" : "may overflow");
+    tc_execute(plan, A, C_tiled);
     
     // Verify correctness
     if (!arrays_equal(C_naive, C_tiled, size_A - size_B + 1)) {
@@ -177,13 +253,54 @@ int main() {
     printf("Running performance test with %d iterations...\n", iterations);
     
     double naive_time = measure_time(naive_convolution_1d, A, size_A, B, size_B, C_naive, iterations);
-    double tiled_time = measure_time(tiled_wrapper, A, size_A, B, size_B, C_tiled, iterations);
+    double tiled_time = measure_time_plan(plan, A, C_tiled, iterations);
     
     printf("Naive implementation: %.6f seconds per run\n", naive_time);
     printf("Tiled implementation: %.6f seconds per run\n", tiled_time);
     printf("Speedup: %.2fx\n", naive_time / tiled_time);
     
+    // Optional hardware counters for one run of each version
+    tc_perf *perf = open_counters();
+    double macs = (double)(size_A - size_B + 1) * size_B;
+    if (perf) {
+        tc_perf_counts counts;
+        tc_perf_start(perf);
+        naive_convolution_1d(A, size_A, B, size_B, C_naive);
+        tc_perf_stop(perf, &counts);
+        tc_perf_print("naive", &counts, macs);
+        count_plan(perf, "tiled", plan, A, C_tiled, macs);
+    }
+    
+    // Let the library choose between direct and FFT for this shape
+    tc_plan *auto_plan = tc_plan_create_1d(TC_CONVOLUTION, size_A, B, size_B, NULL);
+    if (auto_plan) {
+        int *C_auto = (int*)malloc((size_A - size_B + 1) * sizeof(int));
+        if (C_auto) {
+            tc_execute(auto_plan, A, C_auto);
+            double auto_time = measure_time_plan(auto_plan, A, C_auto, iterations);
+            printf("Auto-selected engine (%s): %.6f seconds per run, %s\n",
+                   tc_plan_engine(auto_plan) == TC_ENGINE_FFT ? "FFT" : "direct", auto_time,
+                   arrays_equal(C_naive, C_auto, size_A - size_B + 1) ? "matches naive" : "MISMATCH");
+            printf("Auto speedup over naive: %.2fx\n", naive_time / auto_time);
+            if (perf) {
+                count_plan(perf, "auto", auto_plan, A, C_auto, macs);
+            }
+            free(C_auto);
+        }
+        tc_plan_destroy(auto_plan);
+    }
+    
+    // Stream the same input through the overlap-save streaming API
+    tc_options stream_opts;
+    tc_options_init(&stream_opts);
+    stream_opts.engine = TC_ENGINE_DIRECT;
+    run_streaming(A, size_A, B, size_B, C_naive, &stream_opts, "direct");
+    stream_opts.engine = TC_ENGINE_FFT;
+    run_streaming(A, size_A, B, size_B, C_naive, &stream_opts, "FFT");
+    
     // Free allocated memory
+    tc_perf_close(perf);
+    tc_plan_destroy(plan);
     free(A);
     free(B);
     free(C_naive);
@@ -1,137 +1,72 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+#include "tileconv.h"
+
 /**
- * Naive 2D convolution implementation.
+ * Naive 2D convolution implementation on pitched matrices.
+ * Each output row and each input row is addressed once through its row pointer.
  */
-void naive_convolution_2d(int **A, int height_A, int width_A, 
-                         int **B, int height_B, int width_B, 
-                         int **C) {
-    // Initialize C matrix elements to 0
-    for (int i = 0; i < height_A - height_B + 1; i++) {
-        for (int j = 0; j < width_A - width_B + 1; j++) {
-            C[i][j] = 0;
-        }
-    }
+void naive_convolution_2d(const tc_matrix *A, const tc_matrix *B, tc_matrix *C) {
+    int height_B = B->height, width_B = B->width;
     
     // Perform 2D convolution
-    for (int i = 0; i < height_A - height_B + 1; i++) {
-        for (int j = 0; j < width_A - width_B + 1; j++) {
+    for (int i = 0; i < C->height; i++) {
+        int *c_row = &TC_AT(C, i, 0);
+        for (int j = 0; j < C->width; j++) {
+            int sum = 0;
             for (int ki = 0; ki < height_B; ki++) {
+                const int *a_row = &TC_AT(A, i + ki, j);
+                const int *b_row = &TC_AT(B, height_B - 1 - ki, 0);
                 for (int kj = 0; kj < width_B; kj++) {
                     // Note: Kernel is flipped both horizontally and vertically for convolution
-                    C[i][j] += A[i + ki][j + kj] * B[height_B - 1 - ki][width_B - 1 - kj];
+                    sum += a_row[kj] * b_row[width_B - 1 - kj];
                 }
             }
+            c_row[j] = sum;
         }
     }
 }
 
 /**
- * Tiled 2D convolution implementation.
+ * Helper function to allocate a 2D matrix, exiting on failure
  */
-void tiled_convolution_2d(int **A, int height_A, int width_A, 
-                         int **B, int height_B, int width_B, 
-                         int **C, int tile_height, int tile_width) {
-    // Initialize C matrix elements to 0
-    for (int i = 0; i < height_A - height_B + 1; i++) {
-        for (int j = 0; j < width_A - width_B + 1; j++) {
-            C[i][j] = 0;
-        }
-    }
-    
-    // Output height and width
-    int height_C = height_A - height_B + 1;
-    int width_C = width_A - width_B + 1;
-    
-    // Process output matrix in tiles
-    for (int i_tile = 0; i_tile < height_C; i_tile += tile_height) {
-        for (int j_tile = 0; j_tile < width_C; j_tile += tile_width) {
-            // Determine the actual tile size (handle edge tiles)
-            int curr_tile_height = (i_tile + tile_height > height_C) ? height_C - i_tile : tile_height;
-            int curr_tile_width = (j_tile + tile_width > width_C) ? width_C - j_tile : tile_width;
-            
-            // For each tile, process all kernel elements
-            for (int ki = 0; ki < height_B; ki++) {
-                for (int kj = 0; kj < width_B; kj++) {
-                    // Compute kernel element value (flipped for convolution)
-                    int kernel_val = B[height_B - 1 - ki][width_B - 1 - kj];
-                    
-                    // Apply kernel element to the current tile
-                    for (int i_local = 0; i_local < curr_tile_height; i_local++) {
-                        for (int j_local = 0; j_local < curr_tile_width; j_local++) {
-                            int i_global = i_tile + i_local;
-                            int j_global = j_tile + j_local;
-                            
-                            C[i_global][j_global] += A[i_global + ki][j_global + kj] * kernel_val;
-                        }
-                    }
-                }
-            }
-        }
-    }
-}
-
-/**
- * Helper function to allocate a 2D array
- */
-int** allocate_2d_array(int height, int width) {
-    int **array = (int**)malloc(height * sizeof(int*));
-    if (!array) {
+tc_matrix *allocate_matrix(int height, int width) {
+    tc_matrix *m = tc_matrix_create(height, width);
+    if (!m) {
         printf("Memory allocation failed\n");
         exit(1);
     }
-    
-    for (int i = 0; i < height; i++) {
-        array[i] = (int*)malloc(width * sizeof(int));
-        if (!array[i]) {
-            printf("Memory allocation failed\n");
-            exit(1);
-        }
-    }
-    
-    return array;
+    return m;
 }
 
 /**
- * Helper function to free a 2D array
+ * Helper function to print a 2D matrix
  */
-void free_2d_array(int **array, int height) {
-    if (!array) return;
-    
-    for (int i = 0; i < height; i++) {
-        if (array[i]) free(array[i]);
-    }
-    
-    free(array);
-}
-
-/**
- * Helper function to print a 2D array
- */
-void print_2d_array(int **array, int height, int width, const char *name) {
+void print_matrix(const tc_matrix *m, const char *name) {
     printf("%s = [\n", name);
-    for (int i = 0; i < height; i++) {
+    for (int i = 0; i < m->height; i++) {
         printf("  [");
-        for (int j = 0; j < width; j++) {
-            printf("%d", array[i][j]);
-            if (j < width - 1) printf(", ");
+        for (int j = 0; j < m->width; j++) {
+            printf("%d", TC_AT(m, i, j));
+            if (j < m->width - 1) printf(", ");
         }
         printf("]");
-        if (i < height - 1) printf(",");
+        if (i < m->height - 1) printf(",");
         printf("\n");
     }
     printf("]\n");
 }
 
 /**
- * Helper function to check if two 2D arrays are equal
+ * Helper function to check if two 2D matrices are equal
  */
-int arrays_2d_equal(int **A, int **B, int height, int width) {
-    for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-            if (A[i][j] != B[i][j]) {
+int matrices_equal(const tc_matrix *A, const tc_matrix *B) {
+    for (int i = 0; i < A->height; i++) {
+        for (int j = 0; j < A->width; j++) {
+            if (TC_AT(A, i, j) != TC_AT(B, i, j)) {
                 return 0;
             }
         }
@@ -139,20 +74,52 @@ int arrays_2d_equal(int **A, int **B, int height, int width) {
     return 1;
 }
 
+/**
+ * Helper function to read the wall clock. CPU time (clock()) would add up the
+ * time of all threads and hide any parallel speedup.
+ */
+double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Helper function to open hardware counters when TILECONV_PERF is set to a value other than 0
+ */
+tc_perf *open_counters(void) {
+    const char *env = getenv("TILECONV_PERF");
+    if (!env || strcmp(env, "0") == 0) {
+        return NULL;
+    }
+    tc_perf *perf = tc_perf_open();
+    if (!perf) {
+        printf("Hardware counters are not available on this system\n");
+    }
+    return perf;
+}
+
+/**
+ * Helper function to count one run of a prepared plan and print IPC and misses per MAC
+ */
+void count_plan(tc_perf *perf, const char *label, const tc_plan *plan, const tc_matrix *A, tc_matrix *C, double macs) {
+    tc_perf_counts counts;
+    tc_perf_start(perf);
+    tc_execute_2d(plan, A, C);
+    tc_perf_stop(perf, &counts);
+    tc_perf_print(label, &counts, macs);
+}
+
 /**
  * Helper function to measure execution time for naive 2D convolution
  */
-double measure_time_naive(int **A, int height_A, int width_A, 
-                         int **B, int height_B, int width_B, 
-                         int **C, int iterations) {
-    clock_t start, end;
-    double total_time = 0.0;
+double measure_time_naive(const tc_matrix *A, const tc_matrix *B, tc_matrix *C, int iterations) {
+    double start, total_time = 0.0;
     
     for (int iter = 0; iter < iterations; iter++) {
-        start = clock();
-        naive_convolution_2d(A, height_A, width_A, B, height_B, width_B, C);
-        end = clock();
-        total_time += ((double) (end - start)) / CLOCKS_PER_SEC;
+        start = wall_time();
+        naive_convolution_2d(A, B, C);
+        total_time += wall_time() - start;
     }
     
     return total_time / iterations;
@@ -161,17 +128,13 @@ double measure_time_naive(int **A, int height_A, int width_A,
 /**
  * Helper function to measure execution time for tiled 2D convolution
  */
-double measure_time_tiled(int **A, int height_A, int width_A, 
-                         int **B, int height_B, int width_B, 
-                         int **C, int tile_height, int tile_width, int iterations) {
-    clock_t start, end;
-    double total_time = 0.0;
+double measure_time_tiled(const tc_plan *plan, const tc_matrix *A, tc_matrix *C, int iterations) {
+    double start, total_time = 0.0;
     
     for (int iter = 0; iter < iterations; iter++) {
-        start = clock();
-        tiled_convolution_2d(A, height_A, width_A, B, height_B, width_B, C, tile_height, tile_width);
-        end = clock();
-        total_time += ((double) (end - start)) / CLOCKS_PER_SEC;
+        start = wall_time();
+        tc_execute_2d(plan, A, C);
+        total_time += wall_time() - start;
     }
     
     return total_time / iterations;
@@ -207,42 +170,70 @@ int main() {
     printf("Enter tile width: ");
     scanf("%d", &tile_width);
     
+    // Older input scripts stop after the tile sizes; run single-threaded then
+    int max_threads;
+    printf("Enter maximum number of threads: ");
+    if (scanf("%d", &max_threads) != 1 || max_threads < 1) {
+        max_threads = 1;
+    }
+    
     // Allocate memory for matrices
-    int **A = allocate_2d_array(height_A, width_A);
-    int **B = allocate_2d_array(height_B, width_B);
-    int **C_naive = allocate_2d_array(height_A - height_B + 1, width_A - width_B + 1);
-    int **C_tiled = allocate_2d_array(height_A - height_B + 1, width_A - width_B + 1);
+    int height_C = height_A - height_B + 1;
+    int width_C = width_A - width_B + 1;
+    tc_matrix *A = allocate_matrix(height_A, width_A);
+    tc_matrix *B = allocate_matrix(height_B, width_B);
+    tc_matrix *C_naive = allocate_matrix(height_C, width_C);
+    tc_matrix *C_tiled = allocate_matrix(height_C, width_C);
     
     // Initialize matrices with random values
     srand(time(NULL));
     for (int i = 0; i < height_A; i++) {
         for (int j = 0; j < width_A; j++) {
-            A[i][j] = rand() % 100;
+            TC_AT(A, i, j) = rand() % 100;
+        }
+    }
+    
+    for (int i = 0; i < height_B; i++) {
+        for (int j = 0; j < width_B; j++) {
+            TC_AT(B, i, j) = rand() % 10;
         }
     }
     
+    // Build the tiled plan once from a dense copy of the kernel
+    int *packed_B = (int *)malloc(height_B * width_B * sizeof(int));
+    if (!packed_B) {
+        printf("Memory allocation failed\n");
+        return 1;
+    }
     for (int i = 0; i < height_B; i++) {
         for (int j = 0; j < width_B; j++) {
-            B[i][j] = rand() % 10;
+            packed_B[i * width_B + j] = TC_AT(B, i, j);
         }
     }
     
+    tc_options opts;
+    tc_options_init(&opts);
+    opts.tile_A[0] = tile_width;
+    opts.tile_A[1] = tile_height;
+    tc_plan *plan = tc_plan_create_2d(TC_CONVOLUTION, height_A, width_A, packed_B, height_B, width_B, &opts);
+    if (!plan) {
+        printf("Failed to create tiled 2D convolution plan\n");
+        return 1;
+    }
+    
     // Perform both convolution methods
-    naive_convolution_2d(A, height_A, width_A, B, height_B, width_B, C_naive);
-    tiled_convolution_2d(A, height_A, width_A, B, height_B, width_B, C_tiled, tile_height, tile_width);
+    naive_convolution_2d(A, B, C_naive);
+    tc_execute_2d(plan, A, C_tiled);
     
     // Verify correctness
-    int height_C = height_A - height_B + 1;
-    int width_C = width_A - width_B + 1;
-    
-    if (!arrays_2d_equal(C_naive, C_tiled, height_C, width_C)) {
+    if (!matrices_equal(C_naive, C_tiled)) {
         printf("ERROR: Naive and tiled implementations produce different results!\n");
         
         // Print a small section of both results for debugging
         printf("Top-left 3x3 corner of naive result:\n");
         for (int i = 0; i < 3 && i < height_C; i++) {
             for (int j = 0; j < 3 && j < width_C; j++) {
-                printf("%d ", C_naive[i][j]);
+                printf("%d ", TC_AT(C_naive, i, j));
             }
             printf("\n");
         }
@@ -250,7 +241,7 @@ int main() {
         printf("\nTop-left 3x3 corner of tiled result:\n");
         for (int i = 0; i < 3 && i < height_C; i++) {
             for (int j = 0; j < 3 && j < width_C; j++) {
-                printf("%d ", C_tiled[i][j]);
+                printf("%d ", TC_AT(C_tiled, i, j));
             }
             printf("\n");
         }
@@ -264,18 +255,62 @@ int main() {
     int iterations = 5;
     printf("Running performance test with %d iterations...\n", iterations);
     
-    double naive_time = measure_time_naive(A, height_A, width_A, B, height_B, width_B, C_naive, iterations);
-    double tiled_time = measure_time_tiled(A, height_A, width_A, B, height_B, width_B, C_tiled, tile_height, tile_width, iterations);
+    double naive_time = measure_time_naive(A, B, C_naive, iterations);
+    double tiled_time = measure_time_tiled(plan, A, C_tiled, iterations);
     
     printf("Naive implementation: %.6f seconds per run\n", naive_time);
     printf("Tiled implementation: %.6f seconds per run\n", tiled_time);
     printf("Speedup: %.2fx\n", naive_time / tiled_time);
     
+    // Optional hardware counters for one run of each version; opened before
+    // the threaded plans below so their worker threads are counted too
+    tc_perf *perf = open_counters();
+    double macs = (double)height_C * width_C * height_B * width_B;
+    if (perf) {
+        tc_perf_counts counts;
+        tc_perf_start(perf);
+        naive_convolution_2d(A, B, C_naive);
+        tc_perf_stop(perf, &counts);
+        tc_perf_print("naive", &counts, macs);
+        count_plan(perf, "tiled", plan, A, C_tiled, macs);
+    }
+    
+    // Scale the tiled plan over threads: 1, 2, 4, ... up to max_threads
+    if (max_threads > 1) {
+        printf("\nThread scaling (output tiles shared between threads):\n");
+        double single_time = 0.0;
+        for (int threads = 1; ; threads *= 2) {
+            if (threads > max_threads) threads = max_threads;
+            tc_options thread_opts = opts;
+            thread_opts.threads = threads;
+            tc_plan *thread_plan = tc_plan_create_2d(TC_CONVOLUTION, height_A, width_A, packed_B, height_B, width_B, &thread_opts);
+            if (!thread_plan) {
+                printf("Failed to create %d-thread plan\n", threads);
+                break;
+            }
+            tc_execute_2d(thread_plan, A, C_tiled);
+            int correct = matrices_equal(C_naive, C_tiled);
+            double thread_time = measure_time_tiled(thread_plan, A, C_tiled, iterations);
+            if (threads == 1) single_time = thread_time;
+            printf("  %3d threads: %.6f seconds per run, %.2fx vs 1 thread, %.2fx vs naive%s\n",
+                   threads, thread_time, single_time / thread_time, naive_time / thread_time,
+                   correct ? "" : " (MISMATCH)");
+            if (perf) {
+                count_plan(perf, "threaded", thread_plan, A, C_tiled, macs);
+            }
+            tc_plan_destroy(thread_plan);
+            if (threads == max_threads) break;
+        }
+    }
+    
     // Free allocated memory
-    free_2d_array(A, height_A);
-    free_2d_array(B, height_B);
-    free_2d_array(C_naive, height_C);
-    free_2d_array(C_tiled, height_C);
+    tc_perf_close(perf);
+    tc_plan_destroy(plan);
+    free(packed_B);
+    tc_matrix_destroy(A);
+    tc_matrix_destroy(B);
+    tc_matrix_destroy(C_naive);
+    tc_matrix_destroy(C_tiled);
     
     return 0;
 } 
\ No newline at end of file
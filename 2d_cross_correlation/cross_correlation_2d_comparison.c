@@ -0,0 +1,316 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tileconv.h"
+
+/**
+ * Naive 2D cross-correlation implementation on pitched matrices.
+ * Each output row and each input row is addressed once through its row pointer.
+ */
+void naive_cross_correlation_2d(const tc_matrix *A, const tc_matrix *B, tc_matrix *C) {
+    int height_B = B->height, width_B = B->width;
+    
+    // Perform 2D cross-correlation
+    for (int i = 0; i < C->height; i++) {
+        int *c_row = &TC_AT(C, i, 0);
+        for (int j = 0; j < C->width; j++) {
+            int sum = 0;
+            for (int ki = 0; ki < height_B; ki++) {
+                const int *a_row = &TC_AT(A, i + ki, j);
+                const int *b_row = &TC_AT(B, ki, 0);
+                for (int kj = 0; kj < width_B; kj++) {
+                    // Note: Unlike convolution, the kernel is applied without flipping
+                    sum += a_row[kj] * b_row[kj];
+                }
+            }
+            c_row[j] = sum;
+        }
+    }
+}
+
+/**
+ * Helper function to allocate a 2D matrix, exiting on failure
+ */
+tc_matrix *allocate_matrix(int height, int width) {
+    tc_matrix *m = tc_matrix_create(height, width);
+    if (!m) {
+        printf("Memory allocation failed\n");
+        exit(1);
+    }
+    return m;
+}
+
+/**
+ * Helper function to print a 2D matrix
+ */
+void print_matrix(const tc_matrix *m, const char *name) {
+    printf("%s = [\n", name);
+    for (int i = 0; i < m->height; i++) {
+        printf("  [");
+        for (int j = 0; j < m->width; j++) {
+            printf("%d", TC_AT(m, i, j));
+            if (j < m->width - 1) printf(", ");
+        }
+        printf("]");
+        if (i < m->height - 1) printf(",");
+        printf("\n");
+    }
+    printf("]\n");
+}
+
+/**
+ * Helper function to check if two 2D matrices are equal
+ */
+int matrices_equal(const tc_matrix *A, const tc_matrix *B) {
+    for (int i = 0; i < A->height; i++) {
+        for (int j = 0; j < A->width; j++) {
+            if (TC_AT(A, i, j) != TC_AT(B, i, j)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * Helper function to read the wall clock. CPU time (clock()) would add up the
+ * time of all threads and hide any parallel speedup.
+ */
+double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Helper function to open hardware counters when TILECONV_PERF is set to a value other than 0
+ */
+tc_perf *open_counters(void) {
+    const char *env = getenv("TILECONV_PERF");
+    if (!env || strcmp(env, "0") == 0) {
+        return NULL;
+    }
+    tc_perf *perf = tc_perf_open();
+    if (!perf) {
+        printf("Hardware counters are not available on this system\n");
+    }
+    return perf;
+}
+
+/**
+ * Helper function to count one run of a prepared plan and print IPC and misses per MAC
+ */
+void count_plan(tc_perf *perf, const char *label, const tc_plan *plan, const tc_matrix *A, tc_matrix *C, double macs) {
+    tc_perf_counts counts;
+    tc_perf_start(perf);
+    tc_execute_2d(plan, A, C);
+    tc_perf_stop(perf, &counts);
+    tc_perf_print(label, &counts, macs);
+}
+
+/**
+ * Helper function to measure execution time for naive 2D cross-correlation
+ */
+double measure_time_naive(const tc_matrix *A, const tc_matrix *B, tc_matrix *C, int iterations) {
+    double start, total_time = 0.0;
+    
+    for (int iter = 0; iter < iterations; iter++) {
+        start = wall_time();
+        naive_cross_correlation_2d(A, B, C);
+        total_time += wall_time() - start;
+    }
+    
+    return total_time / iterations;
+}
+
+/**
+ * Helper function to measure execution time for tiled 2D cross-correlation
+ */
+double measure_time_tiled(const tc_plan *plan, const tc_matrix *A, tc_matrix *C, int iterations) {
+    double start, total_time = 0.0;
+    
+    for (int iter = 0; iter < iterations; iter++) {
+        start = wall_time();
+        tc_execute_2d(plan, A, C);
+        total_time += wall_time() - start;
+    }
+    
+    return total_time / iterations;
+}
+
+int main() {
+    printf("=== 2D Cross-Correlation Performance Comparison ===\n\n");
+    
+    // Get matrix dimensions from user
+    int height_A, width_A, height_B, width_B, tile_height, tile_width;
+    
+    printf("Enter height of input matrix A: ");
+    scanf("%d", &height_A);
+    
+    printf("Enter width of input matrix A: ");
+    scanf("%d", &width_A);
+    
+    printf("Enter height of kernel B: ");
+    scanf("%d", &height_B);
+    
+    printf("Enter width of kernel B: ");
+    scanf("%d", &width_B);
+    
+    // Validate dimensions
+    if (height_B > height_A || width_B > width_A) {
+        printf("Error: Kernel dimensions must be less than or equal to input dimensions\n");
+        return 1;
+    }
+    
+    printf("Enter tile height: ");
+    scanf("%d", &tile_height);
+    
+    printf("Enter tile width: ");
+    scanf("%d", &tile_width);
+    
+    // Older input scripts stop after the tile sizes; run single-threaded then
+    int max_threads;
+    printf("Enter maximum number of threads: ");
+    if (scanf("%d", &max_threads) != 1 || max_threads < 1) {
+        max_threads = 1;
+    }
+    
+    // Allocate memory for matrices
+    int height_C = height_A - height_B + 1;
+    int width_C = width_A - width_B + 1;
+    tc_matrix *A = allocate_matrix(height_A, width_A);
+    tc_matrix *B = allocate_matrix(height_B, width_B);
+    tc_matrix *C_naive = allocate_matrix(height_C, width_C);
+    tc_matrix *C_tiled = allocate_matrix(height_C, width_C);
+    
+    // Initialize matrices with random values
+    srand(time(NULL));
+    for (int i = 0; i < height_A; i++) {
+        for (int j = 0; j < width_A; j++) {
+            TC_AT(A, i, j) = rand() % 100;
+        }
+    }
+    
+    for (int i = 0; i < height_B; i++) {
+        for (int j = 0; j < width_B; j++) {
+            TC_AT(B, i, j) = rand() % 10;
+        }
+    }
+    
+    // Build the tiled plan once from a dense copy of the kernel
+    int *packed_B = (int *)malloc(height_B * width_B * sizeof(int));
+    if (!packed_B) {
+        printf("Memory allocation failed\n");
+        return 1;
+    }
+    for (int i = 0; i < height_B; i++) {
+        for (int j = 0; j < width_B; j++) {
+            packed_B[i * width_B + j] = TC_AT(B, i, j);
+        }
+    }
+    
+    tc_options opts;
+    tc_options_init(&opts);
+    opts.tile_A[0] = tile_width;
+    opts.tile_A[1] = tile_height;
+    tc_plan *plan = tc_plan_create_2d(TC_CROSS_CORRELATION, height_A, width_A, packed_B, height_B, width_B, &opts);
+    if (!plan) {
+        printf("Failed to create tiled 2D cross-correlation plan\n");
+        return 1;
+    }
+    
+    // Perform both cross-correlation methods
+    naive_cross_correlation_2d(A, B, C_naive);
+    tc_execute_2d(plan, A, C_tiled);
+    
+    // Verify correctness
+    if (!matrices_equal(C_naive, C_tiled)) {
+        printf("ERROR: Naive and tiled implementations produce different results!\n");
+        
+        // Print a small section of both results for debugging
+        printf("Top-left 3x3 corner of naive result:\n");
+        for (int i = 0; i < 3 && i < height_C; i++) {
+            for (int j = 0; j < 3 && j < width_C; j++) {
+                printf("%d ", TC_AT(C_naive, i, j));
+            }
+            printf("\n");
+        }
+        
+        printf("\nTop-left 3x3 corner of tiled result:\n");
+        for (int i = 0; i < 3 && i < height_C; i++) {
+            for (int j = 0; j < 3 && j < width_C; j++) {
+                printf("%d ", TC_AT(C_tiled, i, j));
+            }
+            printf("\n");
+        }
+        
+        return 1;
+    }
+    
+    printf("Naive and tiled implementations produce identical results.\n\n");
+    
+    // Measure performance
+    int iterations = 5;
+    printf("Running performance test with %d iterations...\n", iterations);
+    
+    double naive_time = measure_time_naive(A, B, C_naive, iterations);
+    double tiled_time = measure_time_tiled(plan, A, C_tiled, iterations);
+    
+    printf("Naive implementation: %.6f seconds per run\n", naive_time);
+    printf("Tiled implementation: %.6f seconds per run\n", tiled_time);
+    printf("Speedup: %.2fx\n", naive_time / tiled_time);
+    
+    // Optional hardware counters for one run of each version; opened before
+    // the threaded plans below so their worker threads are counted too
+    tc_perf *perf = open_counters();
+    double macs = (double)height_C * width_C * height_B * width_B;
+    if (perf) {
+        tc_perf_counts counts;
+        tc_perf_start(perf);
+        naive_cross_correlation_2d(A, B, C_naive);
+        tc_perf_stop(perf, &counts);
+        tc_perf_print("naive", &counts, macs);
+        count_plan(perf, "tiled", plan, A, C_tiled, macs);
+    }
+    
+    // Scale the tiled plan over threads: 1, 2, 4, ... up to max_threads
+    if (max_threads > 1) {
+        printf("\nThread scaling (output tiles shared between threads):\n");
+        double single_time = 0.0;
+        for (int threads = 1; ; threads *= 2) {
+            if (threads > max_threads) threads = max_threads;
+            tc_options thread_opts = opts;
+            thread_opts.threads = threads;
+            tc_plan *thread_plan = tc_plan_create_2d(TC_CROSS_CORRELATION, height_A, width_A, packed_B, height_B, width_B, &thread_opts);
+            if (!thread_plan) {
+                printf("Failed to create %d-thread plan\n", threads);
+                break;
+            }
+            tc_execute_2d(thread_plan, A, C_tiled);
+            int correct = matrices_equal(C_naive, C_tiled);
+            double thread_time = measure_time_tiled(thread_plan, A, C_tiled, iterations);
+            if (threads == 1) single_time = thread_time;
+            printf("  %3d threads: %.6f seconds per run, %.2fx vs 1 thread, %.2fx vs naive%s\n",
+                   threads, thread_time, single_time / thread_time, naive_time / thread_time,
+                   correct ? "" : " (MISMATCH)");
+            if (perf) {
+                count_plan(perf, "threaded", thread_plan, A, C_tiled, macs);
+            }
+            tc_plan_destroy(thread_plan);
+            if (threads == max_threads) break;
+        }
+    }
+    
+    // Free allocated memory
+    tc_perf_close(perf);
+    tc_plan_destroy(plan);
+    free(packed_B);
+    tc_matrix_destroy(A);
+    tc_matrix_destroy(B);
+    tc_matrix_destroy(C_naive);
+    tc_matrix_destroy(C_tiled);
+    
+    return 0;
+} 
\ No newline at end of file
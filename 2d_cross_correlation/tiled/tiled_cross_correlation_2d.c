@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tileconv.h"
+
+/*
+ * tiled_cross_correlation_2d comes from the tileconv library (lib/compat.c):
+ * it runs the same plan-based engine as convolution, with the kernel applied
+ * as given instead of flipped.
+ */
+
+/**
+ * Reads one integer from stdin, exiting when the input is not a number.
+ */
+static int read_int(const char *prompt) {
+    int value;
+    printf("%s", prompt);
+    if (scanf("%d", &value) != 1) {
+        printf("Error: expected an integer\n");
+        exit(1);
+    }
+    return value;
+}
+
+/**
+ * Helper function to allocate a 2D array
+ */
+int** allocate_2d_array(int height, int width) {
+    int **array = (int**)malloc(height * sizeof(int*));
+    if (!array) {
+        printf("Memory allocation failed\n");
+        exit(1);
+    }
+    
+    for (int i = 0; i < height; i++) {
+        array[i] = (int*)malloc(width * sizeof(int));
+        if (!array[i]) {
+            printf("Memory allocation failed\n");
+            exit(1);
+        }
+    }
+    
+    return array;
+}
+
+/**
+ * Helper function to free a 2D array
+ */
+void free_2d_array(int **array, int height) {
+    if (!array) return;
+    
+    for (int i = 0; i < height; i++) {
+        if (array[i]) free(array[i]);
+    }
+    
+    free(array);
+}
+
+/**
+ * Helper function to print a 2D array
+ */
+void print_2d_array(int **array, int height, int width, const char *name) {
+    printf("%s = [\n", name);
+    for (int i = 0; i < height; i++) {
+        printf("  [");
+        for (int j = 0; j < width; j++) {
+            printf("%d", array[i][j]);
+            if (j < width - 1) printf(", ");
+        }
+        printf("]");
+        if (i < height - 1) printf(",");
+        printf("\n");
+    }
+    printf("]\n");
+}
+
+int main() {
+    // Example matrices
+    int height_A = 5, width_A = 5;
+    int height_B = 3, width_B = 3;
+    int tile_height = 2, tile_width = 2;
+    
+    // Allocate and initialize example matrices
+    int **A = allocate_2d_array(height_A, width_A);
+    int **B = allocate_2d_array(height_B, width_B);
+    int **C = allocate_2d_array(height_A - height_B + 1, width_A - width_B + 1);
+    
+    // Example input matrix
+    int A_data[5][5] = {
+        {1, 2, 3, 4, 5},
+        {6, 7, 8, 9, 10},
+        {11, 12, 13, 14, 15},
+        {16, 17, 18, 19, 20},
+        {21, 22, 23, 24, 25}
+    };
+    
+    // Example kernel matrix
+    int B_data[3][3] = {
+        {1, 0, -1},
+        {2, 0, -2},
+        {1, 0, -1}
+    };
+    
+    // Copy data to allocated matrices
+    for (int i = 0; i < height_A; i++) {
+        for (int j = 0; j < width_A; j++) {
+            A[i][j] = A_data[i][j];
+        }
+    }
+    
+    for (int i = 0; i < height_B; i++) {
+        for (int j = 0; j < width_B; j++) {
+            B[i][j] = B_data[i][j];
+        }
+    }
+    
+    printf("=== Tiled 2D Cross-Correlation Example ===\n\n");
+    
+    // Print input matrices
+    print_2d_array(A, height_A, width_A, "Input A");
+    print_2d_array(B, height_B, width_B, "Kernel B");
+    printf("Tile size: %d x %d\n\n", tile_height, tile_width);
+    
+    // Perform tiled cross-correlation with the library engine
+    tiled_cross_correlation_2d(A, height_A, width_A, B, height_B, width_B, C, tile_height, tile_width);
+    
+    // Print result
+    print_2d_array(C, height_A - height_B + 1, width_A - width_B + 1, "Output C");
+    
+    // Option for user input
+    printf("\nDo you want to try with your own matrices? (1 for yes, 0 for no): ");
+    int user_choice;
+    if (scanf("%d", &user_choice) != 1) {
+        // No answer (e.g. end of input) means no
+        user_choice = 0;
+    }
+    
+    if (user_choice) {
+        int user_height_A, user_width_A, user_height_B, user_width_B, user_tile_height, user_tile_width;
+        
+        // Get matrix dimensions from user
+        user_height_A = read_int("Enter height of input matrix A: ");
+        
+        user_width_A = read_int("Enter width of input matrix A: ");
+        
+        user_height_B = read_int("Enter height of kernel B: ");
+        
+        user_width_B = read_int("Enter width of kernel B: ");
+        
+        // Validate dimensions
+        if (user_height_A < 1 || user_width_A < 1 || user_height_B < 1 || user_width_B < 1 ||
+            user_height_B > user_height_A || user_width_B > user_width_A) {
+            printf("Error: Dimensions must be positive and the kernel no larger than the input\n");
+            free_2d_array(A, height_A);
+            free_2d_array(B, height_B);
+            free_2d_array(C, height_A - height_B + 1);
+            return 1;
+        }
+        
+        user_tile_height = read_int("Enter tile height: ");
+        
+        user_tile_width = read_int("Enter tile width: ");
+        
+        // Validate tile sizes
+        if (user_tile_height < 1 || user_tile_width < 1) {
+            printf("Error: Tile sizes must be positive\n");
+            free_2d_array(A, height_A);
+            free_2d_array(B, height_B);
+            free_2d_array(C, height_A - height_B + 1);
+            return 1;
+        }
+        
+        // Allocate memory for user matrices
+        int **user_A = allocate_2d_array(user_height_A, user_width_A);
+        int **user_B = allocate_2d_array(user_height_B, user_width_B);
+        int **user_C = allocate_2d_array(user_height_A - user_height_B + 1, user_width_A - user_width_B + 1);
+        
+        // Get matrix elements from user
+        printf("Enter elements for input matrix A (%d x %d):\n", user_height_A, user_width_A);
+        for (int i = 0; i < user_height_A; i++) {
+            for (int j = 0; j < user_width_A; j++) {
+                char prompt[64];
+                snprintf(prompt, sizeof(prompt), "A[%d][%d]: ", i, j);
+                user_A[i][j] = read_int(prompt);
+            }
+        }
+        
+        printf("Enter elements for kernel B (%d x %d):\n", user_height_B, user_width_B);
+        for (int i = 0; i < user_height_B; i++) {
+            for (int j = 0; j < user_width_B; j++) {
+                char prompt[64];
+                snprintf(prompt, sizeof(prompt), "B[%d][%d]: ", i, j);
+                user_B[i][j] = read_int(prompt);
+            }
+        }
+        
+        // Print input matrices
+        print_2d_array(user_A, user_height_A, user_width_A, "Input A");
+        print_2d_array(user_B, user_height_B, user_width_B, "Kernel B");
+        printf("Tile size: %d x %d\n\n", user_tile_height, user_tile_width);
+        
+        // Perform tiled cross-correlation with the library engine
+        tiled_cross_correlation_2d(user_A, user_height_A, user_width_A, 
+                           user_B, user_height_B, user_width_B, 
+                           user_C, user_tile_height, user_tile_width);
+        
+        // Print result
+        print_2d_array(user_C, user_height_A - user_height_B + 1, user_width_A - user_width_B + 1, "Output C");
+        
+        // Free allocated memory
+        free_2d_array(user_A, user_height_A);
+        free_2d_array(user_B, user_height_B);
+        free_2d_array(user_C, user_height_A - user_height_B + 1);
+    }
+    
+    // Free allocated memory for example matrices
+    free_2d_array(A, height_A);
+    free_2d_array(B, height_B);
+    free_2d_array(C, height_A - height_B + 1);
+    
+    return 0;
+} 
\ No newline at end of file
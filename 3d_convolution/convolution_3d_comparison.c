@@ -3,17 +3,16 @@
 #include <string.h>
 #include <time.h>
 
+#include "tileconv.h"
+
+// Time budget of the tile search
+#define TUNE_BUDGET_SECONDS 10.0
+
 // Function declarations
 void naive_convolution_3d(int *A, int size_A_x, int size_A_y, int size_A_z,
                          int *B, int size_B_x, int size_B_y, int size_B_z,
                          int *C);
 
-void tiled_convolution_3d(int *A, int size_A_x, int size_A_y, int size_A_z,
-                         int *B, int size_B_x, int size_B_y, int size_B_z,
-                         int *C,
-                         int tile_A_x, int tile_A_y, int tile_A_z,
-                         int tile_B_x, int tile_B_y, int tile_B_z);
-
 // Helper functions
 void init_random_3d_array(int *arr, int size_x, int size_y, int size_z) {
     for (int z = 0; z < size_z; z++) {
@@ -101,154 +100,130 @@ void naive_convolution_3d(int *A, int size_A_x, int size_A_y, int size_A_z,
     }
 }
 
-// Implementation of tiled 3D convolution
-void tiled_convolution_3d(int *A, int size_A_x, int size_A_y, int size_A_z,
-                         int *B, int size_B_x, int size_B_y, int size_B_z,
-                         int *C,
-                         int tile_A_x, int tile_A_y, int tile_A_z,
-                         int tile_B_x, int tile_B_y, int tile_B_z) {
-    // Calculate output dimensions
-    int size_C_x = size_A_x - size_B_x + 1;
-    int size_C_y = size_A_y - size_B_y + 1;
-    int size_C_z = size_A_z - size_B_z + 1;
-    
-    // Initialize C array elements to 0
-    memset(C, 0, size_C_x * size_C_y * size_C_z * sizeof(int));
-    
-    // Calculate the number of tiles
-    int num_tiles_B_x = (size_B_x + tile_B_x - 1) / tile_B_x;
-    int num_tiles_B_y = (size_B_y + tile_B_y - 1) / tile_B_y;
-    int num_tiles_B_z = (size_B_z + tile_B_z - 1) / tile_B_z;
-    
-    // Outer loops: iterate over kernel B in tiles
-    for (int tz = 0; tz < num_tiles_B_z; tz++) {
-        for (int ty = 0; ty < num_tiles_B_y; ty++) {
-            for (int tx = 0; tx < num_tiles_B_x; tx++) {
-                
-                // Calculate the bounds for this tile
-                int z_start = tz * tile_B_z;
-                int z_end = (tz == num_tiles_B_z - 1) ? size_B_z : (tz + 1) * tile_B_z;
-                int y_start = ty * tile_B_y;
-                int y_end = (ty == num_tiles_B_y - 1) ? size_B_y : (ty + 1) * tile_B_y;
-                int x_start = tx * tile_B_x;
-                int x_end = (tx == num_tiles_B_x - 1) ? size_B_x : (tx + 1) * tile_B_x;
-                
-                // Middle loops: iterate over output elements
-                for (int z_out = 0; z_out < size_C_z; z_out++) {
-                    for (int y_out = 0; y_out < size_C_y; y_out++) {
-                        for (int x_out = 0; x_out < size_C_x; x_out++) {
-                            
-                            // Inner loops: process current tile
-                            for (int z_k = z_start; z_k < z_end; z_k++) {
-                                for (int y_k = y_start; y_k < y_end; y_k++) {
-                                    for (int x_k = x_start; x_k < x_end; x_k++) {
-                                        
-                                        // Calculate the indices with kernel reversal for convolution
-                                        int kernel_z = size_B_z - 1 - z_k;
-                                        int kernel_y = size_B_y - 1 - y_k;
-                                        int kernel_x = size_B_x - 1 - x_k;
-                                        
-                                        // Calculate input indices
-                                        int a_z = z_out + z_k;
-                                        int a_y = y_out + y_k;
-                                        int a_x = x_out + x_k;
-                                        
-                                        // Calculate flattened indices
-                                        int c_index = z_out * size_C_y * size_C_x + y_out * size_C_x + x_out;
-                                        int a_index = a_z * size_A_y * size_A_x + a_y * size_A_x + a_x;
-                                        int b_index = kernel_z * size_B_y * size_B_x + kernel_y * size_B_x + kernel_x;
-                                        
-                                        C[c_index] += A[a_index] * B[b_index];
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
+// Wall-clock time in seconds; clock() would add up the CPU time of all threads
+double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Open hardware counters when TILECONV_PERF is set to a value other than 0
+tc_perf *open_counters(void) {
+    const char *env = getenv("TILECONV_PERF");
+    if (!env || strcmp(env, "0") == 0) {
+        return NULL;
     }
+    tc_perf *perf = tc_perf_open();
+    if (!perf) {
+        printf("Hardware counters are not available on this system\n");
+    }
+    return perf;
 }
 
-// Optimize tile sizes by testing different combinations
+/**
+ * Searches tile sizes with the library autotuner (tc_tune): tile_A and tile_B
+ * are sampled independently, ranked by successive halving on a shrunken copy
+ * of the volume and refined on the real size within TUNE_BUDGET_SECONDS. The
+ * winner replaces the tile sizes used by the comparison and is stored in the
+ * tuning database.
+ */
 void optimize_tile_sizes(int *A, int size_A_x, int size_A_y, int size_A_z,
                         int *B, int size_B_x, int size_B_y, int size_B_z,
-                        int *C) {
+                        int *C, int *tile_A_x, int *tile_A_y, int *tile_A_z,
+                        int *tile_B_x, int *tile_B_y, int *tile_B_z, tc_perf *perf) {
     printf("\n=== Optimizing Tile Sizes ===\n");
-    
-    int size_C_x = size_A_x - size_B_x + 1;
-    int size_C_y = size_A_y - size_B_y + 1;
-    int size_C_z = size_A_z - size_B_z + 1;
-    int total_size_C = size_C_x * size_C_y * size_C_z;
-    
-    double best_time = 9999.0;
-    int best_tile_A_x = 0, best_tile_A_y = 0, best_tile_A_z = 0;
-    int best_tile_B_x = 0, best_tile_B_y = 0, best_tile_B_z = 0;
-    
-    // Try different tile sizes
-    int tile_sizes[] = {2, 4, 8};
-    int num_tile_sizes = sizeof(tile_sizes) / sizeof(tile_sizes[0]);
-    
-    for (int i = 0; i < num_tile_sizes; i++) {
-        for (int j = 0; j < num_tile_sizes; j++) {
-            for (int k = 0; k < num_tile_sizes; k++) {
-                // We'll test with the same tile sizes for both A and B for simplicity
-                int tile_A_x = tile_sizes[i];
-                int tile_A_y = tile_sizes[j];
-                int tile_A_z = tile_sizes[k];
-                int tile_B_x = tile_sizes[i];
-                int tile_B_y = tile_sizes[j];
-                int tile_B_z = tile_sizes[k];
-                
-                // Ensure tile sizes don't exceed kernel dimensions
-                if (tile_B_x > size_B_x) tile_B_x = size_B_x;
-                if (tile_B_y > size_B_y) tile_B_y = size_B_y;
-                if (tile_B_z > size_B_z) tile_B_z = size_B_z;
-                
-                int *result = (int *)malloc(total_size_C * sizeof(int));
-                
-                // Measure execution time
-                clock_t start = clock();
-                
-                tiled_convolution_3d(A, size_A_x, size_A_y, size_A_z,
-                                    B, size_B_x, size_B_y, size_B_z,
-                                    result,
-                                    tile_A_x, tile_A_y, tile_A_z,
-                                    tile_B_x, tile_B_y, tile_B_z);
-                
-                clock_t end = clock();
-                double time_taken = ((double)(end - start)) / CLOCKS_PER_SEC;
-                
-                printf("Tile sizes A: %dx%dx%d, B: %dx%dx%d - Time: %.6f seconds\n",
-                       tile_A_x, tile_A_y, tile_A_z, tile_B_x, tile_B_y, tile_B_z, time_taken);
-                
-                // Update best tile sizes if this configuration is faster
-                if (time_taken < best_time) {
-                    best_time = time_taken;
-                    best_tile_A_x = tile_A_x;
-                    best_tile_A_y = tile_A_y;
-                    best_tile_A_z = tile_A_z;
-                    best_tile_B_x = tile_B_x;
-                    best_tile_B_y = tile_B_y;
-                    best_tile_B_z = tile_B_z;
-                }
-                
-                free(result);
-            }
-        }
+    printf("Searching for up to %.0f seconds...\n", TUNE_BUDGET_SECONDS);
+    
+    int size_A[3] = {size_A_x, size_A_y, size_A_z};
+    int size_B[3] = {size_B_x, size_B_y, size_B_z};
+    tc_tune_result result;
+    if (tc_tune(TC_CONVOLUTION, 3, size_A, size_B, NULL, TUNE_BUDGET_SECONDS, 1, &result) != 0) {
+        printf("Tile search failed; keeping the given tile sizes\n");
+        return;
     }
     
+    *tile_A_x = result.options.tile_A[0];
+    *tile_A_y = result.options.tile_A[1];
+    *tile_A_z = result.options.tile_A[2];
+    *tile_B_x = result.options.tile_B[0];
+    *tile_B_y = result.options.tile_B[1];
+    *tile_B_z = result.options.tile_B[2];
+    
+    printf("Timed %d configurations on a shrunken volume and %d on the full volume\n",
+           result.proxy_evaluated, result.evaluated);
     printf("\nBest tile sizes found:\n");
     printf("A: %dx%dx%d, B: %dx%dx%d - Time: %.6f seconds\n",
-           best_tile_A_x, best_tile_A_y, best_tile_A_z, 
-           best_tile_B_x, best_tile_B_y, best_tile_B_z, best_time);
+           *tile_A_x, *tile_A_y, *tile_A_z, *tile_B_x, *tile_B_y, *tile_B_z, result.seconds);
+    printf("Mean of %d runs: %.6f seconds, 95%% confidence interval [%.6f, %.6f]\n",
+           result.ci_runs, result.mean_seconds, result.ci_low, result.ci_high);
+    
+    if (perf) {
+        int size_C_x = size_A_x - size_B_x + 1;
+        int size_C_y = size_A_y - size_B_y + 1;
+        int size_C_z = size_A_z - size_B_z + 1;
+        double macs = (double)size_C_x * size_C_y * size_C_z * size_B_x * size_B_y * size_B_z;
+        
+        tc_perf_counts counts;
+        tc_perf_start(perf);
+        tiled_convolution_3d(A, size_A_x, size_A_y, size_A_z,
+                            B, size_B_x, size_B_y, size_B_z,
+                            C,
+                            *tile_A_x, *tile_A_y, *tile_A_z,
+                            *tile_B_x, *tile_B_y, *tile_B_z);
+        tc_perf_stop(perf, &counts);
+        tc_perf_print("best tiles", &counts, macs);
+    }
+}
+
+// Run the tiled plan on a work-stealing pool and report how evenly the blocks were spread
+void run_threaded_comparison(int *A, int size_A_x, int size_A_y, int size_A_z,
+                             int *B, int size_B_x, int size_B_y, int size_B_z,
+                             int *C_expected, const tc_options *tiled_opts,
+                             double time_tiled, int threads, tc_perf *perf) {
+    int total_size_C = (size_A_x - size_B_x + 1) * (size_A_y - size_B_y + 1) * (size_A_z - size_B_z + 1);
+    int *C_threaded = (int *)malloc(total_size_C * sizeof(int));
+    
+    tc_options opts = *tiled_opts;
+    opts.threads = threads;
+    tc_plan *plan = tc_plan_create_3d(TC_CONVOLUTION, size_A_x, size_A_y, size_A_z,
+                                      B, size_B_x, size_B_y, size_B_z, &opts);
+    if (!plan || !C_threaded) {
+        printf("Failed to create threaded 3D convolution plan\n");
+        exit(1);
+    }
+    tc_pool *pool = tc_plan_pool(plan);
+    
+    printf("\nRunning tiled 3D convolution on %d threads...\n", tc_pool_size(pool));
+    tc_perf_counts counts;
+    if (perf) tc_perf_start(perf);
+    double start = wall_time();
+    tc_execute(plan, A, C_threaded);
+    double time_threaded = wall_time() - start;
+    if (perf) tc_perf_stop(perf, &counts);
+    
+    printf("Threaded implementation: %.6f seconds (%.2fx over single-threaded tiled), %s\n",
+           time_threaded, time_tiled / time_threaded,
+           arrays_equal(C_expected, C_threaded, total_size_C) ? "results match" : "results don't match");
+    if (perf) tc_perf_print("threaded", &counts, (double)total_size_C * size_B_x * size_B_y * size_B_z);
+    
+    printf("Per-worker utilization:\n");
+    for (int w = 0; w < tc_pool_size(pool); w++) {
+        tc_pool_worker_stats stats;
+        tc_pool_stats(pool, w, &stats);
+        printf("  Worker %2d: %5.1f%% busy, %ld blocks, %ld steals\n",
+               w, stats.utilization * 100.0, stats.tasks, stats.steals);
+    }
+    
+    tc_plan_destroy(plan);
+    free(C_threaded);
 }
 
 // Function to run a performance comparison between naive and tiled implementations
 void run_performance_comparison(int size_A_x, int size_A_y, int size_A_z,
                               int size_B_x, int size_B_y, int size_B_z,
                               int tile_A_x, int tile_A_y, int tile_A_z,
-                              int tile_B_x, int tile_B_y, int tile_B_z) {
+                              int tile_B_x, int tile_B_y, int tile_B_z,
+                              int threads, tc_perf *perf) {
     printf("=== 3D Convolution Performance Comparison ===\n\n");
     
     // Calculate output dimensions
@@ -287,28 +262,49 @@ void run_performance_comparison(int size_A_x, int size_A_y, int size_A_z,
     
     // Run naive convolution and measure time
     printf("Running naive 3D convolution...\n");
-    clock_t start_naive = clock();
+    tc_perf_counts naive_counts, tiled_counts;
+    if (perf) tc_perf_start(perf);
+    double start_naive = wall_time();
     
     naive_convolution_3d(A, size_A_x, size_A_y, size_A_z,
                         B, size_B_x, size_B_y, size_B_z,
                         C_naive);
     
-    clock_t end_naive = clock();
-    double time_naive = ((double)(end_naive - start_naive)) / CLOCKS_PER_SEC;
+    double time_naive = wall_time() - start_naive;
+    if (perf) tc_perf_stop(perf, &naive_counts);
     printf("Naive implementation completed in %.6f seconds\n\n", time_naive);
     
+    // Build the tiled plan outside the timed region
+    tc_options opts;
+    tc_options_init(&opts);
+    opts.tile_A[0] = tile_A_x;
+    opts.tile_A[1] = tile_A_y;
+    opts.tile_A[2] = tile_A_z;
+    opts.tile_B[0] = tile_B_x;
+    opts.tile_B[1] = tile_B_y;
+    opts.tile_B[2] = tile_B_z;
+    // Declare the input range so the plan can prove its accumulator cannot overflow
+    opts.input_min = 0;
+    opts.input_max = 9;
+    tc_plan *plan = tc_plan_create_3d(TC_CONVOLUTION, size_A_x, size_A_y, size_A_z,
+                                      B, size_B_x, size_B_y, size_B_z, &opts);
+    if (!plan) {
+        printf("Failed to create tiled 3D convolution plan\n");
+        exit(1);
+    }
+    printf("Accumulator: %s (%s for inputs in [0, 9])\n",
+           tc_plan_accum(plan) == TC_ACCUM_INT64 ? "int64" : "int32",
+           tc_plan_overflow_free(plan) ? "overflow-free" : "may overflow");
+    
     // Run tiled convolution and measure time
     printf("Running tiled 3D convolution...\n");
-    clock_t start_tiled = clock();
+    if (perf) tc_perf_start(perf);
+    double start_tiled = wall_time();
     
-    tiled_convolution_3d(A, size_A_x, size_A_y, size_A_z,
-                        B, size_B_x, size_B_y, size_B_z,
-                        C_tiled,
-                        tile_A_x, tile_A_y, tile_A_z,
-                        tile_B_x, tile_B_y, tile_B_z);
+    tc_execute(plan, A, C_tiled);
     
-    clock_t end_tiled = clock();
-    double time_tiled = ((double)(end_tiled - start_tiled)) / CLOCKS_PER_SEC;
+    double time_tiled = wall_time() - start_tiled;
+    if (perf) tc_perf_stop(perf, &tiled_counts);
     printf("Tiled implementation completed in %.6f seconds\n\n", time_tiled);
     
     // Compare results
@@ -342,7 +338,21 @@ void run_performance_comparison(int size_A_x, int size_A_y, int size_A_z,
         printf("Both implementations have similar performance.\n");
     }
     
+    // Counters show why one version wins: IPC and cache / TLB misses per multiply-accumulate
+    if (perf) {
+        double macs = (double)total_size_C * total_size_B;
+        tc_perf_print("naive", &naive_counts, macs);
+        tc_perf_print("tiled", &tiled_counts, macs);
+    }
+    
+    if (threads > 1) {
+        run_threaded_comparison(A, size_A_x, size_A_y, size_A_z,
+                                B, size_B_x, size_B_y, size_B_z,
+                                C_naive, &opts, time_tiled, threads, perf);
+    }
+    
     // Free allocated memory
+    tc_plan_destroy(plan);
     free(A);
     free(B);
     free(C_naive);
@@ -354,7 +364,7 @@ int parse_args(int argc, char **argv, int *size_A_x, int *size_A_y, int *size_A_
               int *size_B_x, int *size_B_y, int *size_B_z,
               int *tile_A_x, int *tile_A_y, int *tile_A_z,
               int *tile_B_x, int *tile_B_y, int *tile_B_z,
-              int *optimize) {
+              int *optimize, int *threads) {
     
     if (argc >= 10) {
         *size_A_x = atoi(argv[1]);
@@ -377,6 +387,10 @@ int parse_args(int argc, char **argv, int *size_A_x, int *size_A_y, int *size_A_
             *optimize = atoi(argv[13]);
         }
         
+        if (argc >= 15) {
+            *threads = atoi(argv[14]);
+        }
+        
         return 1;
     }
     
@@ -388,7 +402,7 @@ void get_user_input(int *size_A_x, int *size_A_y, int *size_A_z,
                   int *size_B_x, int *size_B_y, int *size_B_z,
                   int *tile_A_x, int *tile_A_y, int *tile_A_z,
                   int *tile_B_x, int *tile_B_y, int *tile_B_z,
-                  int *optimize) {
+                  int *optimize, int *threads) {
     
     printf("=== 3D Convolution Configuration ===\n\n");
     
@@ -451,6 +465,12 @@ void get_user_input(int *size_A_x, int *size_A_y, int *size_A_z,
         *tile_B_y = 2;
         *tile_B_z = 2;
     }
+    
+    // Older input scripts stop here; stay single-threaded then
+    printf("\nEnter number of threads (1 for single-threaded): ");
+    if (scanf("%d", threads) != 1) {
+        *threads = 1;
+    }
 }
 
 int main(int argc, char **argv) {
@@ -460,13 +480,14 @@ int main(int argc, char **argv) {
     int tile_A_x = 4, tile_A_y = 4, tile_A_z = 4;     // Default tile size for A
     int tile_B_x = 2, tile_B_y = 2, tile_B_z = 2;     // Default tile size for B
     int optimize = 0;                                 // Don't optimize by default
+    int threads = 1;                                  // Single-threaded by default
     
     // Check if command line arguments are provided
     int args_provided = parse_args(argc, argv, &size_A_x, &size_A_y, &size_A_z,
                                   &size_B_x, &size_B_y, &size_B_z,
                                   &tile_A_x, &tile_A_y, &tile_A_z,
                                   &tile_B_x, &tile_B_y, &tile_B_z,
-                                  &optimize);
+                                  &optimize, &threads);
     
     // If no command line arguments, get user input
     if (!args_provided) {
@@ -474,7 +495,7 @@ int main(int argc, char **argv) {
                       &size_B_x, &size_B_y, &size_B_z,
                       &tile_A_x, &tile_A_y, &tile_A_z,
                       &tile_B_x, &tile_B_y, &tile_B_z,
-                      &optimize);
+                      &optimize, &threads);
     }
     
     // Calculate output dimensions
@@ -490,25 +511,31 @@ int main(int argc, char **argv) {
     int *B = (int *)malloc(total_size_B * sizeof(int));
     int *C_naive = (int *)malloc(total_size_C * sizeof(int));
     
+    // Counters are opened before any worker threads exist so they include them
+    tc_perf *perf = open_counters();
+    
     // Initialize arrays with random values
     srand(time(NULL));
     init_random_3d_array(A, size_A_x, size_A_y, size_A_z);
     init_random_3d_array(B, size_B_x, size_B_y, size_B_z);
     
-    // If optimization requested, find best tile sizes
+    // If optimization requested, find best tile sizes and compare with them
     if (optimize) {
         optimize_tile_sizes(A, size_A_x, size_A_y, size_A_z,
                           B, size_B_x, size_B_y, size_B_z,
-                          C_naive);
+                          C_naive, &tile_A_x, &tile_A_y, &tile_A_z,
+                          &tile_B_x, &tile_B_y, &tile_B_z, perf);
     }
     
     // Run the performance comparison
     run_performance_comparison(size_A_x, size_A_y, size_A_z,
                              size_B_x, size_B_y, size_B_z,
                              tile_A_x, tile_A_y, tile_A_z,
-                             tile_B_x, tile_B_y, tile_B_z);
+                             tile_B_x, tile_B_y, tile_B_z,
+                             threads, perf);
     
     // Free allocated memory
+    tc_perf_close(perf);
     free(A);
     free(B);
     free(C_naive);
@@ -0,0 +1,544 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tileconv.h"
+
+// Time budget of the tile search
+#define TUNE_BUDGET_SECONDS 10.0
+
+// Function declarations
+void naive_cross_correlation_3d(int *A, int size_A_x, int size_A_y, int size_A_z,
+                         int *B, int size_B_x, int size_B_y, int size_B_z,
+                         int *C);
+
+// Helper functions
+void init_random_3d_array(int *arr, int size_x, int size_y, int size_z) {
+    for (int z = 0; z < size_z; z++) {
+        for (int y = 0; y < size_y; y++) {
+            for (int x = 0; x < size_x; x++) {
+                arr[z * size_y * size_x + y * size_x + x] = rand() % 10;
+            }
+        }
+    }
+}
+
+void print_3d_array(int *arr, int size_x, int size_y, int size_z, const char *name) {
+    printf("%s = [\n", name);
+    for (int z = 0; z < size_z && z < 3; z++) { // Print only first 3 layers maximum
+        printf("  Layer %d:\n", z);
+        for (int y = 0; y < size_y && y < 3; y++) { // Print only first 3 rows maximum
+            printf("    [");
+            for (int x = 0; x < size_x && x < 5; x++) { // Print only first 5 columns maximum
+                printf("%d", arr[z * size_y * size_x + y * size_x + x]);
+                if (x < size_x - 1 && x < 4) printf(", ");
+            }
+            if (size_x > 5) printf(", ..."); // Indicate truncation
+            printf("]\n");
+        }
+        if (size_y > 3) printf("    ...\n"); // Indicate truncation
+        if (z < size_z - 1 && z < 2) printf("\n");
+    }
+    if (size_z > 3) printf("  ...\n"); // Indicate truncation
+    printf("]\n");
+}
+
+int arrays_equal(int *arr1, int *arr2, int size) {
+    for (int i = 0; i < size; i++) {
+        if (arr1[i] != arr2[i]) {
+            printf("Difference found at index %d: %d vs %d\n", i, arr1[i], arr2[i]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Implementation of naive 3D cross-correlation
+void naive_cross_correlation_3d(int *A, int size_A_x, int size_A_y, int size_A_z,
+                         int *B, int size_B_x, int size_B_y, int size_B_z,
+                         int *C) {
+    // Calculate output dimensions
+    int size_C_x = size_A_x - size_B_x + 1;
+    int size_C_y = size_A_y - size_B_y + 1;
+    int size_C_z = size_A_z - size_B_z + 1;
+    
+    // Initialize C array elements to 0
+    memset(C, 0, size_C_x * size_C_y * size_C_z * sizeof(int));
+    
+    // Iterate over each output element
+    for (int z_out = 0; z_out < size_C_z; z_out++) {
+        for (int y_out = 0; y_out < size_C_y; y_out++) {
+            for (int x_out = 0; x_out < size_C_x; x_out++) {
+                
+                // For each position in the kernel
+                for (int z_k = 0; z_k < size_B_z; z_k++) {
+                    for (int y_k = 0; y_k < size_B_y; y_k++) {
+                        for (int x_k = 0; x_k < size_B_x; x_k++) {
+                            
+                            // Cross-correlation applies the kernel without reversal
+                            int kernel_z = z_k;
+                            int kernel_y = y_k;
+                            int kernel_x = x_k;
+                            
+                            // Calculate input indices
+                            int a_z = z_out + z_k;
+                            int a_y = y_out + y_k;
+                            int a_x = x_out + x_k;
+                            
+                            // Calculate flattened indices
+                            int c_index = z_out * size_C_y * size_C_x + y_out * size_C_x + x_out;
+                            int a_index = a_z * size_A_y * size_A_x + a_y * size_A_x + a_x;
+                            int b_index = kernel_z * size_B_y * size_B_x + kernel_y * size_B_x + kernel_x;
+                            
+                            C[c_index] += A[a_index] * B[b_index];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Wall-clock time in seconds; clock() would add up the CPU time of all threads
+double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Open hardware counters when TILECONV_PERF is set to a value other than 0
+tc_perf *open_counters(void) {
+    const char *env = getenv("TILECONV_PERF");
+    if (!env || strcmp(env, "0") == 0) {
+        return NULL;
+    }
+    tc_perf *perf = tc_perf_open();
+    if (!perf) {
+        printf("Hardware counters are not available on this system\n");
+    }
+    return perf;
+}
+
+/**
+ * Searches tile sizes with the library autotuner (tc_tune): tile_A and tile_B
+ * are sampled independently, ranked by successive halving on a shrunken copy
+ * of the volume and refined on the real size within TUNE_BUDGET_SECONDS. The
+ * winner replaces the tile sizes used by the comparison and is stored in the
+ * tuning database.
+ */
+void optimize_tile_sizes(int *A, int size_A_x, int size_A_y, int size_A_z,
+                        int *B, int size_B_x, int size_B_y, int size_B_z,
+                        int *C, int *tile_A_x, int *tile_A_y, int *tile_A_z,
+                        int *tile_B_x, int *tile_B_y, int *tile_B_z, tc_perf *perf) {
+    printf("\n=== Optimizing Tile Sizes ===\n");
+    printf("Searching for up to %.0f seconds...\n", TUNE_BUDGET_SECONDS);
+    
+    int size_A[3] = {size_A_x, size_A_y, size_A_z};
+    int size_B[3] = {size_B_x, size_B_y, size_B_z};
+    tc_tune_result result;
+    if (tc_tune(TC_CROSS_CORRELATION, 3, size_A, size_B, NULL, TUNE_BUDGET_SECONDS, 1, &result) != 0) {
+        printf("Tile search failed; keeping the given tile sizes\n");
+        return;
+    }
+    
+    *tile_A_x = result.options.tile_A[0];
+    *tile_A_y = result.options.tile_A[1];
+    *tile_A_z = result.options.tile_A[2];
+    *tile_B_x = result.options.tile_B[0];
+    *tile_B_y = result.options.tile_B[1];
+    *tile_B_z = result.options.tile_B[2];
+    
+    printf("Timed %d configurations on a shrunken volume and %d on the full volume\n",
+           result.proxy_evaluated, result.evaluated);
+    printf("\nBest tile sizes found:\n");
+    printf("A: %dx%dx%d, B: %dx%dx%d - Time: %.6f seconds\n",
+           *tile_A_x, *tile_A_y, *tile_A_z, *tile_B_x, *tile_B_y, *tile_B_z, result.seconds);
+    printf("Mean of %d runs: %.6f seconds, 95%% confidence interval [%.6f, %.6f]\n",
+           result.ci_runs, result.mean_seconds, result.ci_low, result.ci_high);
+    
+    if (perf) {
+        int size_C_x = size_A_x - size_B_x + 1;
+        int size_C_y = size_A_y - size_B_y + 1;
+        int size_C_z = size_A_z - size_B_z + 1;
+        double macs = (double)size_C_x * size_C_y * size_C_z * size_B_x * size_B_y * size_B_z;
+        
+        tc_perf_counts counts;
+        tc_perf_start(perf);
+        tiled_cross_correlation_3d(A, size_A_x, size_A_y, size_A_z,
+                            B, size_B_x, size_B_y, size_B_z,
+                            C,
+                            *tile_A_x, *tile_A_y, *tile_A_z,
+                            *tile_B_x, *tile_B_y, *tile_B_z);
+        tc_perf_stop(perf, &counts);
+        tc_perf_print("best tiles", &counts, macs);
+    }
+}
+
+// Run the tiled plan on a work-stealing pool and report how evenly the blocks were spread
+void run_threaded_comparison(int *A, int size_A_x, int size_A_y, int size_A_z,
+                             int *B, int size_B_x, int size_B_y, int size_B_z,
+                             int *C_expected, const tc_options *tiled_opts,
+                             double time_tiled, int threads, tc_perf *perf) {
+    int total_size_C = (size_A_x - size_B_x + 1) * (size_A_y - size_B_y + 1) * (size_A_z - size_B_z + 1);
+    int *C_threaded = (int *)malloc(total_size_C * sizeof(int));
+    
+    tc_options opts = *tiled_opts;
+    opts.threads = threads;
+    tc_plan *plan = tc_plan_create_3d(TC_CROSS_CORRELATION, size_A_x, size_A_y, size_A_z,
+                                      B, size_B_x, size_B_y, size_B_z, &opts);
+    if (!plan || !C_threaded) {
+        printf("Failed to create threaded 3D cross-correlation plan\n");
+        exit(1);
+    }
+    tc_pool *pool = tc_plan_pool(plan);
+    
+    printf("\nRunning tiled 3D cross-correlation on %d threads...\n", tc_pool_size(pool));
+    tc_perf_counts counts;
+    if (perf) tc_perf_start(perf);
+    double start = wall_time();
+    tc_execute(plan, A, C_threaded);
+    double time_threaded = wall_time() - start;
+    if (perf) tc_perf_stop(perf, &counts);
+    
+    printf("Threaded implementation: %.6f seconds (%.2fx over single-threaded tiled), %s\n",
+           time_threaded, time_tiled / time_threaded,
+           arrays_equal(C_expected, C_threaded, total_size_C) ? "results match" : "results don't match");
+    if (perf) tc_perf_print("threaded", &counts, (double)total_size_C * size_B_x * size_B_y * size_B_z);
+    
+    printf("Per-worker utilization:\n");
+    for (int w = 0; w < tc_pool_size(pool); w++) {
+        tc_pool_worker_stats stats;
+        tc_pool_stats(pool, w, &stats);
+        printf("  Worker %2d: %5.1f%% busy, %ld blocks, %ld steals\n",
+               w, stats.utilization * 100.0, stats.tasks, stats.steals);
+    }
+    
+    tc_plan_destroy(plan);
+    free(C_threaded);
+}
+
+// Function to run a performance comparison between naive and tiled implementations
+void run_performance_comparison(int size_A_x, int size_A_y, int size_A_z,
+                              int size_B_x, int size_B_y, int size_B_z,
+                              int tile_A_x, int tile_A_y, int tile_A_z,
+                              int tile_B_x, int tile_B_y, int tile_B_z,
+                              int threads, tc_perf *perf) {
+    printf("=== 3D Cross-Correlation Performance Comparison ===\n\n");
+    
+    // Calculate output dimensions
+    int size_C_x = size_A_x - size_B_x + 1;
+    int size_C_y = size_A_y - size_B_y + 1;
+    int size_C_z = size_A_z - size_B_z + 1;
+    
+    // Allocate memory for arrays
+    int total_size_A = size_A_x * size_A_y * size_A_z;
+    int total_size_B = size_B_x * size_B_y * size_B_z;
+    int total_size_C = size_C_x * size_C_y * size_C_z;
+    
+    int *A = (int *)malloc(total_size_A * sizeof(int));
+    int *B = (int *)malloc(total_size_B * sizeof(int));
+    int *C_naive = (int *)malloc(total_size_C * sizeof(int));
+    int *C_tiled = (int *)malloc(total_size_C * sizeof(int));
+    
+    // Initialize arrays with random values
+    srand(time(NULL));
+    init_random_3d_array(A, size_A_x, size_A_y, size_A_z);
+    init_random_3d_array(B, size_B_x, size_B_y, size_B_z);
+    
+    // Print array information
+    printf("Input A: %dx%dx%d array\n", size_A_x, size_A_y, size_A_z);
+    printf("Kernel B: %dx%dx%d array\n", size_B_x, size_B_y, size_B_z);
+    printf("Output C: %dx%dx%d array\n", size_C_x, size_C_y, size_C_z);
+    printf("Tile sizes for A: %dx%dx%d\n", tile_A_x, tile_A_y, tile_A_z);
+    printf("Tile sizes for B: %dx%dx%d\n\n", tile_B_x, tile_B_y, tile_B_z);
+    
+    // For smaller arrays, print sample of the input
+    if (size_A_x <= 10 && size_A_y <= 10 && size_A_z <= 10) {
+        print_3d_array(A, size_A_x, size_A_y, size_A_z, "Input A");
+        print_3d_array(B, size_B_x, size_B_y, size_B_z, "Kernel B");
+        printf("\n");
+    }
+    
+    // Run naive cross-correlation and measure time
+    printf("Running naive 3D cross-correlation...\n");
+    tc_perf_counts naive_counts, tiled_counts;
+    if (perf) tc_perf_start(perf);
+    double start_naive = wall_time();
+    
+    naive_cross_correlation_3d(A, size_A_x, size_A_y, size_A_z,
+                        B, size_B_x, size_B_y, size_B_z,
+                        C_naive);
+    
+    double time_naive = wall_time() - start_naive;
+    if (perf) tc_perf_stop(perf, &naive_counts);
+    printf("Naive implementation completed in %.6f seconds\n\n", time_naive);
+    
+    // Build the tiled plan outside the timed region
+    tc_options opts;
+    tc_options_init(&opts);
+    opts.tile_A[0] = tile_A_x;
+    opts.tile_A[1] = tile_A_y;
+    opts.tile_A[2] = tile_A_z;
+    opts.tile_B[0] = tile_B_x;
+    opts.tile_B[1] = tile_B_y;
+    opts.tile_B[2] = tile_B_z;
+    // Declare the input range so the plan can prove its accumulator cannot overflow
+    opts.input_min = 0;
+    opts.input_max = 9;
+    tc_plan *plan = tc_plan_create_3d(TC_CROSS_CORRELATION, size_A_x, size_A_y, size_A_z,
+                                      B, size_B_x, size_B_y, size_B_z, &opts);
+    if (!plan) {
+        printf("Failed to create tiled 3D cross-correlation plan\n");
+        exit(1);
+    }
+    printf("Accumulator: %s (%s for inputs in [0, 9])\n",
+           tc_plan_accum(plan) == TC_ACCUM_INT64 ? "int64" : "int32",
+           tc_plan_overflow_free(plan) ? "overflow-free" : "may overflow");
+    
+    // Run tiled cross-correlation and measure time
+    printf("Running tiled 3D cross-correlation...\n");
+    if (perf) tc_perf_start(perf);
+    double start_tiled = wall_time();
+    
+    tc_execute(plan, A, C_tiled);
+    
+    double time_tiled = wall_time() - start_tiled;
+    if (perf) tc_perf_stop(perf, &tiled_counts);
+    printf("Tiled implementation completed in %.6f seconds\n\n", time_tiled);
+    
+    // Compare results
+    printf("Verifying results...\n");
+    int identical = arrays_equal(C_naive, C_tiled, total_size_C);
+    
+    if (identical) {
+        printf("Results match! Both implementations produce the same output.\n\n");
+    } else {
+        printf("Results don't match! There might be an error in one of the implementations.\n\n");
+    }
+    
+    // For smaller arrays, print sample of the output
+    if (size_C_x <= 10 && size_C_y <= 10 && size_C_z <= 10) {
+        print_3d_array(C_naive, size_C_x, size_C_y, size_C_z, "Output C (Naive)");
+        printf("\n");
+    }
+    
+    // Print performance comparison
+    printf("=== Performance Summary ===\n");
+    printf("Naive implementation: %.6f seconds\n", time_naive);
+    printf("Tiled implementation: %.6f seconds\n", time_tiled);
+    
+    if (time_naive > time_tiled) {
+        double speedup = time_naive / time_tiled;
+        printf("Tiled implementation is %.2fx faster!\n", speedup);
+    } else if (time_tiled > time_naive) {
+        double slowdown = time_tiled / time_naive;
+        printf("Tiled implementation is %.2fx slower!\n", slowdown);
+    } else {
+        printf("Both implementations have similar performance.\n");
+    }
+    
+    // Counters show why one version wins: IPC and cache / TLB misses per multiply-accumulate
+    if (perf) {
+        double macs = (double)total_size_C * total_size_B;
+        tc_perf_print("naive", &naive_counts, macs);
+        tc_perf_print("tiled", &tiled_counts, macs);
+    }
+    
+    if (threads > 1) {
+        run_threaded_comparison(A, size_A_x, size_A_y, size_A_z,
+                                B, size_B_x, size_B_y, size_B_z,
+                                C_naive, &opts, time_tiled, threads, perf);
+    }
+    
+    // Free allocated memory
+    tc_plan_destroy(plan);
+    free(A);
+    free(B);
+    free(C_naive);
+    free(C_tiled);
+}
+
+// Parse command line arguments
+int parse_args(int argc, char **argv, int *size_A_x, int *size_A_y, int *size_A_z,
+              int *size_B_x, int *size_B_y, int *size_B_z,
+              int *tile_A_x, int *tile_A_y, int *tile_A_z,
+              int *tile_B_x, int *tile_B_y, int *tile_B_z,
+              int *optimize, int *threads) {
+    
+    if (argc >= 10) {
+        *size_A_x = atoi(argv[1]);
+        *size_A_y = atoi(argv[2]);
+        *size_A_z = atoi(argv[3]);
+        *size_B_x = atoi(argv[4]);
+        *size_B_y = atoi(argv[5]);
+        *size_B_z = atoi(argv[6]);
+        
+        if (argc >= 13) {
+            *tile_A_x = atoi(argv[7]);
+            *tile_A_y = atoi(argv[8]);
+            *tile_A_z = atoi(argv[9]);
+            *tile_B_x = atoi(argv[10]);
+            *tile_B_y = atoi(argv[11]);
+            *tile_B_z = atoi(argv[12]);
+        }
+        
+        if (argc >= 14) {
+            *optimize = atoi(argv[13]);
+        }
+        
+        if (argc >= 15) {
+            *threads = atoi(argv[14]);
+        }
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+// Get user input for array dimensions and tile sizes
+void get_user_input(int *size_A_x, int *size_A_y, int *size_A_z,
+                  int *size_B_x, int *size_B_y, int *size_B_z,
+                  int *tile_A_x, int *tile_A_y, int *tile_A_z,
+                  int *tile_B_x, int *tile_B_y, int *tile_B_z,
+                  int *optimize, int *threads) {
+    
+    printf("=== 3D Cross-Correlation Configuration ===\n\n");
+    
+    // Get input array dimensions
+    printf("Enter dimensions for input array A:\n");
+    printf("X dimension: ");
+    scanf("%d", size_A_x);
+    printf("Y dimension: ");
+    scanf("%d", size_A_y);
+    printf("Z dimension: ");
+    scanf("%d", size_A_z);
+    
+    // Get kernel dimensions
+    printf("\nEnter dimensions for kernel B:\n");
+    printf("X dimension: ");
+    scanf("%d", size_B_x);
+    printf("Y dimension: ");
+    scanf("%d", size_B_y);
+    printf("Z dimension: ");
+    scanf("%d", size_B_z);
+    
+    // Validate dimensions
+    if (*size_B_x > *size_A_x || *size_B_y > *size_A_y || *size_B_z > *size_A_z) {
+        printf("Error: Kernel dimensions must be smaller than input dimensions.\n");
+        exit(1);
+    }
+    
+    // Ask about optimization
+    printf("\nDo you want to optimize tile sizes? (1 for yes, 0 for no): ");
+    scanf("%d", optimize);
+    
+    if (!*optimize) {
+        // Get tile sizes if not optimizing
+        printf("\nEnter tile sizes for array A:\n");
+        printf("X dimension: ");
+        scanf("%d", tile_A_x);
+        printf("Y dimension: ");
+        scanf("%d", tile_A_y);
+        printf("Z dimension: ");
+        scanf("%d", tile_A_z);
+        
+        printf("\nEnter tile sizes for kernel B:\n");
+        printf("X dimension: ");
+        scanf("%d", tile_B_x);
+        printf("Y dimension: ");
+        scanf("%d", tile_B_y);
+        printf("Z dimension: ");
+        scanf("%d", tile_B_z);
+        
+        // Validate tile sizes
+        if (*tile_B_x > *size_B_x) *tile_B_x = *size_B_x;
+        if (*tile_B_y > *size_B_y) *tile_B_y = *size_B_y;
+        if (*tile_B_z > *size_B_z) *tile_B_z = *size_B_z;
+    } else {
+        // Set default values for optimization
+        *tile_A_x = 4;
+        *tile_A_y = 4;
+        *tile_A_z = 4;
+        *tile_B_x = 2;
+        *tile_B_y = 2;
+        *tile_B_z = 2;
+    }
+    
+    // Older input scripts stop here; stay single-threaded then
+    printf("\nEnter number of threads (1 for single-threaded): ");
+    if (scanf("%d", threads) != 1) {
+        *threads = 1;
+    }
+}
+
+int main(int argc, char **argv) {
+    // Default values
+    int size_A_x = 20, size_A_y = 20, size_A_z = 20;  // Default input size
+    int size_B_x = 4, size_B_y = 4, size_B_z = 4;     // Default kernel size
+    int tile_A_x = 4, tile_A_y = 4, tile_A_z = 4;     // Default tile size for A
+    int tile_B_x = 2, tile_B_y = 2, tile_B_z = 2;     // Default tile size for B
+    int optimize = 0;                                 // Don't optimize by default
+    int threads = 1;                                  // Single-threaded by default
+    
+    // Check if command line arguments are provided
+    int args_provided = parse_args(argc, argv, &size_A_x, &size_A_y, &size_A_z,
+                                  &size_B_x, &size_B_y, &size_B_z,
+                                  &tile_A_x, &tile_A_y, &tile_A_z,
+                                  &tile_B_x, &tile_B_y, &tile_B_z,
+                                  &optimize, &threads);
+    
+    // If no command line arguments, get user input
+    if (!args_provided) {
+        get_user_input(&size_A_x, &size_A_y, &size_A_z,
+                      &size_B_x, &size_B_y, &size_B_z,
+                      &tile_A_x, &tile_A_y, &tile_A_z,
+                      &tile_B_x, &tile_B_y, &tile_B_z,
+                      &optimize, &threads);
+    }
+    
+    // Calculate output dimensions
+    int size_C_x = size_A_x - size_B_x + 1;
+    int size_C_y = size_A_y - size_B_y + 1;
+    int size_C_z = size_A_z - size_B_z + 1;
+    int total_size_A = size_A_x * size_A_y * size_A_z;
+    int total_size_B = size_B_x * size_B_y * size_B_z;
+    int total_size_C = size_C_x * size_C_y * size_C_z;
+    
+    // Allocate memory for arrays
+    int *A = (int *)malloc(total_size_A * sizeof(int));
+    int *B = (int *)malloc(total_size_B * sizeof(int));
+    int *C_naive = (int *)malloc(total_size_C * sizeof(int));
+    
+    // Counters are opened before any worker threads exist so they include them
+    tc_perf *perf = open_counters();
+    
+    // Initialize arrays with random values
+    srand(time(NULL));
+    init_random_3d_array(A, size_A_x, size_A_y, size_A_z);
+    init_random_3d_array(B, size_B_x, size_B_y, size_B_z);
+    
+    // If optimization requested, find best tile sizes and compare with them
+    if (optimize) {
+        optimize_tile_sizes(A, size_A_x, size_A_y, size_A_z,
+                          B, size_B_x, size_B_y, size_B_z,
+                          C_naive, &tile_A_x, &tile_A_y, &tile_A_z,
+                          &tile_B_x, &tile_B_y, &tile_B_z, perf);
+    }
+    
+    // Run the performance comparison
+    run_performance_comparison(size_A_x, size_A_y, size_A_z,
+                             size_B_x, size_B_y, size_B_z,
+                             tile_A_x, tile_A_y, tile_A_z,
+                             tile_B_x, tile_B_y, tile_B_z,
+                             threads, perf);
+    
+    // Free allocated memory
+    tc_perf_close(perf);
+    free(A);
+    free(B);
+    free(C_naive);
+    
+    return 0;
+} 
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tileconv.h"
+
+/*
+ * tiled_cross_correlation_3d comes from the tileconv library (lib/compat.c):
+ * it runs the same plan-based engine as convolution, with the kernel applied
+ * as given instead of flipped. The tile sizes for A and B become the plan's
+ * tiles.
+ */
+
+/**
+ * Reads one integer from stdin, exiting when the input is not a number.
+ */
+static int read_int(const char *prompt) {
+    int value;
+    printf("%s", prompt);
+    if (scanf("%d", &value) != 1) {
+        printf("Error: expected an integer\n");
+        exit(1);
+    }
+    return value;
+}
+
+/**
+ * Helper function to initialize a 3D array with sequential values
+ */
+void init_3d_array(int *arr, int size_x, int size_y, int size_z) {
+    int value = 1;
+    for (int z = 0; z < size_z; z++) {
+        for (int y = 0; y < size_y; y++) {
+            for (int x = 0; x < size_x; x++) {
+                arr[z * size_y * size_x + y * size_x + x] = value++;
+            }
+        }
+    }
+}
+
+/**
+ * Helper function to initialize a 3D kernel
+ */
+void init_kernel_3d(int *kernel, int size_x, int size_y, int size_z) {
+    for (int z = 0; z < size_z; z++) {
+        for (int y = 0; y < size_y; y++) {
+            for (int x = 0; x < size_x; x++) {
+                kernel[z * size_y * size_x + y * size_x + x] = (z + y + x) % 3 + 1;
+            }
+        }
+    }
+}
+
+/**
+ * Helper function to print a 3D array
+ */
+void print_3d_array(int *arr, int size_x, int size_y, int size_z, const char *name) {
+    printf("%s = [\n", name);
+    for (int z = 0; z < size_z; z++) {
+        printf("  Layer %d:\n", z);
+        for (int y = 0; y < size_y; y++) {
+            printf("    [");
+            for (int x = 0; x < size_x; x++) {
+                printf("%d", arr[z * size_y * size_x + y * size_x + x]);
+                if (x < size_x - 1) printf(", ");
+            }
+            printf("]\n");
+        }
+        if (z < size_z - 1) printf("\n");
+    }
+    printf("]\n");
+}
+
+int main() {
+    printf("=== Tiled 3D Cross-Correlation Implementation ===\n\n");
+    
+    // Interactive mode to get dimensions from user
+    int size_A_x, size_A_y, size_A_z, size_B_x, size_B_y, size_B_z;
+    int tile_A_x, tile_A_y, tile_A_z, tile_B_x, tile_B_y, tile_B_z;
+    int interactive_mode = 0;
+    
+    // Ask if the user wants to use interactive mode
+    printf("Do you want to use interactive mode? (1 for yes, 0 for no): ");
+    if (scanf("%d", &interactive_mode) != 1) {
+        // No answer (e.g. end of input) runs the default example
+        interactive_mode = 0;
+    }
+    
+    if (interactive_mode) {
+        // Get dimensions from the user
+        printf("\nEnter dimensions for input array A:\n");
+        size_A_x = read_int("X dimension: ");
+        size_A_y = read_int("Y dimension: ");
+        size_A_z = read_int("Z dimension: ");
+        
+        printf("\nEnter dimensions for kernel B:\n");
+        size_B_x = read_int("X dimension: ");
+        size_B_y = read_int("Y dimension: ");
+        size_B_z = read_int("Z dimension: ");
+        
+        // Validate input dimensions
+        if (size_A_x < 1 || size_A_y < 1 || size_A_z < 1 ||
+            size_B_x < 1 || size_B_y < 1 || size_B_z < 1 ||
+            size_B_x > size_A_x || size_B_y > size_A_y || size_B_z > size_A_z) {
+            printf("Error: Dimensions must be positive and the kernel no larger than the input.\n");
+            return 1;
+        }
+        
+        // Get tile sizes from the user
+        printf("\nEnter tile sizes for array A:\n");
+        tile_A_x = read_int("X dimension: ");
+        tile_A_y = read_int("Y dimension: ");
+        tile_A_z = read_int("Z dimension: ");
+        
+        printf("\nEnter tile sizes for kernel B:\n");
+        tile_B_x = read_int("X dimension: ");
+        tile_B_y = read_int("Y dimension: ");
+        tile_B_z = read_int("Z dimension: ");
+        
+        // Validate tile sizes
+        if (tile_A_x < 1 || tile_A_y < 1 || tile_A_z < 1 ||
+            tile_B_x < 1 || tile_B_y < 1 || tile_B_z < 1) {
+            printf("Error: Tile sizes must be positive.\n");
+            return 1;
+        }
+        if (tile_B_x > size_B_x) {
+            printf("Warning: Tile size for B's X dimension is larger than B itself. Setting to %d.\n", size_B_x);
+            tile_B_x = size_B_x;
+        }
+        if (tile_B_y > size_B_y) {
+            printf("Warning: Tile size for B's Y dimension is larger than B itself. Setting to %d.\n", size_B_y);
+            tile_B_y = size_B_y;
+        }
+        if (tile_B_z > size_B_z) {
+            printf("Warning: Tile size for B's Z dimension is larger than B itself. Setting to %d.\n", size_B_z);
+            tile_B_z = size_B_z;
+        }
+    } else {
+        // Use default values for a small example
+        size_A_x = 4;
+        size_A_y = 4;
+        size_A_z = 4;
+        size_B_x = 2;
+        size_B_y = 2;
+        size_B_z = 2;
+        
+        // Default tile sizes
+        tile_A_x = 2;
+        tile_A_y = 2;
+        tile_A_z = 2;
+        tile_B_x = 1;
+        tile_B_y = 1;
+        tile_B_z = 1;
+    }
+    
+    // Calculate the size of the output array
+    int size_C_x = size_A_x - size_B_x + 1;
+    int size_C_y = size_A_y - size_B_y + 1;
+    int size_C_z = size_A_z - size_B_z + 1;
+    
+    // Allocate memory for arrays
+    int *A = (int *)malloc((size_t)size_A_x * size_A_y * size_A_z * sizeof(int));
+    int *B = (int *)malloc((size_t)size_B_x * size_B_y * size_B_z * sizeof(int));
+    int *C = (int *)malloc((size_t)size_C_x * size_C_y * size_C_z * sizeof(int));
+    if (!A || !B || !C) {
+        printf("Memory allocation failed\n");
+        free(A);
+        free(B);
+        free(C);
+        return 1;
+    }
+    
+    // Initialize arrays
+    init_3d_array(A, size_A_x, size_A_y, size_A_z);
+    init_kernel_3d(B, size_B_x, size_B_y, size_B_z);
+    
+    // Print array information
+    printf("\nInput A: %dx%dx%d array\n", size_A_x, size_A_y, size_A_z);
+    printf("Kernel B: %dx%dx%d array\n", size_B_x, size_B_y, size_B_z);
+    printf("Output C: %dx%dx%d array\n", size_C_x, size_C_y, size_C_z);
+    printf("Tile sizes for A: %dx%dx%d\n", tile_A_x, tile_A_y, tile_A_z);
+    printf("Tile sizes for B: %dx%dx%d\n\n", tile_B_x, tile_B_y, tile_B_z);
+    
+    // Print input arrays (only for small examples)
+    if (size_A_x <= 10 && size_A_y <= 10 && size_A_z <= 10) {
+        print_3d_array(A, size_A_x, size_A_y, size_A_z, "Input A");
+        printf("\n");
+        print_3d_array(B, size_B_x, size_B_y, size_B_z, "Kernel B");
+        printf("\n");
+    }
+    
+    // Perform the tiled cross-correlation with the library engine
+    tiled_cross_correlation_3d(
+        A, size_A_x, size_A_y, size_A_z,
+        B, size_B_x, size_B_y, size_B_z,
+        C,
+        tile_A_x, tile_A_y, tile_A_z,
+        tile_B_x, tile_B_y, tile_B_z
+    );
+    
+    // Print the output for small arrays
+    if (size_C_x <= 10 && size_C_y <= 10 && size_C_z <= 10) {
+        print_3d_array(C, size_C_x, size_C_y, size_C_z, "Output C");
+    } else {
+        printf("Output array is too large to display.\n");
+    }
+    
+    printf("\nRemember: In 3D cross-correlation, the kernel B is applied as given, without reversal.\n");
+    printf("Output C[z][y][x] sums A[z+k_z][y+k_y][x+k_x] * B[k_z][k_y][k_x] over the kernel.\n");
+    
+    // Free allocated memory
+    free(A);
+    free(B);
+    free(C);
+    
+    return 0;
+} 
\ No newline at end of file
@@ -0,0 +1,937 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tileconv.h"
+
+/**
+ * Benchmark harness for the tileconv library.
+ *
+ * Every case builds its plan outside the timed region, runs a number of
+ * warmup iterations, then times each repetition separately with the
+ * monotonic wall clock. Results are reported as min / median / p90 / p99 /
+ * mean / stddev per case, as a text table, JSON or CSV.
+ *
+ * With --perf, hardware counters are collected over the timed repetitions
+ * and IPC and cache / TLB / branch misses per multiply-accumulate are added.
+ *
+ * The tuning database is disabled, so every case runs the library's default
+ * tiles and results do not depend on what was tuned on the machine before.
+ *
+ * Usage: bench [--warmup N] [--reps N] [--threads N] [--filter TEXT]
+ *              [--format text|json|csv] [--output FILE] [--perf] [--list]
+ */
+
+typedef enum {
+    BENCH_PLAN,         // One plan
+    BENCH_BANK,         // count kernels of the case's shape as one filter bank
+    BENCH_PLANS,        // The same kernels as count separate plans, run one after the other
+    BENCH_LAYER,        // A count -> count channel 2D layer on one image, from and to NCHW
+    BENCH_LAYER_NCHWC,  // The same layer on activations already in NCHWc
+    BENCH_PAIRS         // The same layer as one plan per channel pair, summed per output channel
+} bench_kind;
+
+typedef struct {
+    tc_op op;
+    int dims;
+    int size_A[3];      // x, y, z
+    int size_B[3];
+    tc_engine engine;
+    int threaded;       // Run on --threads threads instead of one
+    tc_accum accum;
+    tc_dtype dtype;
+    tc_output output;
+    tc_boundary boundary;   // Extension read by 'same' and 'full' outputs
+    int stride;             // Along x and y; 0 means 1
+    int dilation;
+    bench_kind kind;
+    int count;              // Kernels of a bank case, channels in and out of a layer case
+} bench_case;
+
+typedef struct {
+    char name[96];
+    const bench_case *c;
+    int threads;
+    tc_engine engine;   // Engine the plan actually runs
+    double min, median, p90, p99, mean, stddev;
+    double gmacs;       // Multiply-accumulates per second at the median, in billions
+    double macs;        // Multiply-accumulates of all timed repetitions
+    int counted;        // counts holds hardware counters of the timed repetitions
+    tc_perf_counts counts;
+} bench_result;
+
+// Miss events reported per multiply-accumulate with --perf
+static const tc_perf_event miss_events[] = {
+    TC_PERF_L1D_MISSES, TC_PERF_LLC_MISSES, TC_PERF_DTLB_MISSES, TC_PERF_BRANCH_MISSES
+};
+
+#define MISS_EVENTS ((int)(sizeof(miss_events) / sizeof(miss_events[0])))
+
+// The default suite: each shape under every engine that applies to it
+static const bench_case suite[] = {
+    {TC_CONVOLUTION,       1, {262144, 1, 1}, {32, 1, 1},   TC_ENGINE_DIRECT, 0},
+    {TC_CONVOLUTION,       1, {262144, 1, 1}, {32, 1, 1},   TC_ENGINE_FFT,    0},
+    {TC_CONVOLUTION,       1, {262144, 1, 1}, {1024, 1, 1}, TC_ENGINE_DIRECT, 0},
+    {TC_CONVOLUTION,       1, {262144, 1, 1}, {1024, 1, 1}, TC_ENGINE_FFT,    0},
+    {TC_CROSS_CORRELATION, 1, {262144, 1, 1}, {1024, 1, 1}, TC_ENGINE_DIRECT, 0},
+    {TC_CROSS_CORRELATION, 1, {262144, 1, 1}, {1024, 1, 1}, TC_ENGINE_FFT,    0},
+    {TC_CONVOLUTION,       2, {1024, 1024, 1}, {3, 3, 1},   TC_ENGINE_DIRECT, 0},
+    {TC_CONVOLUTION,       2, {1024, 1024, 1}, {7, 7, 1},   TC_ENGINE_DIRECT, 0},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {5, 5, 1},   TC_ENGINE_DIRECT, 0},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {5, 5, 1},   TC_ENGINE_DIRECT, 1},
+    {TC_CONVOLUTION,       3, {64, 64, 64},    {3, 3, 3},   TC_ENGINE_DIRECT, 0},
+    {TC_CONVOLUTION,       3, {96, 96, 96},    {5, 5, 5},   TC_ENGINE_DIRECT, 0},
+    {TC_CONVOLUTION,       3, {96, 96, 96},    {5, 5, 5},   TC_ENGINE_DIRECT, 1},
+    // Separable kernels (outer products of random 1D kernels) as 1D passes
+    {TC_CONVOLUTION,       2, {1024, 1024, 1}, {3, 3, 1},   TC_ENGINE_SEPARABLE, 0},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {5, 5, 1},   TC_ENGINE_SEPARABLE, 0},
+    {TC_CONVOLUTION,       3, {96, 96, 96},    {5, 5, 5},   TC_ENGINE_SEPARABLE, 0},
+    {TC_CONVOLUTION,       3, {96, 96, 96},    {5, 5, 5},   TC_ENGINE_SEPARABLE, 1},
+    // Cost of the 64-bit and saturating accumulators against the int32 cases above
+    {TC_CONVOLUTION,       1, {262144, 1, 1}, {1024, 1, 1}, TC_ENGINE_DIRECT, 0, TC_ACCUM_INT64},
+    {TC_CONVOLUTION,       1, {262144, 1, 1}, {1024, 1, 1}, TC_ENGINE_DIRECT, 0, TC_ACCUM_SAT32},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {5, 5, 1},   TC_ENGINE_DIRECT, 0, TC_ACCUM_INT64},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {5, 5, 1},   TC_ENGINE_DIRECT, 0, TC_ACCUM_SAT32},
+    {TC_CONVOLUTION,       3, {96, 96, 96},    {5, 5, 5},   TC_ENGINE_DIRECT, 0, TC_ACCUM_INT64},
+    // Float and double engines on the same shapes
+    {TC_CONVOLUTION,       1, {262144, 1, 1}, {1024, 1, 1}, TC_ENGINE_DIRECT, 0, TC_ACCUM_AUTO, TC_FLOAT},
+    {TC_CONVOLUTION,       1, {262144, 1, 1}, {1024, 1, 1}, TC_ENGINE_DIRECT, 0, TC_ACCUM_AUTO, TC_DOUBLE},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {5, 5, 1},   TC_ENGINE_DIRECT, 0, TC_ACCUM_AUTO, TC_FLOAT},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {5, 5, 1},   TC_ENGINE_DIRECT, 1, TC_ACCUM_AUTO, TC_FLOAT},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {5, 5, 1},   TC_ENGINE_DIRECT, 0, TC_ACCUM_AUTO, TC_DOUBLE},
+    {TC_CONVOLUTION,       3, {96, 96, 96},    {5, 5, 5},   TC_ENGINE_DIRECT, 0, TC_ACCUM_AUTO, TC_FLOAT},
+    {TC_CONVOLUTION,       3, {96, 96, 96},    {5, 5, 5},   TC_ENGINE_DIRECT, 0, TC_ACCUM_AUTO, TC_DOUBLE},
+    // Rank-2 kernels as two pairs of 1D passes against the full kernel
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {9, 9, 1},   TC_ENGINE_DIRECT,  0, TC_ACCUM_AUTO, TC_FLOAT},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {9, 9, 1},   TC_ENGINE_LOWRANK, 0, TC_ACCUM_AUTO, TC_FLOAT},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {9, 9, 1},   TC_ENGINE_LOWRANK, 1, TC_ACCUM_AUTO, TC_FLOAT},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {9, 9, 1},   TC_ENGINE_DIRECT,  0, TC_ACCUM_AUTO, TC_DOUBLE},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {9, 9, 1},   TC_ENGINE_LOWRANK, 0, TC_ACCUM_AUTO, TC_DOUBLE},
+    // Winograd against the direct engine on 3 x 3 and 5 x 5 kernels
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {3, 3, 1},   TC_ENGINE_DIRECT,   0},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {3, 3, 1},   TC_ENGINE_WINOGRAD, 0},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {3, 3, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {3, 3, 1},   TC_ENGINE_WINOGRAD, 0, TC_ACCUM_AUTO, TC_FLOAT},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {5, 5, 1},   TC_ENGINE_WINOGRAD, 0, TC_ACCUM_AUTO, TC_FLOAT},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {3, 3, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_DOUBLE},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {3, 3, 1},   TC_ENGINE_WINOGRAD, 0, TC_ACCUM_AUTO, TC_DOUBLE},
+    // Implicit GEMM against the direct engine (the direct 3 x 3 cases are above)
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {3, 3, 1},   TC_ENGINE_GEMM,     0},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {3, 3, 1},   TC_ENGINE_GEMM,     0, TC_ACCUM_AUTO, TC_FLOAT},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {7, 7, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {7, 7, 1},   TC_ENGINE_GEMM,     0, TC_ACCUM_AUTO, TC_FLOAT},
+    // 'same' and 'full' outputs against 'valid', with the halo on the boundary path
+    {TC_CONVOLUTION,       2, {1024, 1024, 1}, {5, 5, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT},
+    {TC_CONVOLUTION,       2, {1024, 1024, 1}, {5, 5, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT, TC_OUTPUT_SAME},
+    {TC_CONVOLUTION,       2, {1024, 1024, 1}, {5, 5, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT, TC_OUTPUT_FULL},
+    // Every boundary extension on 'same' outputs (the 'valid' case is with the float cases above)
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {5, 5, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT, TC_OUTPUT_SAME},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {5, 5, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT, TC_OUTPUT_SAME,
+     TC_BOUNDARY_REFLECT},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {5, 5, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT, TC_OUTPUT_SAME,
+     TC_BOUNDARY_REPLICATE},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {5, 5, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT, TC_OUTPUT_SAME,
+     TC_BOUNDARY_WRAP},
+    // Strided and dilated plans on the phase path (the unit-stride case is with the Winograd ones)
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {3, 3, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT, TC_OUTPUT_VALID,
+     TC_BOUNDARY_ZERO, 2},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {3, 3, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT, TC_OUTPUT_VALID,
+     TC_BOUNDARY_ZERO, 4},
+    {TC_CONVOLUTION,       2, {2048, 2048, 1}, {3, 3, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT, TC_OUTPUT_VALID,
+     TC_BOUNDARY_ZERO, 0, 2},
+    // Filter banks against separate plans of the same kernels, and the bank's GEMM grouping
+    {TC_CONVOLUTION,       2, {1024, 1024, 1}, {3, 3, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT,
+     .kind = BENCH_PLANS, .count = 32},
+    {TC_CONVOLUTION,       2, {1024, 1024, 1}, {3, 3, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT,
+     .kind = BENCH_BANK, .count = 32},
+    {TC_CONVOLUTION,       2, {1024, 1024, 1}, {3, 3, 1},   TC_ENGINE_GEMM,     0, TC_ACCUM_AUTO, TC_FLOAT,
+     .kind = BENCH_BANK, .count = 32},
+    {TC_CONVOLUTION,       2, {1024, 1024, 1}, {7, 7, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT,
+     .kind = BENCH_PLANS, .count = 8},
+    {TC_CONVOLUTION,       2, {1024, 1024, 1}, {7, 7, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT,
+     .kind = BENCH_BANK, .count = 8},
+    {TC_CONVOLUTION,       2, {1024, 1024, 1}, {7, 7, 1},   TC_ENGINE_GEMM,     0, TC_ACCUM_AUTO, TC_FLOAT,
+     .kind = BENCH_BANK, .count = 8},
+    // A 64 -> 64 channel layer from NCHW and in NCHWc, against one plan per channel pair
+    {TC_CROSS_CORRELATION, 2, {128, 128, 1},   {3, 3, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT,
+     .kind = BENCH_PAIRS, .count = 64},
+    {TC_CROSS_CORRELATION, 2, {128, 128, 1},   {3, 3, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT,
+     .kind = BENCH_LAYER, .count = 64},
+    {TC_CROSS_CORRELATION, 2, {128, 128, 1},   {3, 3, 1},   TC_ENGINE_DIRECT,   0, TC_ACCUM_AUTO, TC_FLOAT,
+     .kind = BENCH_LAYER_NCHWC, .count = 64},
+    {TC_CROSS_CORRELATION, 2, {128, 128, 1},   {3, 3, 1},   TC_ENGINE_DIRECT,   1, TC_ACCUM_AUTO, TC_FLOAT,
+     .kind = BENCH_LAYER_NCHWC, .count = 64},
+};
+
+#define SUITE_SIZE ((int)(sizeof(suite) / sizeof(suite[0])))
+
+static double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static const char *engine_name(tc_engine engine) {
+    switch (engine) {
+        case TC_ENGINE_FFT: return "fft";
+        case TC_ENGINE_DIRECT: return "direct";
+        case TC_ENGINE_SEPARABLE: return "separable";
+        case TC_ENGINE_LOWRANK: return "lowrank";
+        case TC_ENGINE_WINOGRAD: return "winograd";
+        case TC_ENGINE_GEMM: return "gemm";
+        default: return "auto";
+    }
+}
+
+static const char *accum_suffix(tc_accum accum) {
+    switch (accum) {
+        case TC_ACCUM_INT32: return "_i32";
+        case TC_ACCUM_INT64: return "_i64";
+        case TC_ACCUM_SAT32: return "_sat32";
+        default: return "";
+    }
+}
+
+static const char *dtype_suffix(tc_dtype dtype) {
+    switch (dtype) {
+        case TC_FLOAT: return "_f32";
+        case TC_DOUBLE: return "_f64";
+        default: return "";
+    }
+}
+
+static const char *output_suffix(tc_output output) {
+    switch (output) {
+        case TC_OUTPUT_SAME: return "_same";
+        case TC_OUTPUT_FULL: return "_full";
+        default: return "";
+    }
+}
+
+static const char *boundary_suffix(tc_boundary boundary) {
+    switch (boundary) {
+        case TC_BOUNDARY_REFLECT: return "_reflect";
+        case TC_BOUNDARY_REPLICATE: return "_replicate";
+        case TC_BOUNDARY_WRAP: return "_wrap";
+        default: return "";
+    }
+}
+
+/**
+ * Builds a case name such as "conv2d_2048x2048_k5x5_direct_t8" (extents in x, y, z order),
+ * suffixed with the accumulator, element type, output extent, boundary, stride and
+ * dilation when the case requests one, with "_bank32" or "_plans32" for the
+ * 32 kernels of a bank case and with "_layer64", "_layer64_nchwc" or
+ * "_pairs64" for a 64 -> 64 channel layer case.
+ */
+static void case_name(const bench_case *c, int threads, char *name, size_t size) {
+    int n = snprintf(name, size, "%s%dd_", c->op == TC_CONVOLUTION ? "conv" : "xcorr", c->dims);
+    for (int axis = 0; axis < c->dims; axis++) {
+        n += snprintf(name + n, size - n, axis ? "x%d" : "%d", c->size_A[axis]);
+    }
+    n += snprintf(name + n, size - n, "_k");
+    for (int axis = 0; axis < c->dims; axis++) {
+        n += snprintf(name + n, size - n, axis ? "x%d" : "%d", c->size_B[axis]);
+    }
+    n += snprintf(name + n, size - n, "_%s_t%d%s%s%s%s", engine_name(c->engine), threads,
+                  accum_suffix(c->accum), dtype_suffix(c->dtype), output_suffix(c->output), boundary_suffix(c->boundary));
+    if (c->stride > 1) n += snprintf(name + n, size - n, "_s%d", c->stride);
+    if (c->dilation > 1) n += snprintf(name + n, size - n, "_d%d", c->dilation);
+    switch (c->kind) {
+        case BENCH_BANK: snprintf(name + n, size - n, "_bank%d", c->count); break;
+        case BENCH_PLANS: snprintf(name + n, size - n, "_plans%d", c->count); break;
+        case BENCH_LAYER: snprintf(name + n, size - n, "_layer%d", c->count); break;
+        case BENCH_LAYER_NCHWC: snprintf(name + n, size - n, "_layer%d_nchwc", c->count); break;
+        case BENCH_PAIRS: snprintf(name + n, size - n, "_pairs%d", c->count); break;
+        default: break;
+    }
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Nearest-rank percentile of sorted samples.
+ */
+static double percentile(const double *sorted, int count, double p) {
+    int rank = (int)ceil(p / 100.0 * count);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+static size_t dtype_size(tc_dtype dtype) {
+    return dtype == TC_FLOAT ? sizeof(float) : dtype == TC_DOUBLE ? sizeof(double) : sizeof(int);
+}
+
+/**
+ * Fills count elements of the given type with random integers in [0, range).
+ */
+static void fill_random(void *data, long count, tc_dtype dtype, int range) {
+    for (long i = 0; i < count; i++) {
+        int value = rand() % range;
+        switch (dtype) {
+            case TC_FLOAT: ((float *)data)[i] = (float)value; break;
+            case TC_DOUBLE: ((double *)data)[i] = value; break;
+            default: ((int *)data)[i] = value; break;
+        }
+    }
+}
+
+/**
+ * Fills an int kernel with the outer product of random 1D kernels in [1, 3].
+ */
+static void fill_separable(int *B, const int *size_B) {
+    int factor[3][64];
+    for (int axis = 0; axis < 3; axis++) {
+        for (int k = 0; k < size_B[axis]; k++) factor[axis][k] = 1 + rand() % 3;
+    }
+    for (int z = 0; z < size_B[2]; z++) {
+        for (int y = 0; y < size_B[1]; y++) {
+            for (int x = 0; x < size_B[0]; x++) {
+                B[((long)z * size_B[1] + y) * size_B[0] + x] = factor[2][z] * factor[1][y] * factor[0][x];
+            }
+        }
+    }
+}
+
+/**
+ * Fills a float or double 2D kernel with the sum of two outer products of
+ * random 1D kernels in [1, 3], a kernel of rank 2.
+ */
+static void fill_lowrank(void *B, const int *size_B, tc_dtype dtype) {
+    int factor[2][2][64];
+    for (int q = 0; q < 2; q++) {
+        for (int axis = 0; axis < 2; axis++) {
+            for (int k = 0; k < size_B[axis]; k++) factor[q][axis][k] = 1 + rand() % 3;
+        }
+    }
+    for (int y = 0; y < size_B[1]; y++) {
+        for (int x = 0; x < size_B[0]; x++) {
+            int value = factor[0][1][y] * factor[0][0][x] + factor[1][1][y] * factor[1][0][x];
+            if (dtype == TC_FLOAT) {
+                ((float *)B)[y * size_B[0] + x] = (float)value;
+            } else {
+                ((double *)B)[y * size_B[0] + x] = value;
+            }
+        }
+    }
+}
+
+static void case_options(const bench_case *c, int threads, tc_options *opts) {
+    tc_options_init(opts);
+    opts->engine = c->engine;
+    if (c->engine == TC_ENGINE_LOWRANK) {
+        opts->engine = TC_ENGINE_AUTO;
+        opts->rank_tolerance = 1e-6;
+    }
+    // Int Winograd needs the input range (that of fill_random) to prove its transforms exact
+    if (c->engine == TC_ENGINE_WINOGRAD) {
+        opts->input_min = 0;
+        opts->input_max = 99;
+    }
+    opts->threads = threads;
+    opts->accum = c->accum;
+    opts->output = c->output;
+    opts->boundary = c->boundary;
+    opts->stride[0] = opts->stride[1] = c->stride;
+    opts->dilation[0] = opts->dilation[1] = c->dilation;
+}
+
+static tc_plan *create_plan(const bench_case *c, const void *B, int threads) {
+    tc_options opts;
+    case_options(c, threads, &opts);
+
+    switch (c->dtype) {
+        case TC_FLOAT:
+            return c->dims == 1 ? tc_plan_create_1d_f(c->op, c->size_A[0], B, c->size_B[0], &opts)
+                 : c->dims == 2 ? tc_plan_create_2d_f(c->op, c->size_A[1], c->size_A[0], B, c->size_B[1], c->size_B[0], &opts)
+                 : tc_plan_create_3d_f(c->op, c->size_A[0], c->size_A[1], c->size_A[2],
+                                       B, c->size_B[0], c->size_B[1], c->size_B[2], &opts);
+        case TC_DOUBLE:
+            return c->dims == 1 ? tc_plan_create_1d_d(c->op, c->size_A[0], B, c->size_B[0], &opts)
+                 : c->dims == 2 ? tc_plan_create_2d_d(c->op, c->size_A[1], c->size_A[0], B, c->size_B[1], c->size_B[0], &opts)
+                 : tc_plan_create_3d_d(c->op, c->size_A[0], c->size_A[1], c->size_A[2],
+                                       B, c->size_B[0], c->size_B[1], c->size_B[2], &opts);
+        default:
+            break;
+    }
+    switch (c->dims) {
+        case 1:
+            return tc_plan_create_1d(c->op, c->size_A[0], B, c->size_B[0], &opts);
+        case 2:
+            return tc_plan_create_2d(c->op, c->size_A[1], c->size_A[0], B, c->size_B[1], c->size_B[0], &opts);
+        default:
+            return tc_plan_create_3d(c->op, c->size_A[0], c->size_A[1], c->size_A[2],
+                                     B, c->size_B[0], c->size_B[1], c->size_B[2], &opts);
+    }
+}
+
+/**
+ * Builds the filter bank of a bank case: c->count kernels of its shape, one
+ * after the other in B.
+ */
+static tc_bank *create_bank(const bench_case *c, const char *B, int threads) {
+    tc_options opts;
+    case_options(c, threads, &opts);
+    size_t bytes_B = (size_t)c->size_B[0] * c->size_B[1] * c->size_B[2] * dtype_size(c->dtype);
+    const void **kernels = (const void **)malloc(c->count * sizeof(void *));
+    int *sizes = (int *)malloc(3 * c->count * sizeof(int));
+    if (!kernels || !sizes) {
+        free(kernels);
+        free(sizes);
+        return NULL;
+    }
+    int *size_x = sizes, *size_y = sizes + c->count, *size_z = sizes + 2 * c->count;
+    for (int k = 0; k < c->count; k++) {
+        kernels[k] = B + k * bytes_B;
+        size_x[k] = c->size_B[0];
+        size_y[k] = c->size_B[1];
+        size_z[k] = c->size_B[2];
+    }
+
+    tc_bank *bank;
+    switch (c->dtype) {
+        case TC_FLOAT: {
+            const float *const *B_f = (const float *const *)kernels;
+            bank = c->dims == 1 ? tc_bank_create_1d_f(c->op, c->size_A[0], c->count, B_f, size_x, &opts)
+                 : c->dims == 2 ? tc_bank_create_2d_f(c->op, c->size_A[1], c->size_A[0], c->count, B_f, size_y, size_x, &opts)
+                 : tc_bank_create_3d_f(c->op, c->size_A[0], c->size_A[1], c->size_A[2], c->count,
+                                       B_f, size_x, size_y, size_z, &opts);
+            break;
+        }
+        case TC_DOUBLE: {
+            const double *const *B_d = (const double *const *)kernels;
+            bank = c->dims == 1 ? tc_bank_create_1d_d(c->op, c->size_A[0], c->count, B_d, size_x, &opts)
+                 : c->dims == 2 ? tc_bank_create_2d_d(c->op, c->size_A[1], c->size_A[0], c->count, B_d, size_y, size_x, &opts)
+                 : tc_bank_create_3d_d(c->op, c->size_A[0], c->size_A[1], c->size_A[2], c->count,
+                                       B_d, size_x, size_y, size_z, &opts);
+            break;
+        }
+        default: {
+            const int *const *B_i = (const int *const *)kernels;
+            bank = c->dims == 1 ? tc_bank_create_1d(c->op, c->size_A[0], c->count, B_i, size_x, &opts)
+                 : c->dims == 2 ? tc_bank_create_2d(c->op, c->size_A[1], c->size_A[0], c->count, B_i, size_y, size_x, &opts)
+                 : tc_bank_create_3d(c->op, c->size_A[0], c->size_A[1], c->size_A[2], c->count,
+                                     B_i, size_x, size_y, size_z, &opts);
+            break;
+        }
+    }
+    free(kernels);
+    free(sizes);
+    return bank;
+}
+
+/**
+ * Builds the c->count -> c->count channel 2D layer of a layer case.
+ */
+static tc_layer *create_layer(const bench_case *c, const void *B, int threads) {
+    tc_options opts;
+    case_options(c, threads, &opts);
+    switch (c->dtype) {
+        case TC_FLOAT:
+            return tc_layer_create_2d_f(c->op, c->count, c->size_A[1], c->size_A[0], c->count,
+                                        B, c->size_B[1], c->size_B[0], &opts);
+        case TC_DOUBLE:
+            return tc_layer_create_2d_d(c->op, c->count, c->size_A[1], c->size_A[0], c->count,
+                                        B, c->size_B[1], c->size_B[0], &opts);
+        default:
+            return tc_layer_create_2d(c->op, c->count, c->size_A[1], c->size_A[0], c->count,
+                                      B, c->size_B[1], c->size_B[0], &opts);
+    }
+}
+
+// What the timed region runs: the plans of a case, its bank or its layer
+typedef struct {
+    const bench_case *c;
+    int kernels;        // Kernels of the case, one plan each unless there is a bank or layer
+    int outputs;        // Output buffers
+    long plane_A;       // Input elements per channel
+    tc_plan **plans;    // Kernel k of a pairs case is channel pair (k / count, k % count)
+    tc_bank *bank;
+    tc_layer *layer;
+    void *T;            // Output of one channel pair, before it is added to its channel
+} bench_target;
+
+static int case_kernels(const bench_case *c) {
+    switch (c->kind) {
+        case BENCH_PLAN: return 1;
+        case BENCH_BANK:
+        case BENCH_PLANS: return c->count;
+        default: return c->count * c->count;
+    }
+}
+
+static int case_outputs(const bench_case *c) {
+    switch (c->kind) {
+        case BENCH_PLAN:
+        case BENCH_LAYER:
+        case BENCH_LAYER_NCHWC: return 1;
+        default: return c->count;
+    }
+}
+
+static const tc_plan *target_plan(const bench_target *t, int index) {
+    return t->bank ? tc_bank_plan(t->bank, index) : t->plans[index];
+}
+
+/**
+ * Returns the number of elements of output buffer index.
+ */
+static long target_output_count(const bench_target *t, int index) {
+    if (t->c->kind == BENCH_LAYER_NCHWC) return tc_layer_output_count(t->layer, 1);
+    if (t->layer) return (long)t->c->count * tc_layer_output_size(t->layer, 0) * tc_layer_output_size(t->layer, 1);
+    return tc_plan_output_count(target_plan(t, t->c->kind == BENCH_PAIRS ? index * t->c->count : index));
+}
+
+/**
+ * Returns the multiply-accumulates of one run of the target.
+ */
+static double target_macs(const bench_target *t) {
+    const bench_case *c = t->c;
+    double count_B = (double)c->size_B[0] * c->size_B[1] * c->size_B[2];
+    if (t->layer) {
+        return (double)c->count * c->count * tc_layer_output_size(t->layer, 0) * tc_layer_output_size(t->layer, 1) * count_B;
+    }
+    double macs = 0.0;
+    for (int k = 0; k < t->kernels; k++) macs += (double)tc_plan_output_count(target_plan(t, k)) * count_B;
+    return macs;
+}
+
+static void execute(const tc_plan *plan, tc_dtype dtype, const void *A, void *C) {
+    switch (dtype) {
+        case TC_FLOAT: tc_execute_f(plan, A, C); break;
+        case TC_DOUBLE: tc_execute_d(plan, A, C); break;
+        default: tc_execute(plan, A, C); break;
+    }
+}
+
+/**
+ * Adds count elements of T to C.
+ */
+static void accumulate(void *C, const void *T, long count, tc_dtype dtype) {
+    switch (dtype) {
+        case TC_FLOAT:
+            for (long i = 0; i < count; i++) ((float *)C)[i] += ((const float *)T)[i];
+            break;
+        case TC_DOUBLE:
+            for (long i = 0; i < count; i++) ((double *)C)[i] += ((const double *)T)[i];
+            break;
+        default:
+            for (long i = 0; i < count; i++) ((int *)C)[i] += ((const int *)T)[i];
+            break;
+    }
+}
+
+static void execute_target(const bench_target *t, const void *A, void *const *C) {
+    tc_dtype dtype = t->c->dtype;
+    if (t->bank) {
+        switch (dtype) {
+            case TC_FLOAT: tc_bank_execute_f(t->bank, A, (float *const *)C); break;
+            case TC_DOUBLE: tc_bank_execute_d(t->bank, A, (double *const *)C); break;
+            default: tc_bank_execute(t->bank, A, (int *const *)C); break;
+        }
+    } else if (t->c->kind == BENCH_LAYER) {
+        switch (dtype) {
+            case TC_FLOAT: tc_layer_execute_f(t->layer, 1, A, C[0]); break;
+            case TC_DOUBLE: tc_layer_execute_d(t->layer, 1, A, C[0]); break;
+            default: tc_layer_execute(t->layer, 1, A, C[0]); break;
+        }
+    } else if (t->c->kind == BENCH_LAYER_NCHWC) {
+        switch (dtype) {
+            case TC_FLOAT: tc_layer_execute_nchwc_f(t->layer, 1, A, C[0]); break;
+            case TC_DOUBLE: tc_layer_execute_nchwc_d(t->layer, 1, A, C[0]); break;
+            default: tc_layer_execute_nchwc(t->layer, 1, A, C[0]); break;
+        }
+    } else if (t->c->kind == BENCH_PAIRS) {
+        size_t element = dtype_size(dtype);
+        int channels = t->c->count;
+        for (int o = 0; o < channels; o++) {
+            long count_C = tc_plan_output_count(t->plans[o * channels]);
+            for (int i = 0; i < channels; i++) {
+                const char *a = (const char *)A + i * t->plane_A * element;
+                execute(t->plans[o * channels + i], dtype, a, i ? t->T : C[o]);
+                if (i) accumulate(C[o], t->T, count_C, dtype);
+            }
+        }
+    } else {
+        for (int k = 0; k < t->kernels; k++) {
+            execute(t->plans[k], dtype, A, C[k]);
+        }
+    }
+}
+
+/**
+ * Fills the kernels of a case: separable or rank-2 ones for those engines,
+ * random ones otherwise.
+ */
+static void fill_kernels(const bench_case *c, char *B, int kernels) {
+    long count_B = (long)c->size_B[0] * c->size_B[1] * c->size_B[2];
+    size_t bytes_B = count_B * dtype_size(c->dtype);
+    for (int k = 0; k < kernels; k++) {
+        void *kernel = B + k * bytes_B;
+        if (c->engine == TC_ENGINE_SEPARABLE) {
+            fill_separable(kernel, c->size_B);
+        } else if (c->engine == TC_ENGINE_LOWRANK) {
+            fill_lowrank(kernel, c->size_B, c->dtype);
+        } else {
+            fill_random(kernel, count_B, c->dtype, 10);
+        }
+    }
+}
+
+/**
+ * Builds the plans, bank or layer of a case, and for NCHWc layer cases
+ * replaces the NCHW input *A by its blocked form.
+ *
+ * @return 0 on success, -1 if allocation failed
+ */
+static int create_target(bench_target *t, const char *B, int threads, void **A) {
+    const bench_case *c = t->c;
+    size_t element = dtype_size(c->dtype);
+    size_t bytes_B = (size_t)c->size_B[0] * c->size_B[1] * c->size_B[2] * element;
+
+    if (c->kind == BENCH_BANK) {
+        t->bank = create_bank(c, B, threads);
+        return t->bank ? 0 : -1;
+    }
+    if (c->kind == BENCH_LAYER || c->kind == BENCH_LAYER_NCHWC) {
+        t->layer = create_layer(c, B, threads);
+        if (!t->layer) return -1;
+        if (c->kind == BENCH_LAYER) return 0;
+        void *blocked = malloc(tc_layer_input_count(t->layer, 1) * element);
+        if (!blocked) return -1;
+        switch (c->dtype) {
+            case TC_FLOAT: tc_nchw_to_nchwc_f(*A, 1, c->count, c->size_A[1], c->size_A[0], blocked); break;
+            case TC_DOUBLE: tc_nchw_to_nchwc_d(*A, 1, c->count, c->size_A[1], c->size_A[0], blocked); break;
+            default: tc_nchw_to_nchwc(*A, 1, c->count, c->size_A[1], c->size_A[0], blocked); break;
+        }
+        free(*A);
+        *A = blocked;
+        return 0;
+    }
+    for (int k = 0; k < t->kernels; k++) {
+        t->plans[k] = create_plan(c, B + k * bytes_B, threads);
+        if (!t->plans[k]) return -1;
+    }
+    if (c->kind == BENCH_PAIRS) {
+        t->T = malloc(tc_plan_output_count(t->plans[0]) * element);
+        if (!t->T) return -1;
+    }
+    return 0;
+}
+
+/**
+ * Runs one case and fills in its statistics.
+ *
+ * @return 0 on success, -1 if the plans or the buffers could not be allocated
+ */
+static int run_case(bench_result *r, int warmup, int reps, tc_perf *perf) {
+    const bench_case *c = r->c;
+    long count_A = (long)c->size_A[0] * c->size_A[1] * c->size_A[2];
+    long count_B = (long)c->size_B[0] * c->size_B[1] * c->size_B[2];
+    // Layer and pairs cases read one input plane per channel
+    int channels = (c->kind == BENCH_LAYER || c->kind == BENCH_LAYER_NCHWC || c->kind == BENCH_PAIRS) ? c->count : 1;
+    bench_target target = {c, case_kernels(c), case_outputs(c), count_A};
+
+    size_t element = dtype_size(c->dtype);
+    void *A = malloc(channels * count_A * element);
+    char *B = (char *)malloc(target.kernels * count_B * element);
+    void **C = (void **)calloc(target.outputs, sizeof(void *));
+    target.plans = (tc_plan **)calloc(target.kernels, sizeof(tc_plan *));
+    double *samples = (double *)malloc(reps * sizeof(double));
+    int ready = A && B && C && target.plans && samples;
+    int status = -1;
+
+    if (ready) {
+        fill_random(A, channels * count_A, c->dtype, 100);
+        fill_kernels(c, B, target.kernels);
+        ready = create_target(&target, B, r->threads, &A) == 0;
+    }
+    for (int k = 0; ready && k < target.outputs; k++) {
+        C[k] = malloc(target_output_count(&target, k) * element);
+        ready = C[k] != NULL;
+    }
+
+    if (ready) {
+        for (int i = 0; i < warmup; i++) {
+            execute_target(&target, A, C);
+        }
+        // Counters run across all repetitions, outside each timed interval
+        if (perf) tc_perf_start(perf);
+        for (int i = 0; i < reps; i++) {
+            double start = wall_time();
+            execute_target(&target, A, C);
+            samples[i] = wall_time() - start;
+        }
+        if (perf) {
+            tc_perf_stop(perf, &r->counts);
+            r->counted = 1;
+        }
+
+        double sum = 0.0;
+        for (int i = 0; i < reps; i++) sum += samples[i];
+        r->mean = sum / reps;
+        double squares = 0.0;
+        for (int i = 0; i < reps; i++) squares += (samples[i] - r->mean) * (samples[i] - r->mean);
+        r->stddev = reps > 1 ? sqrt(squares / (reps - 1)) : 0.0;
+
+        qsort(samples, reps, sizeof(double), compare_doubles);
+        r->min = samples[0];
+        r->median = percentile(samples, reps, 50.0);
+        r->p90 = percentile(samples, reps, 90.0);
+        r->p99 = percentile(samples, reps, 99.0);
+        // Layers have no plan; they run their own direct kernels
+        if (!target.layer) r->engine = tc_plan_engine(target_plan(&target, 0));
+        double macs = target_macs(&target);
+        r->gmacs = macs / r->median / 1e9;
+        r->macs = macs * reps;
+        status = 0;
+    }
+
+    for (int k = 0; target.plans && k < target.kernels; k++) tc_plan_destroy(target.plans[k]);
+    for (int k = 0; C && k < target.outputs; k++) free(C[k]);
+    tc_bank_destroy(target.bank);
+    tc_layer_destroy(target.layer);
+    free(target.plans);
+    free(target.T);
+    free(A);
+    free(B);
+    free(C);
+    free(samples);
+    return status;
+}
+
+static void print_shape_json(FILE *out, const int *shape, int dims) {
+    fprintf(out, "[");
+    for (int axis = 0; axis < dims; axis++) {
+        fprintf(out, axis ? ", %d" : "%d", shape[axis]);
+    }
+    fprintf(out, "]");
+}
+
+/**
+ * Writes a counter-derived value, or null / an empty field when it was not counted.
+ */
+static void print_metric(FILE *out, double value, const char *missing) {
+    if (value >= 0) {
+        fprintf(out, "%.6g", value);
+    } else {
+        fprintf(out, "%s", missing);
+    }
+}
+
+static void write_json(FILE *out, const bench_result *results, int count, int warmup, int reps) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"isa\": \"%s\",\n", tc_isa());
+    fprintf(out, "  \"warmup\": %d,\n", warmup);
+    fprintf(out, "  \"repetitions\": %d,\n", reps);
+    fprintf(out, "  \"unit\": \"seconds\",\n");
+    fprintf(out, "  \"results\": [\n");
+    for (int i = 0; i < count; i++) {
+        const bench_result *r = &results[i];
+        fprintf(out, "    {\"name\": \"%s\", \"op\": \"%s\", \"dims\": %d, \"shape_A\": ",
+                r->name, r->c->op == TC_CONVOLUTION ? "convolution" : "cross_correlation", r->c->dims);
+        print_shape_json(out, r->c->size_A, r->c->dims);
+        fprintf(out, ", \"shape_B\": ");
+        print_shape_json(out, r->c->size_B, r->c->dims);
+        fprintf(out, ", \"engine\": \"%s\", \"threads\": %d, "
+                "\"min\": %.9f, \"median\": %.9f, \"p90\": %.9f, \"p99\": %.9f, "
+                "\"mean\": %.9f, \"stddev\": %.9f, \"gmacs\": %.3f",
+                engine_name(r->engine), r->threads,
+                r->min, r->median, r->p90, r->p99, r->mean, r->stddev, r->gmacs);
+        if (r->counted) {
+            fprintf(out, ", \"ipc\": ");
+            print_metric(out, tc_perf_ipc(&r->counts), "null");
+            for (int e = 0; e < MISS_EVENTS; e++) {
+                fprintf(out, ", \"%s_per_mac\": ", tc_perf_event_name(miss_events[e]));
+                print_metric(out, tc_perf_per_mac(&r->counts, miss_events[e], r->macs), "null");
+            }
+        }
+        fprintf(out, "}%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static void write_csv(FILE *out, const bench_result *results, int count, int counted) {
+    fprintf(out, "name,op,dims,shape_A,shape_B,engine,threads,min,median,p90,p99,mean,stddev,gmacs");
+    if (counted) {
+        fprintf(out, ",ipc");
+        for (int e = 0; e < MISS_EVENTS; e++) {
+            fprintf(out, ",%s_per_mac", tc_perf_event_name(miss_events[e]));
+        }
+    }
+    fprintf(out, "\n");
+    for (int i = 0; i < count; i++) {
+        const bench_result *r = &results[i];
+        const bench_case *c = r->c;
+        fprintf(out, "%s,%s,%d,%dx%dx%d,%dx%dx%d,%s,%d,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f,%.3f",
+                r->name, c->op == TC_CONVOLUTION ? "convolution" : "cross_correlation", c->dims,
+                c->size_A[0], c->size_A[1], c->size_A[2], c->size_B[0], c->size_B[1], c->size_B[2],
+                engine_name(r->engine), r->threads,
+                r->min, r->median, r->p90, r->p99, r->mean, r->stddev, r->gmacs);
+        if (counted) {
+            fprintf(out, ",");
+            print_metric(out, tc_perf_ipc(&r->counts), "");
+            for (int e = 0; e < MISS_EVENTS; e++) {
+                fprintf(out, ",");
+                print_metric(out, tc_perf_per_mac(&r->counts, miss_events[e], r->macs), "");
+            }
+        }
+        fprintf(out, "\n");
+    }
+}
+
+static void write_text(FILE *out, const bench_result *results, int count, int warmup, int reps, int counted) {
+    fprintf(out, "tileconv benchmark (isa %s, %d warmup, %d repetitions, times in ms)\n\n", tc_isa(), warmup, reps);
+    fprintf(out, "%-48s %10s %10s %10s %10s %10s %8s", "case", "min", "median", "p90", "p99", "stddev", "GMAC/s");
+    if (counted) {
+        fprintf(out, " %6s %10s %10s %10s %10s", "IPC", "L1D/MAC", "LLC/MAC", "dTLB/MAC", "branch/MAC");
+    }
+    fprintf(out, "\n");
+    for (int i = 0; i < count; i++) {
+        const bench_result *r = &results[i];
+        fprintf(out, "%-48s %10.3f %10.3f %10.3f %10.3f %10.3f %8.2f", r->name,
+                r->min * 1e3, r->median * 1e3, r->p90 * 1e3, r->p99 * 1e3, r->stddev * 1e3, r->gmacs);
+        if (counted) {
+            double ipc = tc_perf_ipc(&r->counts);
+            if (ipc >= 0) {
+                fprintf(out, " %6.2f", ipc);
+            } else {
+                fprintf(out, " %6s", "n/a");
+            }
+            for (int e = 0; e < MISS_EVENTS; e++) {
+                double per_mac = tc_perf_per_mac(&r->counts, miss_events[e], r->macs);
+                if (per_mac >= 0) {
+                    fprintf(out, " %10.5f", per_mac);
+                } else {
+                    fprintf(out, " %10s", "n/a");
+                }
+            }
+        }
+        fprintf(out, "\n");
+    }
+}
+
+static void usage(const char *program) {
+    printf("Usage: %s [--warmup N] [--reps N] [--threads N] [--filter TEXT]\n"
+           "       %*s [--format text|json|csv] [--output FILE] [--perf] [--list]\n",
+           program, (int)strlen(program), "");
+}
+
+int main(int argc, char **argv) {
+    int warmup = 3, reps = 20, list = 0, use_perf = 0;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char *filter = NULL, *format = "text", *output = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--list") == 0) {
+            list = 1;
+        } else if (strcmp(arg, "--perf") == 0) {
+            use_perf = 1;
+        } else if (value && strcmp(arg, "--warmup") == 0) {
+            warmup = atoi(value);
+            i++;
+        } else if (value && strcmp(arg, "--reps") == 0) {
+            reps = atoi(value);
+            i++;
+        } else if (value && strcmp(arg, "--threads") == 0) {
+            threads = atoi(value);
+            i++;
+        } else if (value && strcmp(arg, "--filter") == 0) {
+            filter = value;
+            i++;
+        } else if (value && strcmp(arg, "--format") == 0) {
+            format = value;
+            i++;
+        } else if (value && strcmp(arg, "--output") == 0) {
+            output = value;
+            i++;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (warmup < 0 || reps < 1 || threads < 1 ||
+        (strcmp(format, "text") != 0 && strcmp(format, "json") != 0 && strcmp(format, "csv") != 0)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    tc_tune_set_db_path("");
+
+    bench_result *results = (bench_result *)calloc(SUITE_SIZE, sizeof(bench_result));
+    if (!results) {
+        printf("Memory allocation failed\n");
+        return 1;
+    }
+
+    // Threaded cases only make sense with more than one thread
+    int count = 0;
+    for (int i = 0; i < SUITE_SIZE; i++) {
+        const bench_case *c = &suite[i];
+        if (c->threaded && threads == 1) continue;
+        bench_result *r = &results[count];
+        r->c = c;
+        r->threads = c->threaded ? threads : 1;
+        r->engine = c->engine;
+        case_name(c, r->threads, r->name, sizeof(r->name));
+        if (filter && !strstr(r->name, filter)) continue;
+        count++;
+    }
+
+    if (list) {
+        for (int i = 0; i < count; i++) printf("%s\n", results[i].name);
+        free(results);
+        return 0;
+    }
+
+    // Counters are opened before any plan starts worker threads, so they include them
+    tc_perf *perf = NULL;
+    if (use_perf) {
+        perf = tc_perf_open();
+        if (!perf) fprintf(stderr, "Hardware counters are not available on this system\n");
+    }
+
+    srand(12345);
+    for (int i = 0; i < count; i++) {
+        // Progress goes to stderr so stdout stays machine-readable
+        fprintf(stderr, "[%d/%d] %s\n", i + 1, count, results[i].name);
+        if (run_case(&results[i], warmup, reps, perf) != 0) {
+            printf("Memory allocation failed\n");
+            tc_perf_close(perf);
+            free(results);
+            return 1;
+        }
+    }
+    tc_perf_close(perf);
+
+    FILE *out = stdout;
+    if (output) {
+        out = fopen(output, "w");
+        if (!out) {
+            printf("Cannot open %s for writing\n", output);
+            free(results);
+            return 1;
+        }
+    }
+
+    if (strcmp(format, "json") == 0) {
+        write_json(out, results, count, warmup, reps);
+    } else if (strcmp(format, "csv") == 0) {
+        write_csv(out, results, count, perf != NULL);
+    } else {
+        write_text(out, results, count, warmup, reps, perf != NULL);
+    }
+
+    if (out != stdout) fclose(out);
+    free(results);
+    return 0;
+}
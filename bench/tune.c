@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tileconv.h"
+
+/**
+ * Command-line front end of the tileconv autotuner.
+ *
+ * Tunes the tiles of one op and shape in-process and stores the winner in the
+ * tuning database, which every later plan of that shape picks up. A shape that
+ * is already in the database is reported without re-tuning unless --force is given.
+ *
+ * Shapes are N for 1D, HxW for 2D (height first, as in the 2D programs) and
+ * XxYxZ for 3D; the kernel shape must have the same number of axes.
+ *
+ * With --quiet only the winning tiles are printed, in the order the comparison
+ * programs read them: "tile_A tile_B" (1D), "tile_height tile_width" (2D) or
+ * "tile_A_x tile_A_y tile_A_z tile_B_x tile_B_y tile_B_z" (3D).
+ *
+ * Usage: tune [--threads N] [--budget SECONDS] [--force] [--db PATH] [--quiet]
+ *             conv|xcorr SHAPE_A SHAPE_B
+ */
+
+static void usage(const char *program) {
+    printf("Usage: %s [--threads N] [--budget SECONDS] [--force] [--db PATH] [--quiet]\n"
+           "       %*s conv|xcorr SHAPE_A SHAPE_B\n"
+           "Shapes: N (1D), HxW (2D) or XxYxZ (3D), e.g. %s conv 512x512 5x5\n",
+           program, (int)strlen(program), "", program);
+}
+
+/**
+ * Parses an 'x'-separated shape of up to three extents.
+ *
+ * @return The number of axes, or -1 if the shape is malformed
+ */
+static int parse_shape(const char *text, int extent[3]) {
+    int axes = 0;
+    const char *p = text;
+    for (;;) {
+        char *end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value < 1 || axes == 3) return -1;
+        extent[axes++] = (int)value;
+        if (*end == '\0') break;
+        if (*end != 'x') return -1;
+        p = end + 1;
+    }
+    return axes;
+}
+
+/**
+ * Converts a parsed shape to the library's x, y, z order (2D shapes are given height first).
+ */
+static void to_xyz(const int extent[3], int axes, int xyz[3]) {
+    xyz[0] = xyz[1] = xyz[2] = 1;
+    if (axes == 2) {
+        xyz[0] = extent[1];
+        xyz[1] = extent[0];
+    } else {
+        for (int axis = 0; axis < axes; axis++) xyz[axis] = extent[axis];
+    }
+}
+
+int main(int argc, char **argv) {
+    int threads = 1, force = 0, quiet = 0;
+    double budget = 0.0;
+    const char *positional[3];
+    int positionals = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--force") == 0) {
+            force = 1;
+        } else if (strcmp(arg, "--quiet") == 0) {
+            quiet = 1;
+        } else if (value && strcmp(arg, "--threads") == 0) {
+            threads = atoi(value);
+            i++;
+        } else if (value && strcmp(arg, "--budget") == 0) {
+            budget = atof(value);
+            i++;
+        } else if (value && strcmp(arg, "--db") == 0) {
+            tc_tune_set_db_path(value);
+            i++;
+        } else if (arg[0] != '-' && positionals < 3) {
+            positional[positionals++] = arg;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    int extent_A[3], extent_B[3];
+    int dims = positionals == 3 ? parse_shape(positional[1], extent_A) : -1;
+    if (dims < 1 || parse_shape(positional[2], extent_B) != dims || threads < 1 || budget < 0 ||
+        (strcmp(positional[0], "conv") != 0 && strcmp(positional[0], "xcorr") != 0)) {
+        usage(argv[0]);
+        return 1;
+    }
+    tc_op op = strcmp(positional[0], "conv") == 0 ? TC_CONVOLUTION : TC_CROSS_CORRELATION;
+
+    int size_A[3], size_B[3];
+    to_xyz(extent_A, dims, size_A);
+    to_xyz(extent_B, dims, size_B);
+    for (int axis = 0; axis < 3; axis++) {
+        if (size_B[axis] > size_A[axis]) {
+            printf("Kernel must not be larger than the input\n");
+            return 1;
+        }
+    }
+
+    tc_options opts;
+    tc_options_init(&opts);
+    opts.threads = threads;
+
+    if (!quiet) {
+        const char *db = tc_tune_db_path();
+        printf("CPU: %s (%s kernels)\n", tc_cpu_model(), tc_isa());
+        printf("Tuning database: %s\n", db ? db : "disabled");
+        printf("Tuning %s %dD %s with kernel %s on %d thread%s...\n", positional[0], dims,
+               positional[1], positional[2], dims == 1 ? 1 : threads,
+               (dims == 1 || threads == 1) ? "" : "s");
+    }
+
+    tc_tune_result result;
+    if (tc_tune(op, dims, size_A, size_B, &opts, budget, force, &result) != 0) {
+        printf("Memory allocation failed\n");
+        return 1;
+    }
+
+    const int *tile_A = result.options.tile_A, *tile_B = result.options.tile_B;
+    if (quiet) {
+        if (dims == 1) {
+            printf("%d %d\n", tile_A[0], tile_B[0]);
+        } else if (dims == 2) {
+            printf("%d %d\n", tile_A[1], tile_A[0]);
+        } else {
+            printf("%d %d %d %d %d %d\n", tile_A[0], tile_A[1], tile_A[2],
+                   tile_B[0], tile_B[1], tile_B[2]);
+        }
+        return 0;
+    }
+
+    if (dims == 1) {
+        printf("Best: tile_A=%d tile_B=%d", tile_A[0], tile_B[0]);
+    } else if (dims == 2) {
+        printf("Best: tile_height=%d tile_width=%d", tile_A[1], tile_A[0]);
+    } else {
+        printf("Best: tile_A=%dx%dx%d tile_B=%dx%dx%d", tile_A[0], tile_A[1], tile_A[2],
+               tile_B[0], tile_B[1], tile_B[2]);
+    }
+    printf(" engine=%s, %.6f seconds per run\n",
+           result.options.engine == TC_ENGINE_FFT ? "fft" : "direct", result.seconds);
+
+    if (result.cached) {
+        printf("Taken from the tuning database (use --force to tune again)\n");
+    } else {
+        printf("Mean of %d runs: %.6f seconds, 95%% confidence interval [%.6f, %.6f]\n",
+               result.ci_runs, result.mean_seconds, result.ci_low, result.ci_high);
+        if (result.proxy_evaluated) {
+            printf("Timed %d configurations on a shrunken proxy and %d on the full shape; %s\n",
+                   result.proxy_evaluated, result.evaluated,
+                   result.saved ? "saved to the tuning database" : "not saved (database disabled or not writable)");
+        } else {
+            printf("Timed %d configurations; %s\n", result.evaluated,
+                   result.saved ? "saved to the tuning database" : "not saved (database disabled or not writable)");
+        }
+    }
+    return 0;
+}
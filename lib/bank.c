@@ -0,0 +1,315 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "tileconv_internal.h"
+
+/*
+ * Filter banks. Every kernel gets an ordinary single-threaded plan whose
+ * tile_A is the bank's block size (or its whole output along an axis where
+ * that is smaller), so block (x0, y0, z0) means the same outputs for every
+ * plan. Execution visits each block once and runs all kernels on it before
+ * moving on, so the input block and its halo come from memory once per bank
+ * instead of once per kernel. The blocks are the tasks of a threaded bank.
+ *
+ * With TC_ENGINE_GEMM, 2D kernels of the same shape are grouped: a group
+ * runs as one implicit GEMM per block, which multiplies each packed panel of
+ * input patches with every kernel of the group while the panel is in L1. The
+ * direct kernels already keep a block's input rows in L1, so AUTO does not
+ * group: on single-channel input the GEMM micro-kernel loses to them at every
+ * bank size we measured (8 to 32 kernels of 3 x 3 to 7 x 7).
+ */
+
+typedef struct {
+    int first;          // Offset of the group's kernels in tc_bank.order
+    int count;
+    void *W;            // Their oriented kernels, packed by tc_gemm_pack
+} bank_group;
+
+struct tc_bank {
+    int dims;
+    tc_dtype dtype;
+    int count;
+    int size_A[3];
+    tc_plan **plans;
+    int *group_of;      // Group of each kernel, or -1 if it runs on its own plan
+    int *order;         // Indices of the grouped kernels, group by group
+    int grouped;        // Kernels in order
+    bank_group *groups;
+    int group_count;
+    int tile[3];        // Output block per axis
+    int blocks[3];      // Blocks per axis over the largest output
+    tc_pool *pool;      // NULL runs on the calling thread
+    int owns_pool;
+};
+
+/**
+ * Returns 1 if kernel k may join a GEMM group: a 2D plan with unit-stride
+ * 'valid' output on the direct or GEMM engine, with the 32-bit accumulator
+ * for int.
+ */
+static int groupable(const tc_bank *bank, int k) {
+    const tc_plan *plan = bank->plans[k];
+    if (bank->dims != 2 || plan->pad[0] != 0 || plan->pad[1] != 0 || plan->strided) return 0;
+    if (plan->engine != TC_ENGINE_DIRECT && plan->engine != TC_ENGINE_GEMM) return 0;
+    return plan->dtype != TC_INT || plan->accum == TC_ACCUM_INT32;
+}
+
+/**
+ * Groups same-shape kernels for the GEMM path and packs each group.
+ *
+ * @return 0, or -1 if memory allocation failed
+ */
+static int build_groups(tc_bank *bank, tc_engine requested) {
+    int count = bank->count;
+    for (int k = 0; k < count; k++) bank->group_of[k] = -1;
+    if (requested != TC_ENGINE_GEMM) return 0;
+
+    size_t element = bank->dtype == TC_FLOAT ? sizeof(float) : bank->dtype == TC_DOUBLE ? sizeof(double) : sizeof(int);
+    for (int k = 0; k < count; k++) {
+        if (bank->group_of[k] >= 0 || !groupable(bank, k)) continue;
+
+        const int *size_B = bank->plans[k]->size_B;
+        int members = 0;
+        for (int j = k; j < count; j++) {
+            const int *other = bank->plans[j]->size_B;
+            if (groupable(bank, j) && other[0] == size_B[0] && other[1] == size_B[1]) members++;
+        }
+
+        // The members' kernels one after the other, then packed
+        long K = (long)size_B[0] * size_B[1];
+        char *W = (char *)malloc((size_t)members * K * element);
+        if (!W) return -1;
+        bank_group *group = &bank->groups[bank->group_count];
+        group->first = bank->grouped;
+        group->count = 0;
+        for (int j = k; j < count; j++) {
+            const tc_plan *plan = bank->plans[j];
+            if (!groupable(bank, j) || plan->size_B[0] != size_B[0] || plan->size_B[1] != size_B[1]) continue;
+            const void *W_j = plan->dtype == TC_INT ? (const void *)plan->W : plan->W_real;
+            memcpy(W + group->count * K * element, W_j, K * element);
+            bank->group_of[j] = bank->group_count;
+            bank->order[bank->grouped++] = j;
+            group->count++;
+        }
+        int status = tc_gemm_pack(W, group->count, K, bank->dtype, &group->W);
+        free(W);
+        if (status != 0) return -1;
+        bank->group_count++;
+    }
+    return 0;
+}
+
+tc_bank *tc_bank_create_typed(tc_op op, int dims, const int size_A[3], int count,
+                              const void *const *B, const int *const size_B[3], tc_dtype dtype,
+                              const tc_options *opts) {
+    tc_options defaults;
+    if (!opts) {
+        tc_options_init(&defaults);
+        opts = &defaults;
+    }
+    if (count < 1) return NULL;
+
+    tc_bank *bank = (tc_bank *)calloc(1, sizeof(tc_bank));
+    if (!bank) return NULL;
+    bank->dims = dims;
+    bank->dtype = dtype;
+    bank->count = count;
+    memcpy(bank->size_A, size_A, sizeof(bank->size_A));
+    bank->plans = (tc_plan **)calloc(count, sizeof(tc_plan *));
+    bank->group_of = (int *)malloc(count * sizeof(int));
+    bank->order = (int *)malloc(count * sizeof(int));
+    bank->groups = (bank_group *)calloc(count, sizeof(bank_group));
+    if (!bank->plans || !bank->group_of || !bank->order || !bank->groups) {
+        tc_bank_destroy(bank);
+        return NULL;
+    }
+
+    // The plans run single-threaded inside the bank's blocks
+    tc_options plan_opts = *opts;
+    plan_opts.threads = 0;
+    plan_opts.pool = NULL;
+
+    int largest = 0;
+    for (int k = 0; k < count; k++) {
+        int shape_B[3];
+        for (int axis = 0; axis < 3; axis++) shape_B[axis] = size_B[axis] ? size_B[axis][k] : 1;
+        bank->plans[k] = tc_plan_create_typed(op, dims, size_A, B[k], shape_B, dtype, &plan_opts);
+        if (!bank->plans[k]) {
+            tc_bank_destroy(bank);
+            return NULL;
+        }
+        if (tc_plan_output_count(bank->plans[k]) > tc_plan_output_count(bank->plans[largest])) largest = k;
+    }
+
+    if (opts->pool) {
+        bank->pool = opts->pool;
+    } else if (opts->threads > 1) {
+        bank->pool = tc_pool_create(opts->threads);
+        bank->owns_pool = 1;
+        if (!bank->pool) {
+            tc_bank_destroy(bank);
+            return NULL;
+        }
+    }
+
+    // Blocks follow the tiles of the kernel with the largest output and cover every output
+    memcpy(bank->tile, bank->plans[largest]->tile_A, sizeof(bank->tile));
+    if (dims == 2 && bank->pool && tc_pool_size(bank->pool) > 1) {
+        // As for threaded 2D plans: blocks start on a cache line of C
+        int line = TC_CACHE_LINE / (int)(dtype == TC_DOUBLE ? sizeof(double) : sizeof(int));
+        int tile_width = (bank->tile[0] + line - 1) / line * line;
+        int width_C = bank->plans[largest]->size_C[0];
+        bank->tile[0] = tile_width < width_C ? tile_width : width_C;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        int size_C = 1;
+        for (int k = 0; k < count; k++) {
+            tc_plan *plan = bank->plans[k];
+            plan->tile_A[axis] = bank->tile[axis] < plan->size_C[axis] ? bank->tile[axis] : plan->size_C[axis];
+            if (plan->size_C[axis] > size_C) size_C = plan->size_C[axis];
+        }
+        bank->blocks[axis] = (size_C + bank->tile[axis] - 1) / bank->tile[axis];
+    }
+
+    if (build_groups(bank, opts->engine) != 0) {
+        tc_bank_destroy(bank);
+        return NULL;
+    }
+    return bank;
+}
+
+tc_bank *tc_bank_create_1d(tc_op op, int size_A, int count, const int *const *B, const int *size_B,
+                           const tc_options *opts) {
+    int shape_A[3] = {size_A, 1, 1};
+    const int *shape_B[3] = {size_B, NULL, NULL};
+    return tc_bank_create_typed(op, 1, shape_A, count, (const void *const *)B, shape_B, TC_INT, opts);
+}
+
+tc_bank *tc_bank_create_2d(tc_op op, int height_A, int width_A, int count, const int *const *B,
+                           const int *height_B, const int *width_B, const tc_options *opts) {
+    int shape_A[3] = {width_A, height_A, 1};
+    const int *shape_B[3] = {width_B, height_B, NULL};
+    return tc_bank_create_typed(op, 2, shape_A, count, (const void *const *)B, shape_B, TC_INT, opts);
+}
+
+tc_bank *tc_bank_create_3d(tc_op op, int size_A_x, int size_A_y, int size_A_z, int count,
+                           const int *const *B, const int *size_B_x, const int *size_B_y, const int *size_B_z,
+                           const tc_options *opts) {
+    int shape_A[3] = {size_A_x, size_A_y, size_A_z};
+    const int *shape_B[3] = {size_B_x, size_B_y, size_B_z};
+    return tc_bank_create_typed(op, 3, shape_A, count, (const void *const *)B, shape_B, TC_INT, opts);
+}
+
+typedef struct {
+    const tc_bank *bank;
+    const void *A;
+    void *const *C;
+    void **group_C;     // C of the kernels in tc_bank.order; NULL runs every kernel on its own plan
+} bank_job;
+
+/**
+ * Runs one plan of the bank on the block at (x0, y0, z0) of its dense output.
+ */
+static void plan_block(const tc_plan *plan, const void *A, const int size_A[3], void *C, int x0, int y0, int z0) {
+    long row_A = size_A[0], slice_A = (long)size_A[0] * size_A[1];
+    long row_C = plan->size_C[0], slice_C = (long)plan->size_C[0] * plan->size_C[1];
+    switch (plan->dtype) {
+        case TC_FLOAT:
+            tc_direct_block_f(plan, (const float *)A, row_A, slice_A, (float *)C, row_C, slice_C, x0, y0, z0);
+            break;
+        case TC_DOUBLE:
+            tc_direct_block_d(plan, (const double *)A, row_A, slice_A, (double *)C, row_C, slice_C, x0, y0, z0);
+            break;
+        default:
+            tc_direct_block(plan, (const int *)A, row_A, slice_A, (int *)C, row_C, slice_C, x0, y0, z0);
+            break;
+    }
+}
+
+/**
+ * Computes block (x0, y0, z0) of every kernel: the GEMM groups first, then
+ * each remaining kernel whose output reaches the block.
+ */
+static void bank_block(const bank_job *job, int x0, int y0, int z0) {
+    const tc_bank *bank = job->bank;
+
+    for (int g = 0; job->group_C && g < bank->group_count; g++) {
+        const bank_group *group = &bank->groups[g];
+        const tc_plan *plan = bank->plans[bank->order[group->first]];
+        if (x0 >= plan->size_C[0] || y0 >= plan->size_C[1]) continue;
+        int x1 = (x0 + bank->tile[0] < plan->size_C[0]) ? x0 + bank->tile[0] : plan->size_C[0];
+        int y1 = (y0 + bank->tile[1] < plan->size_C[1]) ? y0 + bank->tile[1] : plan->size_C[1];
+        tc_gemm_block_2d(bank->dtype, group->W, group->count, plan->size_B, job->A, bank->size_A[0],
+                         job->group_C + group->first, plan->size_C[0], y0, y1, x0, x1);
+    }
+
+    for (int k = 0; k < bank->count; k++) {
+        const tc_plan *plan = bank->plans[k];
+        if ((job->group_C && bank->group_of[k] >= 0) || plan->engine == TC_ENGINE_FFT) continue;
+        if (x0 >= plan->size_C[0] || y0 >= plan->size_C[1] || z0 >= plan->size_C[2]) continue;
+        plan_block(plan, job->A, bank->size_A, job->C[k], x0, y0, z0);
+    }
+}
+
+static void bank_block_task(void *ctx, int index) {
+    const bank_job *job = (const bank_job *)ctx;
+    const tc_bank *bank = job->bank;
+    int bx = index % bank->blocks[0];
+    int by = index / bank->blocks[0] % bank->blocks[1];
+    int bz = index / bank->blocks[0] / bank->blocks[1];
+    bank_block(job, bx * bank->tile[0], by * bank->tile[1], bz * bank->tile[2]);
+}
+
+void tc_bank_run(const tc_bank *bank, const void *A, void *const *C) {
+    // Group members are addressed group by group; without room for that list
+    // every kernel runs on its own plan, which gives the same outputs
+    bank_job job = {bank, A, C, NULL};
+    if (bank->group_count > 0) {
+        job.group_C = (void **)malloc(bank->grouped * sizeof(void *));
+        for (int i = 0; job.group_C && i < bank->grouped; i++) job.group_C[i] = C[bank->order[i]];
+    }
+
+    int blocks = bank->blocks[0] * bank->blocks[1] * bank->blocks[2];
+    if (bank->pool) {
+        tc_pool_run(bank->pool, blocks, bank_block_task, &job);
+    } else {
+        for (int b = 0; b < blocks; b++) bank_block_task(&job, b);
+    }
+
+    // 1D kernels on the FFT engine transform the whole input at once
+    for (int k = 0; k < bank->count; k++) {
+        const tc_plan *plan = bank->plans[k];
+        if (plan->engine != TC_ENGINE_FFT) continue;
+        tc_fft_execute_1d(plan, (const int *)A, (int *)C[k], NULL);
+    }
+    free(job.group_C);
+}
+
+void tc_bank_execute(const tc_bank *bank, const int *A, int *const *C) {
+    if (bank->dtype != TC_INT) return;
+    tc_bank_run(bank, A, (void *const *)C);
+}
+
+int tc_bank_size(const tc_bank *bank) {
+    return bank->count;
+}
+
+const tc_plan *tc_bank_plan(const tc_bank *bank, int index) {
+    return (index >= 0 && index < bank->count) ? bank->plans[index] : NULL;
+}
+
+int tc_bank_grouped(const tc_bank *bank, int index) {
+    return index >= 0 && index < bank->count && bank->group_of[index] >= 0;
+}
+
+void tc_bank_destroy(tc_bank *bank) {
+    if (!bank) return;
+    for (int k = 0; bank->plans && k < bank->count; k++) tc_plan_destroy(bank->plans[k]);
+    for (int g = 0; bank->groups && g < bank->group_count; g++) free(bank->groups[g].W);
+    if (bank->owns_pool) tc_pool_destroy(bank->pool);
+    free(bank->plans);
+    free(bank->group_of);
+    free(bank->order);
+    free(bank->groups);
+    free(bank);
+}
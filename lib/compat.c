@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tileconv.h"
+
+/**
+ * Aborts like the standalone programs do when a one-shot plan cannot be built.
+ */
+static tc_plan *require_plan(tc_plan *plan) {
+    if (!plan) {
+        printf("Memory allocation failed\n");
+        exit(1);
+    }
+    return plan;
+}
+
+void tiled_cross_correlation_1d(int *A, int size_A, int *B, int size_B, int *C, int tile_A, int tile_B) {
+    tc_options opts;
+    tc_options_init(&opts);
+    opts.tile_A[0] = tile_A;
+    opts.tile_B[0] = tile_B;
+
+    tc_plan *plan = require_plan(tc_plan_create_1d(TC_CROSS_CORRELATION, size_A, B, size_B, &opts));
+    tc_execute(plan, A, C);
+    tc_plan_destroy(plan);
+}
+
+void tiled_convolution_1d(int *A, int size_A, int *B, int size_B, int *C, int tile_A, int tile_B) {
+    tc_options opts;
+    tc_options_init(&opts);
+    opts.tile_A[0] = tile_A;
+    opts.tile_B[0] = tile_B;
+
+    tc_plan *plan = require_plan(tc_plan_create_1d(TC_CONVOLUTION, size_A, B, size_B, &opts));
+    tc_execute(plan, A, C);
+    tc_plan_destroy(plan);
+}
+
+/**
+ * Runs a one-shot 2D plan on row arrays. Both operations share the engine;
+ * the plan orients the kernel for op once.
+ */
+static void tiled_2d(tc_op op, int **A, int height_A, int width_A,
+                     int **B, int height_B, int width_B,
+                     int **C, int tile_height, int tile_width) {
+    // Copy the row arrays into the contiguous pitched layout the engine works on
+    tc_matrix *matrix_A = tc_matrix_from_rows(A, height_A, width_A);
+    tc_matrix *matrix_B = tc_matrix_from_rows(B, height_B, width_B);
+    tc_matrix *matrix_C = tc_matrix_create(height_A - height_B + 1, width_A - width_B + 1);
+    if (!matrix_A || !matrix_B || !matrix_C) {
+        printf("Memory allocation failed\n");
+        exit(1);
+    }
+
+    // The plan wants a dense kernel, so drop the pitch padding
+    int *packed_B = (int *)malloc((size_t)height_B * width_B * sizeof(int));
+    if (!packed_B) {
+        printf("Memory allocation failed\n");
+        exit(1);
+    }
+    for (int i = 0; i < height_B; i++) {
+        for (int j = 0; j < width_B; j++) {
+            packed_B[i * width_B + j] = TC_AT(matrix_B, i, j);
+        }
+    }
+
+    tc_options opts;
+    tc_options_init(&opts);
+    opts.tile_A[0] = tile_width;
+    opts.tile_A[1] = tile_height;
+
+    tc_plan *plan = require_plan(tc_plan_create_2d(op, height_A, width_A,
+                                                   packed_B, height_B, width_B, &opts));
+    tc_execute_2d(plan, matrix_A, matrix_C);
+    tc_plan_destroy(plan);
+
+    tc_matrix_to_rows(matrix_C, C);
+
+    free(packed_B);
+    tc_matrix_destroy(matrix_A);
+    tc_matrix_destroy(matrix_B);
+    tc_matrix_destroy(matrix_C);
+}
+
+/**
+ * Runs a one-shot 3D plan on a dense array, oriented for op like tiled_2d.
+ */
+static void tiled_3d(tc_op op, int *A, int size_A_x, int size_A_y, int size_A_z,
+                     int *B, int size_B_x, int size_B_y, int size_B_z,
+                     int *C,
+                     int tile_A_x, int tile_A_y, int tile_A_z,
+                     int tile_B_x, int tile_B_y, int tile_B_z) {
+    tc_options opts;
+    tc_options_init(&opts);
+    opts.tile_A[0] = tile_A_x;
+    opts.tile_A[1] = tile_A_y;
+    opts.tile_A[2] = tile_A_z;
+    opts.tile_B[0] = tile_B_x;
+    opts.tile_B[1] = tile_B_y;
+    opts.tile_B[2] = tile_B_z;
+
+    tc_plan *plan = require_plan(tc_plan_create_3d(op, size_A_x, size_A_y, size_A_z,
+                                                   B, size_B_x, size_B_y, size_B_z, &opts));
+    tc_execute(plan, A, C);
+    tc_plan_destroy(plan);
+}
+
+void tiled_cross_correlation_2d(int **A, int height_A, int width_A,
+                                int **B, int height_B, int width_B,
+                                int **C, int tile_height, int tile_width) {
+    tiled_2d(TC_CROSS_CORRELATION, A, height_A, width_A, B, height_B, width_B, C, tile_height, tile_width);
+}
+
+void tiled_convolution_2d(int **A, int height_A, int width_A,
+                          int **B, int height_B, int width_B,
+                          int **C, int tile_height, int tile_width) {
+    tiled_2d(TC_CONVOLUTION, A, height_A, width_A, B, height_B, width_B, C, tile_height, tile_width);
+}
+
+void tiled_cross_correlation_3d(int *A, int size_A_x, int size_A_y, int size_A_z,
+                                int *B, int size_B_x, int size_B_y, int size_B_z,
+                                int *C,
+                                int tile_A_x, int tile_A_y, int tile_A_z,
+                                int tile_B_x, int tile_B_y, int tile_B_z) {
+    tiled_3d(TC_CROSS_CORRELATION, A, size_A_x, size_A_y, size_A_z, B, size_B_x, size_B_y, size_B_z, C,
+             tile_A_x, tile_A_y, tile_A_z, tile_B_x, tile_B_y, tile_B_z);
+}
+
+void tiled_convolution_3d(int *A, int size_A_x, int size_A_y, int size_A_z,
+                          int *B, int size_B_x, int size_B_y, int size_B_z,
+                          int *C,
+                          int tile_A_x, int tile_A_y, int tile_A_z,
+                          int tile_B_x, int tile_B_y, int tile_B_z) {
+    tiled_3d(TC_CONVOLUTION, A, size_A_x, size_A_y, size_A_z, B, size_B_x, size_B_y, size_B_z, C,
+             tile_A_x, tile_A_y, tile_A_z, tile_B_x, tile_B_y, tile_B_z);
+}
@@ -0,0 +1,662 @@
+#include <limits.h>
+#include <stdlib.h>
+
+#include "tileconv_internal.h"
+
+/**
+ * Returns 1 if the plan's outputs go through the wide (64-bit) kernels: always
+ * for 64-bit output, and for plans whose accumulator is not 32-bit.
+ */
+static inline int use_wide(const tc_plan *plan, const long long *C64) {
+    return C64 || plan->accum != TC_ACCUM_INT32;
+}
+
+#define ELEM int
+#define ACC long long
+#define ES(name) name
+#define ELEM_W(plan) ((const int *)(plan)->W)
+#include "halo_engine.h"
+#undef ELEM
+#undef ACC
+#undef ES
+#undef ELEM_W
+
+/**
+ * Stores the 64-bit sums of n outputs step apart, clamped for 32-bit output.
+ */
+static void store_wide(const tc_plan *plan, const long long *sum, int *C, long long *C64, int n, int step) {
+    for (int j = 0; j < n; j++) {
+        if (C64) {
+            C64[(long)j * step] = sum[j];
+        } else if (plan->accum != TC_ACCUM_INT32) {
+            C[(long)j * step] = sum[j] > INT_MAX ? INT_MAX : (sum[j] < INT_MIN ? INT_MIN : (int)sum[j]);
+        } else {
+            C[(long)j * step] = (int)sum[j];
+        }
+    }
+}
+
+/**
+ * Computes outputs [x0, x1) of row (y, z) in the halo with the row kernels.
+ * Every kernel row that reads A (the remapped input row under an extended
+ * boundary) is one row kernel call per chunk of outputs; where the chunk's
+ * footprint leaves A along x, its input run is first gathered into a stack
+ * buffer of chunk + size_B[0] - 1 samples, so the kernel must be narrower
+ * than TC_HALO_CHUNK / 2.
+ */
+static void halo_span(const tc_plan *plan, const int *A, long row_A, long slice_A,
+                      int *C, long long *C64, long row_C, long slice_C, int x0, int x1, int y, int z) {
+    int size_B_x = plan->size_B[0], size_B_y = plan->size_B[1], size_B_z = plan->size_B[2];
+    int wide = use_wide(plan, C64);
+    long row = z * slice_C + y * row_C;
+    int ext[TC_HALO_CHUNK];
+    long long sum[TC_HALO_CHUNK / 2], part[TC_HALO_CHUNK / 2];
+    int chunk = TC_HALO_CHUNK / 2;
+
+    for (int j0 = x0; j0 < x1; j0 += chunk) {
+        int m = x1 - j0 < chunk ? x1 - j0 : chunk;
+        int first = 1;
+        for (int kz = 0; kz < size_B_z; kz++) {
+            for (int ky = 0; ky < size_B_y; ky++) {
+                const int *a = halo_row(plan, A, row_A, slice_A, y, z, ky, kz);
+                if (!a) continue;
+                a = halo_samples(plan, a, j0 - plan->pad[0], m + size_B_x - 1, ext);
+                const int *w = plan->W + ((long)kz * size_B_y + ky) * size_B_x;
+                if (wide) {
+                    tc_wide_correlate(first ? sum : part, NULL, a, 0, 0, w, size_B_x, 1, 1, m);
+                    if (!first) {
+                        for (int j = 0; j < m; j++) sum[j] += part[j];
+                    }
+                } else {
+                    tc_row_correlate(C + row + j0, a, w, size_B_x, m, first);
+                }
+                first = 0;
+            }
+        }
+        if (wide) {
+            if (first) {
+                for (int j = 0; j < m; j++) sum[j] = 0;
+            }
+            store_wide(plan, sum, C64 ? NULL : C + row + j0, C64 ? C64 + row + j0 : NULL, m, 1);
+        } else if (first) {
+            for (int j = 0; j < m; j++) C[row + j0 + j] = 0;
+        }
+    }
+}
+
+/**
+ * Computes outputs [x0, x1) of row (y, z), all of whose footprints cross the
+ * input boundary: the outputs tc_halo_split picks through halo_span, the rest
+ * (the halo along x of kernels of TC_HALO_CHUNK / 2 taps or more) one clamped
+ * point at a time. Points are summed in 64 bits; 32-bit plans keep the low 32
+ * bits, as their wrapping row kernels would. Strides are as for tc_direct_3d
+ * (1D and 2D plans pass 0 for the ones they do not have).
+ */
+static void boundary_row(const tc_plan *plan, const int *A, long row_A, long slice_A,
+                         int *C, long long *C64, long row_C, long slice_C, int x0, int x1, int y, int z) {
+    if (x0 >= x1) return;
+    int sx0, sx1;
+    if (tc_halo_split(plan, x0, x1, &sx0, &sx1)) {
+        halo_span(plan, A, row_A, slice_A, C, C64, row_C, slice_C, sx0, sx1, y, z);
+        boundary_row(plan, A, row_A, slice_A, C, C64, row_C, slice_C, x0, sx0, y, z);
+        boundary_row(plan, A, row_A, slice_A, C, C64, row_C, slice_C, sx1, x1, y, z);
+        return;
+    }
+
+    long row = z * slice_C + y * row_C;
+    for (int x = x0; x < x1; x++) {
+        long long sum = boundary_point(plan, A, row_A, slice_A, x, y, z);
+        store_wide(plan, &sum, C64 ? NULL : C + row + x, C64 ? C64 + row + x : NULL, 1, 1);
+    }
+}
+
+/**
+ * Phase path of strided and dilated plans: computes the outputs [x0, x1) x
+ * [y0, y1) x [z0, z1), halo included. For a chunk of up to TC_HALO_CHUNK
+ * outputs of up to TC_PHASE_ROWS rows, phase_fill splits the span of every
+ * input row the chunk reads once into the step phases of tc_phase_split,
+ * with the boundary extension already applied. The taps of one input phase
+ * then read a contiguous run of one phase for consecutive outputs of one
+ * output phase, so each output row makes one row kernel call per output
+ * phase, kernel row and input phase, and only the needed outputs are
+ * computed with the row kernels vectorized whatever the stride. The output
+ * phases are interleaved into C at the end of the row. Kernel rows and slices
+ * select their input row directly.
+ */
+static void phase_box(const tc_plan *plan, const int *A, long row_A, long slice_A,
+                      int *C, long long *C64, long row_C, long slice_C,
+                      int x0, int x1, int y0, int y1, int z0, int z1) {
+    int size_B_x = plan->size_B[0], size_B_y = plan->size_B[1], size_B_z = plan->size_B[2];
+    int wide = use_wide(plan, C64);
+    tc_phase_layout layout;
+    tc_phase_layout_init(plan, x1 - x0, y1 - y0, &layout);
+    int in_phases = layout.in_phases, out_phases = layout.out_phases, m_max = layout.m_max;
+
+    int *G = (int *)malloc((size_t)tc_phase_scratch(&layout) * sizeof(int));
+    const int **row_G = (const int **)malloc(layout.rows * sizeof(int *));
+    long long *sum = (long long *)malloc(2 * (size_t)m_max * sizeof(long long));
+    if (!G || !row_G || !sum) {
+        free(G);
+        free(row_G);
+        free(sum);
+        for (int z = z0; z < z1; z++) {
+            for (int y = y0; y < y1; y++) {
+                for (int x = x0; x < x1; x++) {
+                    long long v = phase_point(plan, A, row_A, slice_A, x, y, z);
+                    long offset = z * slice_C + y * row_C + x;
+                    store_wide(plan, &v, C64 ? NULL : C + offset, C64 ? C64 + offset : NULL, 1, 1);
+                }
+            }
+        }
+        return;
+    }
+    int *ext = G + layout.rows * layout.step * layout.len;
+    int *T = ext + layout.span;
+    long long *part = sum + m_max;
+
+    for (int z = z0; z < z1; z++) {
+        for (int yc = y0; yc < y1; yc += TC_PHASE_ROWS) {
+            int yc1 = yc + TC_PHASE_ROWS < y1 ? yc + TC_PHASE_ROWS : y1;
+            int ny = tc_phase_rows(plan, yc1 - yc);
+
+            for (int c0 = x0; c0 < x1; c0 += layout.chunk) {
+                int n = x1 - c0 < layout.chunk ? x1 - c0 : layout.chunk;
+                phase_fill(plan, &layout, A, row_A, slice_A, c0, n, yc, ny, z, G, row_G, ext);
+
+                for (int y = yc; y < yc1; y++) {
+                    long row = z * slice_C + y * row_C + c0;
+                    for (int p = 0; p < out_phases && p < n; p++) {
+                        int m = (n - p + out_phases - 1) / out_phases;
+                        // 32-bit sums of a single output phase go straight to C
+                        int *dst = out_phases == 1 ? C + row : T + (long)p * m_max;
+                        int first = 1;
+                        for (int kz = 0; kz < size_B_z; kz++) {
+                            for (int ky = 0; ky < size_B_y; ky++) {
+                                const int *g = row_G[tc_phase_fill_row(plan, ny, y - yc, ky, kz)];
+                                if (!g) continue;
+                                const int *w = (const int *)plan->W_phase + ((long)kz * size_B_y + ky) * size_B_x;
+                                for (int r = 0; r < in_phases && r < size_B_x; r++) {
+                                    int taps = tc_phase_taps(plan, &layout, r);
+                                    const int *run = g + tc_phase_run(plan, &layout, p, r);
+                                    if (wide) {
+                                        tc_wide_correlate(first ? sum : part, NULL, run, 0, 0, w, taps, 1, 1, m);
+                                        if (!first) {
+                                            for (int j = 0; j < m; j++) sum[j] += part[j];
+                                        }
+                                    } else {
+                                        tc_row_correlate(dst, run, w, taps, m, first);
+                                    }
+                                    first = 0;
+                                    w += taps;
+                                }
+                            }
+                        }
+
+                        if (wide) {
+                            if (first) {
+                                for (int j = 0; j < m; j++) sum[j] = 0;
+                            }
+                            store_wide(plan, sum, C64 ? NULL : C + row + p, C64 ? C64 + row + p : NULL, m, out_phases);
+                        } else if (first) {
+                            for (int j = 0; j < m; j++) dst[j] = 0;
+                        }
+                    }
+                    if (out_phases > 1 && !wide) phase_merge(T, m_max, out_phases, n, C + row);
+                }
+            }
+        }
+    }
+    free(G);
+    free(row_G);
+    free(sum);
+}
+
+/**
+ * Tiled 1D engine with two-level blocking. The output is split into blocks of
+ * tile_A elements; each block stays cache-resident while every kernel tile of
+ * tile_B taps is applied to it, so C is written back once per block instead of
+ * once per kernel tile. The last kernel tile is simply shorter, so there is no
+ * separate remainder pass, and the first kernel tile stores instead of
+ * accumulating, which removes the zeroing pass.
+ *
+ * The wide kernel keeps each 64-bit sum in registers over all taps, so wide
+ * plans do not split the kernel into tiles.
+ */
+void tc_direct_1d(const tc_plan *plan, const int *A, int *C, long long *C64, int size_C) {
+    int size_B = plan->size_B[0];
+    int tile_A = plan->tile_A[0];
+    int tile_B = plan->tile_B[0];
+    const int *W = plan->W;
+    int wide = use_wide(plan, C64);
+
+    for (int j_start = 0; j_start < size_C; j_start += tile_A) {
+        int j_end = (j_start + tile_A < size_C) ? j_start + tile_A : size_C;
+
+        if (wide) {
+            tc_wide_correlate(C64 ? C64 + j_start : NULL, C64 ? NULL : C + j_start, A + j_start,
+                              0, 0, W, size_B, 1, 1, j_end - j_start);
+            continue;
+        }
+
+        for (int k_start = 0; k_start < size_B; k_start += tile_B) {
+            int k_end = (k_start + tile_B < size_B) ? k_start + tile_B : size_B;
+
+            tc_row_correlate(C + j_start, A + j_start + k_start, W + k_start,
+                             k_end - k_start, j_end - j_start, k_start == 0);
+        }
+    }
+}
+
+void tc_direct_range_1d(const tc_plan *plan, const int *A, int *C, long long *C64, int x0, int x1) {
+    if (plan->strided) {
+        phase_box(plan, A, 0, 0, C, C64, 0, 0, x0, x1, 0, 1, 0, 1);
+        return;
+    }
+    int lo[3], hi[3];
+    tc_interior_range(plan, lo, hi);
+    int ix0 = x0 > lo[0] ? x0 : lo[0], ix1 = x1 < hi[0] ? x1 : hi[0];
+    if (ix0 >= ix1) {
+        boundary_row(plan, A, 0, 0, C, C64, 0, 0, x0, x1, 0, 0);
+        return;
+    }
+    boundary_row(plan, A, 0, 0, C, C64, 0, 0, x0, ix0, 0, 0);
+    tc_direct_1d(plan, A + (ix0 - plan->pad[0]), C64 ? NULL : C + ix0, C64 ? C64 + ix0 : NULL, ix1 - ix0);
+    boundary_row(plan, A, 0, 0, C, C64, 0, 0, ix1, x1, 0, 0);
+}
+
+/**
+ * Separable path of a 2D tile: the x factor is applied to every input row the
+ * tile needs, into a scratch block, and the y factor then sweeps down the
+ * cache-resident scratch rows with the column kernel, so no pass walks the
+ * input with a row stride.
+ *
+ * @return 0, or -1 if the scratch block could not be allocated (the caller
+ *         then takes the full-footprint path)
+ */
+static int separable_tile_2d(const tc_plan *plan, const int *A, long pitch_A, int *C, long pitch_C,
+                             int i_tile, int j_tile, int height, int width) {
+    int width_B = plan->size_B[0], height_B = plan->size_B[1];
+    int rows = height + height_B - 1;
+    int *T = (int *)malloc((size_t)rows * width * sizeof(int));
+    if (!T) return -1;
+
+    for (int r = 0; r < rows; r++) {
+        tc_row_correlate(T + (long)r * width, A + (i_tile + r) * pitch_A + j_tile,
+                         plan->W_axis[0], width_B, width, 1);
+    }
+    for (int i = 0; i < height; i++) {
+        tc_column_correlate(C + (i_tile + i) * pitch_C + j_tile, T + (long)i * width, width,
+                            plan->W_axis[1], height_B, width);
+    }
+    free(T);
+    return 0;
+}
+
+/**
+ * Full-footprint path of output rows [i0, i1), columns [j0, j0 + width): each
+ * output row accumulates one kernel row per row kernel call.
+ */
+static void direct_rows_2d(const tc_plan *plan, const int *A, long pitch_A, int *C, long pitch_C,
+                           int i0, int i1, int j0, int width) {
+    int width_B = plan->size_B[0], height_B = plan->size_B[1];
+    for (int i_global = i0; i_global < i1; i_global++) {
+        int *c_row = C + i_global * pitch_C + j0;
+        const int *a_row = A + i_global * pitch_A + j0;
+
+        for (int ki = 0; ki < height_B; ki++) {
+            tc_row_correlate(c_row, a_row, plan->W + ki * width_B, width_B, width, ki == 0);
+            a_row += pitch_A;
+        }
+    }
+}
+
+/**
+ * Computes the curr_tile_height x curr_tile_width output tile at (i_tile,
+ * j_tile) on the plan's engine. The tile is addressed as if the output were
+ * 'valid': C is shifted by pad so that output (i, j) reads its footprint
+ * from input row i and column j on, all of which must be inside A. Every
+ * kernel row is applied to the whole tile while it is cache-resident.
+ */
+static void interior_tile_2d(const tc_plan *plan, const int *A, long pitch_A, int *C, long long *C64,
+                             long pitch_C, int i_tile, int j_tile, int curr_tile_height, int curr_tile_width) {
+    int width_B = plan->size_B[0], height_B = plan->size_B[1];
+    const int *W = plan->W;
+
+    if (use_wide(plan, C64)) {
+        // One wide call covers all kernel rows of an output row
+        for (int i_global = i_tile; i_global < i_tile + curr_tile_height; i_global++) {
+            long offset = i_global * pitch_C + j_tile;
+            tc_wide_correlate(C64 ? C64 + offset : NULL, C64 ? NULL : C + offset,
+                              A + i_global * pitch_A + j_tile, pitch_A, 0,
+                              W, width_B, height_B, 1, curr_tile_width);
+        }
+        return;
+    }
+
+    if (plan->engine == TC_ENGINE_SEPARABLE &&
+        separable_tile_2d(plan, A, pitch_A, C, pitch_C, i_tile, j_tile, curr_tile_height, curr_tile_width) == 0) {
+        return;
+    }
+
+    if (plan->engine == TC_ENGINE_WINOGRAD &&
+        tc_winograd_tile_2d(plan, A, pitch_A, C, pitch_C, i_tile, j_tile, curr_tile_height, curr_tile_width) == 0) {
+        // Rows and columns past the last whole Winograd tile take the full footprint
+        int m = plan->winograd_m;
+        int rows = curr_tile_height - curr_tile_height % m, cols = curr_tile_width - curr_tile_width % m;
+        direct_rows_2d(plan, A, pitch_A, C, pitch_C, i_tile, i_tile + rows, j_tile + cols, curr_tile_width - cols);
+        direct_rows_2d(plan, A, pitch_A, C, pitch_C, i_tile + rows, i_tile + curr_tile_height, j_tile,
+                       curr_tile_width);
+        return;
+    }
+
+    if (plan->engine == TC_ENGINE_GEMM) {
+        tc_gemm_tile_2d(plan, A, pitch_A, C, pitch_C, i_tile, j_tile, curr_tile_height, curr_tile_width);
+        return;
+    }
+
+    direct_rows_2d(plan, A, pitch_A, C, pitch_C, i_tile, i_tile + curr_tile_height, j_tile, curr_tile_width);
+}
+
+/**
+ * Computes one tile_A[1] x tile_A[0] output tile of a 2D plan: the part whose
+ * footprint lies inside the input on the plan's engine, and the rows and
+ * columns of the halo around it through boundary_row. Strided and dilated
+ * plans take the phase path.
+ */
+static void direct_tile_2d(const tc_plan *plan, const int *A, long pitch_A,
+                           int *C, long long *C64, long pitch_C, int i_tile, int j_tile) {
+    int x1 = (j_tile + plan->tile_A[0] < plan->size_C[0]) ? j_tile + plan->tile_A[0] : plan->size_C[0];
+    int y1 = (i_tile + plan->tile_A[1] < plan->size_C[1]) ? i_tile + plan->tile_A[1] : plan->size_C[1];
+    if (plan->strided) {
+        phase_box(plan, A, pitch_A, 0, C, C64, pitch_C, 0, j_tile, x1, i_tile, y1, 0, 1);
+        return;
+    }
+    int lo[3], hi[3];
+    tc_interior_range(plan, lo, hi);
+    int ix0 = j_tile > lo[0] ? j_tile : lo[0], ix1 = x1 < hi[0] ? x1 : hi[0];
+    int iy0 = i_tile > lo[1] ? i_tile : lo[1], iy1 = y1 < hi[1] ? y1 : hi[1];
+    int has_interior = (iy0 < iy1 && ix0 < ix1);
+
+    if (has_interior) {
+        long shift = plan->pad[1] * pitch_C + plan->pad[0];
+        interior_tile_2d(plan, A, pitch_A, C64 ? NULL : C + shift, C64 ? C64 + shift : NULL, pitch_C,
+                         iy0 - plan->pad[1], ix0 - plan->pad[0], iy1 - iy0, ix1 - ix0);
+    }
+    for (int y = i_tile; y < y1; y++) {
+        if (has_interior && y >= iy0 && y < iy1) {
+            boundary_row(plan, A, pitch_A, 0, C, C64, pitch_C, 0, j_tile, ix0, y, 0);
+            boundary_row(plan, A, pitch_A, 0, C, C64, pitch_C, 0, ix1, x1, y, 0);
+        } else {
+            boundary_row(plan, A, pitch_A, 0, C, C64, pitch_C, 0, j_tile, x1, y, 0);
+        }
+    }
+}
+
+typedef struct {
+    const tc_plan *plan;
+    const int *A;
+    long pitch_A;
+    int *C;
+    long long *C64;
+    long pitch_C;
+    int tiles_x;
+} direct_2d_job;
+
+static void direct_tile_2d_task(void *ctx, int index) {
+    const direct_2d_job *job = (const direct_2d_job *)ctx;
+    int i_tile = index / job->tiles_x * job->plan->tile_A[1];
+    int j_tile = index % job->tiles_x * job->plan->tile_A[0];
+    direct_tile_2d(job->plan, job->A, job->pitch_A, job->C, job->C64, job->pitch_C, i_tile, j_tile);
+}
+
+/**
+ * Tiled 2D engine on pitched rows. Output tiles are independent, so a plan
+ * with a pool submits each tile as one task.
+ */
+void tc_direct_2d(const tc_plan *plan, const int *A, long pitch_A, int *C, long long *C64, long pitch_C) {
+    int width_C = plan->size_C[0], height_C = plan->size_C[1];
+    int tile_width = plan->tile_A[0], tile_height = plan->tile_A[1];
+
+    if (plan->pool) {
+        int tiles_x = (width_C + tile_width - 1) / tile_width;
+        int tiles_y = (height_C + tile_height - 1) / tile_height;
+        direct_2d_job job = {plan, A, pitch_A, C, C64, pitch_C, tiles_x};
+        tc_pool_run(plan->pool, tiles_x * tiles_y, direct_tile_2d_task, &job);
+        return;
+    }
+
+    for (int i_tile = 0; i_tile < height_C; i_tile += tile_height) {
+        for (int j_tile = 0; j_tile < width_C; j_tile += tile_width) {
+            direct_tile_2d(plan, A, pitch_A, C, C64, pitch_C, i_tile, j_tile);
+        }
+    }
+}
+
+/**
+ * Separable path of an interior 3D box, with A_box and C_box at its origin.
+ * Three 1D passes go through two scratch volumes: x along the input rows,
+ * then y and z with the column kernel, which walks the strided axes as
+ * unit-stride sweeps over whole scratch rows. The scratch covers one box
+ * and stays cache-resident between the passes.
+ *
+ * @return 0, or -1 if the scratch could not be allocated
+ */
+static int separable_box_3d(const tc_plan *plan, const int *A_box, long row_A, long slice_A,
+                            int *C_box, long row_C, long slice_C, int n, int ny, int nz) {
+    int size_B_x = plan->size_B[0], size_B_y = plan->size_B[1], size_B_z = plan->size_B[2];
+    int rows = ny + size_B_y - 1, planes = nz + size_B_z - 1;
+    long rows_T1 = (long)planes * rows, rows_T2 = (long)planes * ny;
+    int *T1 = (int *)malloc((size_t)(rows_T1 + rows_T2) * n * sizeof(int));
+    if (!T1) return -1;
+    int *T2 = T1 + rows_T1 * n;
+
+    for (int p = 0; p < planes; p++) {
+        for (int r = 0; r < rows; r++) {
+            tc_row_correlate(T1 + ((long)p * rows + r) * n, A_box + p * slice_A + r * row_A,
+                             plan->W_axis[0], size_B_x, n, 1);
+        }
+    }
+    for (int p = 0; p < planes; p++) {
+        for (int y = 0; y < ny; y++) {
+            tc_column_correlate(T2 + ((long)p * ny + y) * n, T1 + ((long)p * rows + y) * n, n,
+                                plan->W_axis[1], size_B_y, n);
+        }
+    }
+    for (int z = 0; z < nz; z++) {
+        for (int y = 0; y < ny; y++) {
+            tc_column_correlate(C_box + z * slice_C + y * row_C, T2 + ((long)z * ny + y) * n, (long)ny * n,
+                                plan->W_axis[2], size_B_z, n);
+        }
+    }
+    free(T1);
+    return 0;
+}
+
+/**
+ * Computes the output box [x0, x1) x [y0, y1) x [z0, z1), all of whose taps
+ * are in bounds. The box stays cache-resident while every kernel tile is
+ * applied to it; all addressing is done with pointers that are advanced by
+ * the row and slice strides instead of recomputing flattened indices.
+ */
+static void interior_box_3d(const tc_plan *plan, const int *A, long row_A, long slice_A,
+                            int *C, long long *C64, long row_C, long slice_C,
+                            int x0, int x1, int y0, int y1, int z0, int z1) {
+    int size_B_x = plan->size_B[0], size_B_y = plan->size_B[1], size_B_z = plan->size_B[2];
+    int tile_B_x = plan->tile_B[0], tile_B_y = plan->tile_B[1], tile_B_z = plan->tile_B[2];
+    long slice_B = (long)size_B_y * size_B_x;
+    int n = x1 - x0;
+
+    // Input position of the box origin
+    const int *A_box = A + (z0 - plan->pad[2]) * slice_A + (y0 - plan->pad[1]) * row_A + (x0 - plan->pad[0]);
+
+    if (use_wide(plan, C64)) {
+        // One wide call covers the whole kernel footprint of an output row
+        for (int z = z0; z < z1; z++) {
+            for (int y = y0; y < y1; y++) {
+                long offset = z * slice_C + y * row_C + x0;
+                tc_wide_correlate(C64 ? C64 + offset : NULL, C64 ? NULL : C + offset,
+                                  A_box + (z - z0) * slice_A + (y - y0) * row_A, row_A, slice_A,
+                                  plan->W, size_B_x, size_B_y, size_B_z, n);
+            }
+        }
+        return;
+    }
+
+    int *C_box = C + z0 * slice_C + y0 * row_C + x0;
+
+    if (plan->engine == TC_ENGINE_SEPARABLE &&
+        separable_box_3d(plan, A_box, row_A, slice_A, C_box, row_C, slice_C, n, y1 - y0, z1 - z0) == 0) {
+        return;
+    }
+
+    for (int kz_start = 0; kz_start < size_B_z; kz_start += tile_B_z) {
+        int kz_end = (kz_start + tile_B_z < size_B_z) ? kz_start + tile_B_z : size_B_z;
+        for (int ky_start = 0; ky_start < size_B_y; ky_start += tile_B_y) {
+            int ky_end = (ky_start + tile_B_y < size_B_y) ? ky_start + tile_B_y : size_B_y;
+            for (int kx_start = 0; kx_start < size_B_x; kx_start += tile_B_x) {
+                int taps = ((kx_start + tile_B_x < size_B_x) ? kx_start + tile_B_x : size_B_x) - kx_start;
+                int first_tile = (kz_start == 0 && ky_start == 0 && kx_start == 0);
+                const int *W_tile = plan->W + kz_start * slice_B + (long)ky_start * size_B_x + kx_start;
+                const int *A_tile = A_box + kz_start * slice_A + ky_start * row_A + kx_start;
+
+                int *c_plane = C_box;
+                const int *a_plane = A_tile;
+                for (int z = z0; z < z1; z++) {
+                    int *c_row = c_plane;
+                    const int *a_row = a_plane;
+                    for (int y = y0; y < y1; y++) {
+                        int first = first_tile;
+                        const int *a_kz = a_row;
+                        const int *w_kz = W_tile;
+                        for (int kz = kz_start; kz < kz_end; kz++) {
+                            const int *a_ky = a_kz;
+                            const int *w_ky = w_kz;
+                            for (int ky = ky_start; ky < ky_end; ky++) {
+                                tc_row_correlate(c_row, a_ky, w_ky, taps, n, first);
+                                first = 0;
+                                a_ky += row_A;
+                                w_ky += size_B_x;
+                            }
+                            a_kz += slice_A;
+                            w_kz += slice_B;
+                        }
+                        c_row += row_C;
+                        a_row += row_A;
+                    }
+                    c_plane += slice_C;
+                    a_plane += slice_A;
+                }
+            }
+        }
+    }
+}
+
+typedef struct {
+    const tc_plan *plan;
+    const int *A;
+    long row_A, slice_A;
+    int *C;
+    long long *C64;
+    long row_C, slice_C;
+    int lo[3], hi[3];   // Interior output range per axis
+    int blocks_x, blocks_y;
+} direct_3d_job;
+
+/**
+ * Computes the output block at x0, y0, z0. The interior (outputs whose whole
+ * kernel footprint lies inside the input) runs the check-free kernel-tiled
+ * path; the thin boundary shell around it runs a clamped path.
+ */
+static void direct_block_3d(const direct_3d_job *job, int x0, int y0, int z0) {
+    const tc_plan *plan = job->plan;
+    const int *lo = job->lo, *hi = job->hi;
+    int x1 = (x0 + plan->tile_A[0] < plan->size_C[0]) ? x0 + plan->tile_A[0] : plan->size_C[0];
+    int y1 = (y0 + plan->tile_A[1] < plan->size_C[1]) ? y0 + plan->tile_A[1] : plan->size_C[1];
+    int z1 = (z0 + plan->tile_A[2] < plan->size_C[2]) ? z0 + plan->tile_A[2] : plan->size_C[2];
+    if (plan->strided) {
+        phase_box(plan, job->A, job->row_A, job->slice_A, job->C, job->C64, job->row_C, job->slice_C,
+                  x0, x1, y0, y1, z0, z1);
+        return;
+    }
+    int ix0 = x0 > lo[0] ? x0 : lo[0], ix1 = x1 < hi[0] ? x1 : hi[0];
+    int iy0 = y0 > lo[1] ? y0 : lo[1], iy1 = y1 < hi[1] ? y1 : hi[1];
+    int iz0 = z0 > lo[2] ? z0 : lo[2], iz1 = z1 < hi[2] ? z1 : hi[2];
+    int has_interior = (iz0 < iz1 && iy0 < iy1 && ix0 < ix1);
+
+    if (has_interior) {
+        interior_box_3d(plan, job->A, job->row_A, job->slice_A, job->C, job->C64, job->row_C, job->slice_C,
+                        ix0, ix1, iy0, iy1, iz0, iz1);
+        if (ix0 == x0 && ix1 == x1 && iy0 == y0 && iy1 == y1 && iz0 == z0 && iz1 == z1) {
+            return;
+        }
+    }
+
+    // Boundary shell of the block
+    for (int z = z0; z < z1; z++) {
+        for (int y = y0; y < y1; y++) {
+            if (has_interior && z >= iz0 && z < iz1 && y >= iy0 && y < iy1) {
+                boundary_row(plan, job->A, job->row_A, job->slice_A, job->C, job->C64, job->row_C, job->slice_C,
+                             x0, ix0, y, z);
+                boundary_row(plan, job->A, job->row_A, job->slice_A, job->C, job->C64, job->row_C, job->slice_C,
+                             ix1, x1, y, z);
+            } else {
+                boundary_row(plan, job->A, job->row_A, job->slice_A, job->C, job->C64, job->row_C, job->slice_C,
+                             x0, x1, y, z);
+            }
+        }
+    }
+}
+
+static void direct_block_3d_task(void *ctx, int index) {
+    const direct_3d_job *job = (const direct_3d_job *)ctx;
+    int bx = index % job->blocks_x;
+    int by = index / job->blocks_x % job->blocks_y;
+    int bz = index / job->blocks_x / job->blocks_y;
+    direct_block_3d(job, bx * job->plan->tile_A[0], by * job->plan->tile_A[1], bz * job->plan->tile_A[2]);
+}
+
+/**
+ * Tiled 3D engine on strided volumes. The output is processed in
+ * tile_A_x x tile_A_y x tile_A_z blocks, which are the tasks submitted to the
+ * plan's pool when it has one. With 'valid' output (pad = 0) every output is
+ * interior; 'same' and 'full' outputs add a halo of boundary points, and the
+ * input is never copied into a padded volume.
+ */
+void tc_direct_3d(const tc_plan *plan, const int *A, long row_A, long slice_A,
+                  int *C, long long *C64, long row_C, long slice_C) {
+    direct_3d_job job = {plan, A, row_A, slice_A, C, C64, row_C, slice_C};
+    tc_interior_range(plan, job.lo, job.hi);
+
+    int tile_A_x = plan->tile_A[0], tile_A_y = plan->tile_A[1], tile_A_z = plan->tile_A[2];
+    int size_C_x = plan->size_C[0], size_C_y = plan->size_C[1], size_C_z = plan->size_C[2];
+
+    if (plan->pool) {
+        job.blocks_x = (size_C_x + tile_A_x - 1) / tile_A_x;
+        job.blocks_y = (size_C_y + tile_A_y - 1) / tile_A_y;
+        int blocks_z = (size_C_z + tile_A_z - 1) / tile_A_z;
+        tc_pool_run(plan->pool, job.blocks_x * job.blocks_y * blocks_z, direct_block_3d_task, &job);
+        return;
+    }
+
+    for (int z0 = 0; z0 < size_C_z; z0 += tile_A_z) {
+        for (int y0 = 0; y0 < size_C_y; y0 += tile_A_y) {
+            for (int x0 = 0; x0 < size_C_x; x0 += tile_A_x) {
+                direct_block_3d(&job, x0, y0, z0);
+            }
+        }
+    }
+}
+
+void tc_direct_block(const tc_plan *plan, const int *A, long row_A, long slice_A,
+                     int *C, long row_C, long slice_C, int x0, int y0, int z0) {
+    if (plan->dims == 1) {
+        int x1 = (x0 + plan->tile_A[0] < plan->size_C[0]) ? x0 + plan->tile_A[0] : plan->size_C[0];
+        tc_direct_range_1d(plan, A, C, NULL, x0, x1);
+    } else if (plan->dims == 2) {
+        direct_tile_2d(plan, A, row_A, C, NULL, row_C, y0, x0);
+    } else {
+        direct_3d_job job = {plan, A, row_A, slice_A, C, NULL, row_C, slice_C};
+        tc_interior_range(plan, job.lo, job.hi);
+        direct_block_3d(&job, x0, y0, z0);
+    }
+}
@@ -0,0 +1,186 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "tileconv_internal.h"
+
+/**
+ * In-place iterative radix-2 complex FFT of fft->half points on interleaved
+ * (re, im) data. sign is -1 for the forward and +1 for the inverse transform;
+ * the inverse is not normalized.
+ */
+static void complex_fft(const tc_fft *fft, double *z, int sign) {
+    int n = fft->half;
+
+    for (int i = 0; i < n; i++) {
+        int j = fft->bitrev[i];
+        if (j > i) {
+            double re = z[2 * i], im = z[2 * i + 1];
+            z[2 * i] = z[2 * j];
+            z[2 * i + 1] = z[2 * j + 1];
+            z[2 * j] = re;
+            z[2 * j + 1] = im;
+        }
+    }
+
+    for (int len = 2; len <= n; len <<= 1) {
+        int half_len = len >> 1;
+        int step = n / len;
+        for (int start = 0; start < n; start += len) {
+            for (int k = 0; k < half_len; k++) {
+                // Twiddle e^{sign * 2 pi i k / len}; the table holds the forward (sign = -1) roots
+                double w_re = fft->twiddle[2 * k * step];
+                double w_im = -sign * fft->twiddle[2 * k * step + 1];
+                double *u = z + 2 * (start + k);
+                double *v = z + 2 * (start + k + half_len);
+                double t_re = v[0] * w_re - v[1] * w_im;
+                double t_im = v[0] * w_im + v[1] * w_re;
+                v[0] = u[0] - t_re;
+                v[1] = u[1] - t_im;
+                u[0] += t_re;
+                u[1] += t_im;
+            }
+        }
+    }
+}
+
+tc_fft *tc_fft_create(int n) {
+    if (n < 4 || (n & (n - 1)) != 0) return NULL;
+
+    tc_fft *fft = (tc_fft *)calloc(1, sizeof(tc_fft));
+    if (!fft) return NULL;
+
+    fft->n = n;
+    fft->half = n / 2;
+    fft->bitrev = (int *)malloc(fft->half * sizeof(int));
+    fft->twiddle = (double *)malloc(fft->half * sizeof(double));
+    fft->post = (double *)malloc(n * sizeof(double));
+    if (!fft->bitrev || !fft->twiddle || !fft->post) {
+        tc_fft_destroy(fft);
+        return NULL;
+    }
+
+    int bits = 0;
+    while ((1 << bits) < fft->half) bits++;
+    for (int i = 0; i < fft->half; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        }
+        fft->bitrev[i] = r;
+    }
+
+    // Roots of unity for the half-size complex transform: e^{-2 pi i k / half}
+    for (int k = 0; k < fft->half / 2; k++) {
+        double angle = -2.0 * M_PI * k / fft->half;
+        fft->twiddle[2 * k] = cos(angle);
+        fft->twiddle[2 * k + 1] = sin(angle);
+    }
+
+    // Roots for splitting the packed result into the real spectrum: e^{-2 pi i k / n}
+    for (int k = 0; k < fft->half; k++) {
+        double angle = -2.0 * M_PI * k / n;
+        fft->post[2 * k] = cos(angle);
+        fft->post[2 * k + 1] = sin(angle);
+    }
+
+    return fft;
+}
+
+void tc_fft_destroy(tc_fft *fft) {
+    if (!fft) return;
+    free(fft->bitrev);
+    free(fft->twiddle);
+    free(fft->post);
+    free(fft);
+}
+
+/**
+ * Real forward FFT. x holds n real samples; X receives bins 0..n/2 as
+ * interleaved complex values (n + 2 doubles). x and X may be the same buffer.
+ *
+ * The n real samples are treated as n/2 complex samples z[m] = x[2m] + i x[2m+1];
+ * after one half-size complex FFT, the even/odd spectra E and O are recovered from
+ * Z[k] and Z[n/2 - k], and X[k] = E[k] + e^{-2 pi i k / n} O[k].
+ */
+void tc_fft_forward(const tc_fft *fft, const double *x, double *X) {
+    int half = fft->half;
+    if (X != x) {
+        for (int i = 0; i < fft->n; i++) X[i] = x[i];
+    }
+    complex_fft(fft, X, -1);
+
+    // Bins 0 and n/2 only depend on Z[0]
+    double z0_re = X[0], z0_im = X[1];
+    X[0] = z0_re + z0_im;
+    X[1] = 0.0;
+    X[2 * half] = z0_re - z0_im;
+    X[2 * half + 1] = 0.0;
+
+    for (int k = 1; k <= half / 2; k++) {
+        int m = half - k;
+        double a_re = X[2 * k], a_im = X[2 * k + 1];   // Z[k]
+        double b_re = X[2 * m], b_im = X[2 * m + 1];   // Z[half - k]
+
+        // E[k] = (Z[k] + conj(Z[m])) / 2, O[k] = (Z[k] - conj(Z[m])) / 2i
+        double e_re = 0.5 * (a_re + b_re), e_im = 0.5 * (a_im - b_im);
+        double o_re = 0.5 * (a_im + b_im), o_im = -0.5 * (a_re - b_re);
+        double w_re = fft->post[2 * k], w_im = fft->post[2 * k + 1];
+        double t_re = w_re * o_re - w_im * o_im;
+        double t_im = w_re * o_im + w_im * o_re;
+        X[2 * k] = e_re + t_re;
+        X[2 * k + 1] = e_im + t_im;
+
+        if (m != k) {
+            // E[m] = conj(E[k]), O[m] = conj(O[k]) for real input
+            double wm_re = fft->post[2 * m], wm_im = fft->post[2 * m + 1];
+            double u_re = wm_re * o_re + wm_im * o_im;
+            double u_im = wm_im * o_re - wm_re * o_im;
+            X[2 * m] = e_re + u_re;
+            X[2 * m + 1] = -e_im + u_im;
+        }
+    }
+}
+
+/**
+ * Real inverse FFT, the exact inverse of tc_fft_forward (normalized by 1/n).
+ * X holds bins 0..n/2 (n + 2 doubles) and is overwritten; the n real samples
+ * are written to the first n doubles of X.
+ */
+void tc_fft_inverse(const tc_fft *fft, double *X) {
+    int half = fft->half;
+
+    // Z[0] from bins 0 and n/2
+    double x0 = X[0], xh = X[2 * half];
+    X[0] = 0.5 * (x0 + xh);
+    X[1] = 0.5 * (x0 - xh);
+
+    for (int k = 1; k <= half / 2; k++) {
+        int m = half - k;
+        double a_re = X[2 * k], a_im = X[2 * k + 1];   // X[k]
+        double b_re = X[2 * m], b_im = X[2 * m + 1];   // X[half - k]
+
+        // E[k] = (X[k] + conj(X[m])) / 2, O[k] = (X[k] - conj(X[m])) / 2 * e^{+2 pi i k / n}
+        double e_re = 0.5 * (a_re + b_re), e_im = 0.5 * (a_im - b_im);
+        double d_re = 0.5 * (a_re - b_re), d_im = 0.5 * (a_im + b_im);
+        double w_re = fft->post[2 * k], w_im = -fft->post[2 * k + 1];
+        double o_re = d_re * w_re - d_im * w_im;
+        double o_im = d_re * w_im + d_im * w_re;
+
+        // Z[k] = E[k] + i O[k]
+        X[2 * k] = e_re - o_im;
+        X[2 * k + 1] = e_im + o_re;
+
+        if (m != k) {
+            // E[m] = conj(E[k]), O[m] = conj(O[k])
+            X[2 * m] = e_re + o_im;
+            X[2 * m + 1] = -e_im + o_re;
+        }
+    }
+
+    complex_fft(fft, X, +1);
+
+    double scale = 1.0 / half;
+    for (int i = 0; i < fft->n; i++) {
+        X[i] *= scale;
+    }
+}
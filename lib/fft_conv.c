@@ -0,0 +1,215 @@
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "tileconv_internal.h"
+
+// Smallest and largest overlap-save block the FFT engine considers
+#define FFT_MIN_BLOCK 64
+#define FFT_MAX_BLOCK (1 << 22)
+
+// The FFT engine is only chosen when it is predicted to beat direct by this factor
+#define FFT_MARGIN 0.8
+
+// Measured once per process: direct cost per multiply-accumulate and FFT cost per
+// n log2 n of one overlap-save block (forward transform, spectrum product, inverse)
+static double ns_per_mac;
+static double ns_per_fft_unit;
+static pthread_once_t calibration_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Times the dispatched direct row kernel and one overlap-save FFT block on
+ * this machine so the direct/FFT crossover follows the actual hardware.
+ */
+static void calibrate(void) {
+    enum { N_OUT = 4096, TAPS = 256, FFT_N = 4096, REPEATS = 3 };
+
+    // Fallback ratios in case an allocation fails
+    ns_per_mac = 0.1;
+    ns_per_fft_unit = 1.0;
+
+    int *a = (int *)malloc((N_OUT + TAPS) * sizeof(int));
+    int *w = (int *)malloc(TAPS * sizeof(int));
+    int *c = (int *)malloc(N_OUT * sizeof(int));
+    double *X = (double *)tc_alloc_aligned((FFT_N + 2) * sizeof(double));
+    double *H = (double *)tc_alloc_aligned((FFT_N + 2) * sizeof(double));
+    tc_fft *fft = tc_fft_create(FFT_N);
+
+    if (a && w && c && X && H && fft) {
+        for (int i = 0; i < N_OUT + TAPS; i++) a[i] = i % 97;
+        for (int i = 0; i < TAPS; i++) w[i] = i % 7 - 3;
+        for (int i = 0; i < FFT_N + 2; i++) H[i] = 0.5;
+
+        double best = 1e30;
+        for (int r = 0; r < REPEATS; r++) {
+            double start = tc_now();
+            tc_row_correlate(c, a, w, TAPS, N_OUT, 1);
+            double elapsed = tc_now() - start;
+            if (elapsed < best) best = elapsed;
+        }
+        if (best > 0) ns_per_mac = best * 1e9 / ((double)N_OUT * TAPS);
+
+        best = 1e30;
+        for (int r = 0; r < REPEATS; r++) {
+            for (int i = 0; i < FFT_N; i++) X[i] = a[i];
+            double start = tc_now();
+            tc_fft_forward(fft, X, X);
+            for (int k = 0; k <= FFT_N / 2; k++) {
+                double re = X[2 * k] * H[2 * k] - X[2 * k + 1] * H[2 * k + 1];
+                double im = X[2 * k] * H[2 * k + 1] + X[2 * k + 1] * H[2 * k];
+                X[2 * k] = re;
+                X[2 * k + 1] = im;
+            }
+            tc_fft_inverse(fft, X);
+            double elapsed = tc_now() - start;
+            if (elapsed < best) best = elapsed;
+        }
+        if (best > 0) ns_per_fft_unit = best * 1e9 / ((double)FFT_N * log2(FFT_N));
+    }
+
+    free(a);
+    free(w);
+    free(c);
+    free(X);
+    free(H);
+    tc_fft_destroy(fft);
+}
+
+/**
+ * Predicted FFT cost of a 1D plan for block size n, in nanoseconds.
+ */
+static double fft_cost(int n, int size_B, int size_C) {
+    int outputs_per_block = n - size_B + 1;
+    int blocks = (size_C + outputs_per_block - 1) / outputs_per_block;
+    return (double)blocks * n * log2(n) * ns_per_fft_unit;
+}
+
+int tc_fft_plan_1d(tc_plan *plan) {
+    if (plan->engine == TC_ENGINE_DIRECT) return 0;
+
+    pthread_once(&calibration_once, calibrate);
+
+    int size_A = plan->size_A[0], size_B = plan->size_B[0], size_C = plan->size_C[0];
+
+    // Pick the overlap-save block with the lowest predicted cost. A block must be
+    // at least twice the kernel to produce a useful number of outputs, and need not
+    // exceed the smallest power of two holding the whole input.
+    int n = FFT_MIN_BLOCK;
+    while (n < 2 * size_B && n < FFT_MAX_BLOCK) n <<= 1;
+    int best_n = n;
+    double best_cost = fft_cost(n, size_B, size_C);
+    for (n <<= 1; n <= FFT_MAX_BLOCK && n / 2 < size_A; n <<= 1) {
+        double cost = fft_cost(n, size_B, size_C);
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_n = n;
+        }
+    }
+    if (best_n - size_B + 1 < 1) {
+        plan->engine = TC_ENGINE_DIRECT;
+        return 0;
+    }
+
+    double direct_cost = (double)size_C * size_B * ns_per_mac;
+    if (plan->engine == TC_ENGINE_AUTO && best_cost >= FFT_MARGIN * direct_cost) {
+        plan->engine = TC_ENGINE_DIRECT;
+        return 0;
+    }
+
+    plan->fft = tc_fft_create(best_n);
+    plan->H = (double *)tc_alloc_aligned((best_n + 2) * sizeof(double));
+    if (!plan->fft || !plan->H) return -1;
+
+    // Overlap-save computes a linear convolution, so transform the reversed oriented kernel
+    double norm_sq = 0.0;
+    for (int i = 0; i < best_n; i++) plan->H[i] = 0.0;
+    for (int k = 0; k < size_B; k++) {
+        plan->H[size_B - 1 - k] = plan->W[k];
+        norm_sq += (double)plan->W[k] * plan->W[k];
+    }
+    tc_fft_forward(plan->fft, plan->H, plan->H);
+
+    // Rounding error of an FFT convolution grows like eps * log2(n) * ||x||_2 * ||w||_2,
+    // with ||x||_2 <= sqrt(n) * max |x|. The factor 4 leaves headroom over the usual constant.
+    plan->fft_error = 4.0 * DBL_EPSILON * log2(best_n) * sqrt((double)best_n) * sqrt(norm_sq);
+    plan->engine = TC_ENGINE_FFT;
+    return 0;
+}
+
+/**
+ * Overlap-save FFT correlation. Each block transforms n input samples,
+ * multiplies by the kernel spectrum and keeps the n - size_B + 1 outputs that
+ * did not wrap around. Results are rounded to the nearest integer, which is
+ * exact as long as the rounding error bound stays below one half; inputs whose
+ * magnitude could break that bound are sent to the direct engine instead.
+ * The transforms cover the outputs whose footprint lies inside A; the halo of
+ * 'same' and 'full' plans is left to the direct engine's clamped points.
+ */
+void tc_fft_execute_1d(const tc_plan *plan, const int *A, int *C, long long *C64) {
+    int size_A = plan->size_A[0], size_B = plan->size_B[0], size_C = plan->size_C[0];
+    int n = plan->fft->n;
+    int outputs_per_block = n - size_B + 1;
+    int lo[3], hi[3];
+    tc_interior_range(plan, lo, hi);
+
+    double max_abs = 0.0;
+    for (int i = 0; i < size_A; i++) {
+        double v = fabs((double)A[i]);
+        if (v > max_abs) max_abs = v;
+    }
+    double *X = max_abs * plan->fft_error < 0.25
+                ? (double *)tc_alloc_aligned((n + 2) * sizeof(double)) : NULL;
+    if (!X) {
+        tc_direct_range_1d(plan, A, C, C64, 0, size_C);
+        return;
+    }
+    tc_direct_range_1d(plan, A, C, C64, 0, lo[0]);
+    tc_direct_range_1d(plan, A, C, C64, hi[0], size_C);
+
+    // Interior output lo + j starts at A[j]
+    int valid = hi[0] - lo[0];
+    if (C64) {
+        C64 += lo[0];
+    } else {
+        C += lo[0];
+    }
+    const double *H = plan->H;
+    for (int start = 0; start < valid; start += outputs_per_block) {
+        int count = (size_A - start < n) ? size_A - start : n;
+        for (int i = 0; i < count; i++) X[i] = A[start + i];
+        for (int i = count; i < n; i++) X[i] = 0.0;
+
+        tc_fft_forward(plan->fft, X, X);
+        for (int k = 0; k <= n / 2; k++) {
+            double re = X[2 * k] * H[2 * k] - X[2 * k + 1] * H[2 * k + 1];
+            double im = X[2 * k] * H[2 * k + 1] + X[2 * k + 1] * H[2 * k];
+            X[2 * k] = re;
+            X[2 * k + 1] = im;
+        }
+        tc_fft_inverse(plan->fft, X);
+
+        int outputs = (valid - start < outputs_per_block) ? valid - start : outputs_per_block;
+        const double *y = X + size_B - 1;
+        if (C64) {
+            for (int j = 0; j < outputs; j++) C64[start + j] = llround(y[j]);
+        } else if (plan->accum != TC_ACCUM_INT32) {
+            for (int j = 0; j < outputs; j++) {
+                long long v = llround(y[j]);
+                C[start + j] = v > INT_MAX ? INT_MAX : (v < INT_MIN ? INT_MIN : (int)v);
+            }
+        } else {
+            for (int j = 0; j < outputs; j++) C[start + j] = (int)llround(y[j]);
+        }
+    }
+
+    free(X);
+}
+
+void tc_fft_plan_free(tc_plan *plan) {
+    tc_fft_destroy(plan->fft);
+    free(plan->H);
+    plan->fft = NULL;
+    plan->H = NULL;
+}
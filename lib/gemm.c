@@ -0,0 +1,112 @@
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TC_X86 1
+#endif
+
+#include "tileconv_internal.h"
+
+/*
+ * Implicit-GEMM engine (gemm_engine.h, built once per element type and ISA).
+ * The kernel matrix is packed at plan creation into blocks of GEMM_MR kernels,
+ * each stored K-major with its GEMM_MR values per K adjacent, so the
+ * micro-kernel reads one contiguous stream; a remainder of fewer than
+ * GEMM_MR kernels is stored one kernel at a time.
+ */
+
+// Kernels per micro-kernel block, vectors per panel row and rows of K per
+// packed panel: the 2 x 4 block of accumulators fits every register file, and
+// a panel (at most 16 KB) stays in L1 while every kernel block reuses it
+#define GEMM_MR 2
+#define GEMM_NV 4
+#define GEMM_KC 64
+
+/**
+ * Shape and strides of one implicit GEMM, in elements.
+ */
+typedef struct {
+    int kernels;
+    int channels;
+    int width_B;
+    int height_B;
+    long pitch_A;       // Input row stride
+    long channel_A;     // Input channel stride
+    long pitch_C;       // Output row stride (the outputs of all kernels have the same shape)
+} gemm_problem;
+
+#define WT int
+#define WS(name) name
+#define WACC unsigned
+#include "gemm_engine.h"
+#undef WT
+#undef WS
+#undef WACC
+
+#define WT float
+#define WS(name) name##_f
+#define WACC float
+#include "gemm_engine.h"
+#undef WT
+#undef WS
+#undef WACC
+
+#define WT double
+#define WS(name) name##_d
+#define WACC double
+#include "gemm_engine.h"
+#undef WT
+#undef WS
+#undef WACC
+
+void tc_gemm_select_kernels(const char *isa) {
+    gemm_select(isa);
+    gemm_select_f(isa);
+    gemm_select_d(isa);
+}
+
+int tc_gemm_pack(const void *W, int kernels, long K, tc_dtype dtype, void **packed) {
+    size_t element = dtype == TC_FLOAT ? sizeof(float) : dtype == TC_DOUBLE ? sizeof(double) : sizeof(int);
+    char *Wp = (char *)malloc((size_t)kernels * K * element);
+    if (!Wp) return -1;
+
+    for (int q = 0; q < kernels; q++) {
+        // Kernel q sits in its block of GEMM_MR (or alone in the remainder) at
+        // row i of that block, with the block's rows interleaved per K
+        int block = q / GEMM_MR * GEMM_MR;
+        int mr = block + GEMM_MR <= kernels ? GEMM_MR : 1;
+        int i = mr == 1 ? 0 : q - block;
+        long base = mr == 1 ? (long)q * K : (long)block * K;
+        for (long k = 0; k < K; k++) {
+            memcpy(Wp + (base + k * mr + i) * element, (const char *)W + ((long)q * K + k) * element, element);
+        }
+    }
+    *packed = Wp;
+    return 0;
+}
+
+void tc_gemm_block_2d(tc_dtype dtype, const void *Wp, int kernels, const int size_B[3],
+                      const void *A, long pitch_A, void *const *C, long pitch_C, int y0, int y1, int x0, int x1) {
+    gemm_problem g = {kernels, 1, size_B[0], size_B[1], pitch_A, 0, pitch_C};
+    switch (dtype) {
+        case TC_FLOAT:
+            gemm_rows_isa_f(&g, (const float *)Wp, (const float *)A, (float *const *)C, y0, y1, x0, x1);
+            break;
+        case TC_DOUBLE:
+            gemm_rows_isa_d(&g, (const double *)Wp, (const double *)A, (double *const *)C, y0, y1, x0, x1);
+            break;
+        default:
+            gemm_rows_isa(&g, (const int *)Wp, (const int *)A, (int *const *)C, y0, y1, x0, x1);
+            break;
+    }
+}
+
+int tc_gemm_plan(tc_plan *plan, const tc_options *opts) {
+    if (opts->engine != TC_ENGINE_GEMM || plan->dims != 2) return 0;
+    if (plan->dtype == TC_INT && plan->accum != TC_ACCUM_INT32) return 0;
+
+    const void *W = plan->dtype == TC_INT ? (const void *)plan->W : plan->W_real;
+    if (tc_gemm_pack(W, 1, (long)plan->size_B[0] * plan->size_B[1], plan->dtype, &plan->W_gemm) != 0) return -1;
+    plan->engine = TC_ENGINE_GEMM;
+    return 0;
+}
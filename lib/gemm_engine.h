@@ -0,0 +1,175 @@
+/*
+ * Type-generic implicit-GEMM engine. Like winograd_engine.h there is
+ * deliberately no include guard: gemm.c includes this file once per element
+ * type after defining
+ *
+ *   WT          the element type (int, float or double)
+ *   WS(name)    name with the type suffix (none, _f or _d)
+ *   WACC        the type the micro-kernel accumulates in: unsigned for int,
+ *               so sums wrap modulo 2^32 exactly like the direct int kernels
+ *
+ * Convolution as a GEMM: C (kernels x pixels) = W (kernels x K) * patches
+ * (K x pixels), K = channels * height_B * width_B. Patches are never stored
+ * as a whole: each block of GEMM_NR(bits) output pixels of one row is packed, GEMM_KC
+ * rows of K at a time, into a panel that the register-blocked micro-kernel
+ * then multiplies with every block of GEMM_MR kernels. The GEMM_NV vectors of
+ * a panel row are independent accumulator chains, so even a single kernel
+ * keeps the multiply-add units busy.
+ */
+
+// Elements per vector of the given width, and per packed panel row
+#define GEMM_LANES(bits) ((bits) / 8 / (int)sizeof(WT))
+#define GEMM_NR(bits) (GEMM_NV * GEMM_LANES(bits))
+
+/*
+ * Micro-kernel on vectors of the given width, the widest native one of the
+ * ISA being built (wider vector types would be lowered through the stack):
+ * an mr x GEMM_NR(bits) block of C in registers, mr x GEMM_NV independent
+ * vectors, accumulated over kc rows of K from the packed kernels Wp (kc x mr)
+ * and the panel Bp (kc x GEMM_NR(bits), 64-byte aligned). Row i of the block
+ * goes to C[i] + offset, first n columns; first selects overwriting over
+ * accumulating into C.
+ */
+#define GEMM_MICRO(bits) \
+    typedef WACC WS(gemm_vec##bits) __attribute__((vector_size(bits / 8))); \
+    static inline __attribute__((always_inline)) \
+    void WS(gemm_micro##bits)(int kc, const WT *Wp, const WT *Bp, WT *const *C, long offset, int n, \
+                              int first, const int mr) { \
+        WS(gemm_vec##bits) acc[GEMM_MR][GEMM_NV]; \
+        for (int i = 0; i < mr; i++) { \
+            for (int v = 0; v < GEMM_NV; v++) acc[i][v] = (WS(gemm_vec##bits)){0}; \
+        } \
+        for (int k = 0; k < kc; k++) { \
+            const WS(gemm_vec##bits) *b = (const WS(gemm_vec##bits) *)(Bp + k * GEMM_NR(bits)); \
+            for (int i = 0; i < mr; i++) { \
+                WACC w = (WACC)Wp[k * mr + i]; \
+                for (int v = 0; v < GEMM_NV; v++) acc[i][v] += w * b[v]; \
+            } \
+        } \
+        for (int i = 0; i < mr; i++) { \
+            for (int v = 0; v < GEMM_NV; v++) { \
+                WT *c = C[i] + offset + v * GEMM_LANES(bits); \
+                int count = n - v * GEMM_LANES(bits); \
+                if (count <= 0) break; \
+                if (count > GEMM_LANES(bits)) count = GEMM_LANES(bits); \
+                if (!first) { \
+                    WS(gemm_vec##bits) old = {0}; \
+                    memcpy(&old, c, count * sizeof(WT)); \
+                    acc[i][v] += old; \
+                } \
+                memcpy(c, &acc[i][v], count * sizeof(WT)); \
+            } \
+        } \
+    }
+
+GEMM_MICRO(128)
+GEMM_MICRO(256)
+GEMM_MICRO(512)
+
+#undef GEMM_MICRO
+
+static inline __attribute__((always_inline))
+void WS(gemm_micro)(int kc, const WT *Wp, const WT *Bp, WT *const *C, long offset, int n, int first,
+                    const int mr, const int bits) {
+    if (bits == 512) {
+        WS(gemm_micro512)(kc, Wp, Bp, C, offset, n, first, mr);
+    } else if (bits == 256) {
+        WS(gemm_micro256)(kc, Wp, Bp, C, offset, n, first, mr);
+    } else {
+        WS(gemm_micro128)(kc, Wp, Bp, C, offset, n, first, mr);
+    }
+}
+
+/**
+ * Computes output rows [y0, y1), columns [x0, x1) of every kernel. A holds
+ * the channels channel_A elements apart; kernel q writes to C[q], with rows
+ * pitch_C apart. Wp is the packed kernel matrix (see tc_gemm_pack).
+ */
+static inline __attribute__((always_inline))
+void WS(gemm_rows)(const gemm_problem *g, const WT *Wp, const WT *A, WT *const *C, int y0, int y1,
+                   int x0, int x1, const int bits) {
+    const int nr = GEMM_NR(bits);
+    long K = (long)g->channels * g->height_B * g->width_B;
+    WT Bp[GEMM_KC * GEMM_NR(512)] __attribute__((aligned(64)));
+
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x += nr) {
+            int n = x1 - x < nr ? x1 - x : nr;
+            long offset = y * g->pitch_C + x;
+
+            for (long k0 = 0; k0 < K; k0 += GEMM_KC) {
+                int kc = K - k0 < GEMM_KC ? (int)(K - k0) : GEMM_KC;
+
+                // Implicit im2col: row k = (c, ky, kx) of the panel is input row
+                // y + ky of channel c, starting at column x + kx
+                int kx = k0 % g->width_B, ky = k0 / g->width_B % g->height_B;
+                int c = k0 / ((long)g->width_B * g->height_B);
+                for (int k = 0; k < kc; k++) {
+                    const WT *src = A + c * g->channel_A + (y + ky) * g->pitch_A + x + kx;
+                    WT *dst = Bp + k * nr;
+                    if (n == nr) {
+                        memcpy(dst, src, nr * sizeof(WT));
+                    } else {
+                        memcpy(dst, src, n * sizeof(WT));
+                        memset(dst + n, 0, (nr - n) * sizeof(WT));
+                    }
+                    if (++kx == g->width_B) {
+                        kx = 0;
+                        if (++ky == g->height_B) {
+                            ky = 0;
+                            c++;
+                        }
+                    }
+                }
+
+                int q = 0;
+                for (; q + GEMM_MR <= g->kernels; q += GEMM_MR) {
+                    WS(gemm_micro)(kc, Wp + q * K + k0 * GEMM_MR, Bp, C + q, offset, n, k0 == 0, GEMM_MR, bits);
+                }
+                for (; q < g->kernels; q++) {
+                    WS(gemm_micro)(kc, Wp + q * K + k0, Bp, C + q, offset, n, k0 == 0, 1, bits);
+                }
+            }
+        }
+    }
+}
+
+typedef void (*WS(gemm_rows_fn))(const gemm_problem *g, const WT *Wp, const WT *A, WT *const *C,
+                                  int y0, int y1, int x0, int x1);
+
+// One build per ISA, each on its native vector width
+#define GEMM_BUILD(isa, target, bits) \
+    target static void WS(gemm_rows_##isa)(const gemm_problem *g, const WT *Wp, const WT *A, WT *const *C, \
+                                           int y0, int y1, int x0, int x1) { \
+        WS(gemm_rows)(g, Wp, A, C, y0, y1, x0, x1, bits); \
+    }
+
+GEMM_BUILD(scalar, , 128)
+#ifdef TC_X86
+GEMM_BUILD(avx2, __attribute__((target("avx2,fma"))), 256)
+GEMM_BUILD(avx512, __attribute__((target("avx512f"))), 512)
+#endif
+
+#undef GEMM_BUILD
+
+static WS(gemm_rows_fn) WS(gemm_rows_isa) = WS(gemm_rows_scalar);
+
+static void WS(gemm_select)(const char *isa) {
+    WS(gemm_rows_isa) = WS(gemm_rows_scalar);
+#ifdef TC_X86
+    if (strcmp(isa, "avx512") == 0) {
+        WS(gemm_rows_isa) = WS(gemm_rows_avx512);
+    } else if (strcmp(isa, "avx2") == 0) {
+        WS(gemm_rows_isa) = WS(gemm_rows_avx2);
+    }
+#endif
+}
+
+void WS(tc_gemm_tile_2d)(const tc_plan *plan, const WT *A, long pitch_A, WT *C, long pitch_C,
+                         int i_tile, int j_tile, int height, int width) {
+    gemm_problem g = {1, 1, plan->size_B[0], plan->size_B[1], pitch_A, 0, pitch_C};
+    WS(gemm_rows_isa)(&g, (const WT *)plan->W_gemm, A, &C, i_tile, i_tile + height, j_tile, j_tile + width);
+}
+
+#undef GEMM_LANES
+#undef GEMM_NR
@@ -0,0 +1,224 @@
+/*
+ * Boundary and phase sample loops shared by every element type. There is
+ * deliberately no include guard: direct.c includes this file for int and
+ * real_engine.h once per real type, each after defining
+ *
+ *   ELEM            the element type (int, float or double)
+ *   ACC             the type one output is summed in (long long for int)
+ *   ES(name)        name with the engine's suffix
+ *   ELEM_W(plan)    the plan's oriented kernel as const ELEM *
+ *
+ * so the tap-by-tap boundary points, the halo gathers and the phase split
+ * and merge of all engines come from this one source. The index math they use
+ * (tc_source_index, tc_phase_layout, ...) is in tileconv_internal.h; the row
+ * kernel calls and the stores, which differ per accumulator, stay with the
+ * engines.
+ */
+
+/**
+ * Computes a single output whose footprint crosses the input boundary under
+ * a reflect, replicate or wrap extension: every tap outside A remaps its index.
+ */
+static ACC ES(extended_point)(const tc_plan *plan, const ELEM *A, long row_A, long slice_A, int x, int y, int z) {
+    int size_B_x = plan->size_B[0], size_B_y = plan->size_B[1], size_B_z = plan->size_B[2];
+    // Only the taps outside A along x remap; the run between them is contiguous
+    int x0 = x - plan->pad[0];
+    int kx_lo, kx_hi;
+    tc_clamp_taps(x, plan->pad[0], plan->size_A[0], size_B_x, &kx_lo, &kx_hi);
+    if (kx_hi < kx_lo) kx_hi = kx_lo;
+    const ELEM *w = ELEM_W(plan);
+    ACC sum = 0;
+    for (int kz = 0; kz < size_B_z; kz++) {
+        const ELEM *a_slice = A + tc_source_index(plan, 2, z - plan->pad[2] + kz) * slice_A;
+        for (int ky = 0; ky < size_B_y; ky++) {
+            const ELEM *a = a_slice + tc_source_index(plan, 1, y - plan->pad[1] + ky) * row_A;
+            for (int kx = 0; kx < kx_lo; kx++) sum += (ACC)a[tc_source_index(plan, 0, x0 + kx)] * w[kx];
+            for (int kx = kx_lo; kx < kx_hi; kx++) sum += (ACC)a[x0 + kx] * w[kx];
+            for (int kx = kx_hi; kx < size_B_x; kx++) sum += (ACC)a[tc_source_index(plan, 0, x0 + kx)] * w[kx];
+            w += size_B_x;
+        }
+    }
+    return sum;
+}
+
+/**
+ * Computes a single output whose footprint crosses the input boundary.
+ * Tap ranges are clamped once per axis, so there is no per-tap bounds check.
+ */
+static ACC ES(boundary_point)(const tc_plan *plan, const ELEM *A, long row_A, long slice_A, int x, int y, int z) {
+    if (plan->boundary != TC_BOUNDARY_ZERO) return ES(extended_point)(plan, A, row_A, slice_A, x, y, z);
+
+    int size_B_x = plan->size_B[0], size_B_y = plan->size_B[1];
+    long slice_B = (long)size_B_y * size_B_x;
+    int kx_lo, kx_hi, ky_lo, ky_hi, kz_lo, kz_hi;
+    tc_clamp_taps(x, plan->pad[0], plan->size_A[0], size_B_x, &kx_lo, &kx_hi);
+    tc_clamp_taps(y, plan->pad[1], plan->size_A[1], size_B_y, &ky_lo, &ky_hi);
+    tc_clamp_taps(z, plan->pad[2], plan->size_A[2], plan->size_B[2], &kz_lo, &kz_hi);
+
+    const ELEM *a_origin = A + (z - plan->pad[2]) * slice_A + (y - plan->pad[1]) * row_A + (x - plan->pad[0]);
+    ACC sum = 0;
+    for (int kz = kz_lo; kz < kz_hi; kz++) {
+        for (int ky = ky_lo; ky < ky_hi; ky++) {
+            const ELEM *a = a_origin + kz * slice_A + ky * row_A;
+            const ELEM *w = ELEM_W(plan) + kz * slice_B + (long)ky * size_B_x;
+            for (int kx = kx_lo; kx < kx_hi; kx++) sum += (ACC)a[kx] * w[kx];
+        }
+    }
+    return sum;
+}
+
+/**
+ * Returns a pointer to n input samples of row a starting at column x,
+ * gathering the extension into ext when the run leaves A along x.
+ */
+static inline const ELEM *ES(halo_samples)(const tc_plan *plan, const ELEM *a, int x, int n, ELEM *ext) {
+    if (x >= 0 && x + n <= plan->size_A[0]) return a + x;
+    for (int i = 0; i < n; i++) {
+        int xi = tc_source_index(plan, 0, x + i);
+        ext[i] = xi < 0 ? 0 : a[xi];
+    }
+    return ext;
+}
+
+/**
+ * Returns the kernel row ky of slice kz for a halo span of row (y, z), or
+ * NULL if it reads a zero row outside A.
+ */
+static inline const ELEM *ES(halo_row)(const tc_plan *plan, const ELEM *A, long row_A, long slice_A,
+                                       int y, int z, int ky, int kz) {
+    int iz = tc_source_index(plan, 2, z - plan->pad[2] + kz);
+    int iy = tc_source_index(plan, 1, y - plan->pad[1] + ky);
+    if (iz < 0 || iy < 0) return NULL;
+    return A + iz * slice_A + iy * row_A;
+}
+
+/**
+ * Computes one output of a strided or dilated plan tap by tap. Only used when
+ * the phase path cannot allocate its scratch.
+ */
+static ACC ES(phase_point)(const tc_plan *plan, const ELEM *A, long row_A, long slice_A, int x, int y, int z) {
+    int size_B_x = plan->size_B[0], size_B_y = plan->size_B[1], size_B_z = plan->size_B[2];
+    ACC sum = 0;
+    for (int kz = 0; kz < size_B_z; kz++) {
+        int iz = tc_source_index(plan, 2, z * plan->stride[2] - plan->pad[2] + kz * plan->dilation[2]);
+        if (iz < 0) continue;
+        for (int ky = 0; ky < size_B_y; ky++) {
+            int iy = tc_source_index(plan, 1, y * plan->stride[1] - plan->pad[1] + ky * plan->dilation[1]);
+            if (iy < 0) continue;
+            const ELEM *w = ELEM_W(plan) + ((long)kz * size_B_y + ky) * size_B_x;
+            for (int kx = 0; kx < size_B_x; kx++) {
+                int ix = tc_source_index(plan, 0, x * plan->stride[0] - plan->pad[0] + kx * plan->dilation[0]);
+                if (ix >= 0) sum += (ACC)A[iz * slice_A + iy * row_A + ix] * w[kx];
+            }
+        }
+    }
+    return sum;
+}
+
+/**
+ * Splits the n samples of src into its step phases: sample i goes to G[(i %
+ * step) * len + i / step]. Small steps get their own loops, which the
+ * compiler turns into vector shuffles.
+ */
+static void ES(phase_split)(const ELEM *src, long n, int step, long len, ELEM *G) {
+    long full = n / step;
+    ELEM *restrict g0 = G, *restrict g1 = G + len, *restrict g2 = G + 2 * len, *restrict g3 = G + 3 * len;
+    if (step == 2) {
+        for (long q = 0; q < full; q++) {
+            g0[q] = src[2 * q];
+            g1[q] = src[2 * q + 1];
+        }
+    } else if (step == 3) {
+        for (long q = 0; q < full; q++) {
+            g0[q] = src[3 * q];
+            g1[q] = src[3 * q + 1];
+            g2[q] = src[3 * q + 2];
+        }
+    } else if (step == 4) {
+        for (long q = 0; q < full; q++) {
+            g0[q] = src[4 * q];
+            g1[q] = src[4 * q + 1];
+            g2[q] = src[4 * q + 2];
+            g3[q] = src[4 * q + 3];
+        }
+    } else {
+        for (int r = 0; r < step; r++) {
+            for (long q = 0; q < full; q++) G[r * len + q] = src[q * step + r];
+        }
+    }
+    for (long i = full * step; i < n; i++) G[(i % step) * len + i / step] = src[i];
+}
+
+/**
+ * Interleaves the step runs of T, len apart, into n outputs of C: output i is
+ * T[(i % step) * len + i / step].
+ */
+static void ES(phase_merge)(const ELEM *T, long len, int step, int n, ELEM *C) {
+    int full = n / step;
+    const ELEM *restrict t0 = T, *restrict t1 = T + len, *restrict t2 = T + 2 * len, *restrict t3 = T + 3 * len;
+    if (step == 2) {
+        for (int q = 0; q < full; q++) {
+            C[2 * q] = t0[q];
+            C[2 * q + 1] = t1[q];
+        }
+    } else if (step == 3) {
+        for (int q = 0; q < full; q++) {
+            C[3 * q] = t0[q];
+            C[3 * q + 1] = t1[q];
+            C[3 * q + 2] = t2[q];
+        }
+    } else if (step == 4) {
+        for (int q = 0; q < full; q++) {
+            C[4 * q] = t0[q];
+            C[4 * q + 1] = t1[q];
+            C[4 * q + 2] = t2[q];
+            C[4 * q + 3] = t3[q];
+        }
+    } else {
+        for (int r = 0; r < step; r++) {
+            for (int q = 0; q < full; q++) C[q * step + r] = T[r * len + q];
+        }
+    }
+    for (int i = full * step; i < n; i++) C[i] = T[(i % step) * len + i / step];
+}
+
+/**
+ * Fills the phase path scratch G for the n outputs from column c0 of output
+ * rows yc, ... of slice z: every input row the fill reads, ny per slice, is
+ * split once into the step phases of layout with the boundary extension
+ * already applied (gathered through ext where it leaves A along x). row_G
+ * points at each split row, in tc_phase_fill_row order, or is NULL for a
+ * zero row outside A.
+ */
+static void ES(phase_fill)(const tc_plan *plan, const tc_phase_layout *layout, const ELEM *A, long row_A, long slice_A,
+                           int c0, int n, int yc, int ny, int z, ELEM *G, const ELEM **row_G, ELEM *ext) {
+    int vy0 = yc * plan->stride[1] - plan->pad[1], vz0 = z * plan->stride[2] - plan->pad[2];
+    long xs = (long)c0 * plan->stride[0] - plan->pad[0];
+    long count = tc_phase_span(plan, n);
+    long split = layout->step * layout->len;
+
+    for (int vz = 0; vz < layout->rows_z; vz++) {
+        int iz = tc_source_index(plan, 2, vz0 + vz);
+        for (int vy = 0; vy < ny; vy++) {
+            int iy = tc_source_index(plan, 1, vy0 + vy);
+            long index = (long)vz * ny + vy;
+            if (iz < 0 || iy < 0) {
+                row_G[index] = NULL;
+                continue;
+            }
+            const ELEM *a = A + iz * slice_A + iy * row_A;
+            if (xs < 0 || xs + count > plan->size_A[0]) {
+                for (long i = 0; i < count; i++) {
+                    int ix = tc_source_index(plan, 0, (int)(xs + i));
+                    ext[i] = ix < 0 ? 0 : a[ix];
+                }
+                a = ext;
+            } else {
+                a += xs;
+            }
+            ELEM *g = G + index * split;
+            ES(phase_split)(a, count, layout->step, layout->len, g);
+            row_G[index] = g;
+        }
+    }
+}
@@ -0,0 +1,194 @@
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TC_X86 1
+#endif
+
+#include "tileconv_internal.h"
+
+/*
+ * Batched multi-channel 2D layers (layer_engine.h, built once per element
+ * type and ISA). Activations are processed in the channel-blocked NCHWc
+ * layout: channels are grouped into blocks of one 64-byte vector (16 int or
+ * float, 8 double channels), stored [n][block][y][x][channel in block]. The
+ * block does not depend on the ISA, so blocked buffers can be kept between
+ * runs; AVX-512 handles a pixel of a block in one register, AVX2 in two.
+ *
+ * The work is split into tasks of one output tile of one output block of one
+ * image. A task walks the input blocks with the tile as the inner loop, so the
+ * tile's accumulators stay in L1 and each (output, input) block pair of the
+ * packed weights, height_B x width_B x 64 x 64 bytes, is read from L1 or L2
+ * for the whole tile.
+ */
+
+// Default output tile: 32 x 8 pixels of one block is 16 KB of accumulators
+#define LAYER_TILE_X 32
+#define LAYER_TILE_Y 8
+
+struct tc_layer {
+    tc_dtype dtype;
+    int channels_in;
+    int channels_out;
+    int lanes;          // Channels per block
+    int blocks_in;
+    int blocks_out;
+    int size_A[2];      // x, y extents
+    int size_B[2];
+    int size_C[2];
+    int tile[2];        // Output tile per axis
+    int tiles[2];
+    void *W;            // Packed kernels, see layer_pack
+    tc_pool *pool;      // NULL runs on the calling thread
+    int owns_pool;
+};
+
+#define WT int
+#define WS(name) name
+#define WACC unsigned
+#define WDTYPE TC_INT
+#include "layer_engine.h"
+#undef WT
+#undef WS
+#undef WACC
+#undef WDTYPE
+
+#define WT float
+#define WS(name) name##_f
+#define WACC float
+#define WDTYPE TC_FLOAT
+#include "layer_engine.h"
+#undef WT
+#undef WS
+#undef WACC
+#undef WDTYPE
+
+#define WT double
+#define WS(name) name##_d
+#define WACC double
+#define WDTYPE TC_DOUBLE
+#include "layer_engine.h"
+#undef WT
+#undef WS
+#undef WACC
+#undef WDTYPE
+
+void tc_layer_select_kernels(const char *isa) {
+    layer_select(isa);
+    layer_select_f(isa);
+    layer_select_d(isa);
+}
+
+tc_layer *tc_layer_create_typed(int channels_in, const int size_A[2], int channels_out, const int size_B[2],
+                                tc_dtype dtype, const tc_options *opts) {
+    tc_options defaults;
+    if (!opts) {
+        tc_options_init(&defaults);
+        opts = &defaults;
+    }
+    if (channels_in < 1 || channels_out < 1 || opts->output != TC_OUTPUT_VALID) return NULL;
+    for (int axis = 0; axis < 2; axis++) {
+        if (opts->stride[axis] > 1 || opts->dilation[axis] > 1) return NULL;
+    }
+    for (int axis = 0; axis < 2; axis++) {
+        if (size_B[axis] < 1 || size_A[axis] < size_B[axis]) return NULL;
+    }
+
+    tc_layer *layer = (tc_layer *)calloc(1, sizeof(tc_layer));
+    if (!layer) return NULL;
+    layer->dtype = dtype;
+    layer->channels_in = channels_in;
+    layer->channels_out = channels_out;
+    layer->lanes = 64 / (dtype == TC_DOUBLE ? (int)sizeof(double) : (int)sizeof(int));
+    layer->blocks_in = (channels_in + layer->lanes - 1) / layer->lanes;
+    layer->blocks_out = (channels_out + layer->lanes - 1) / layer->lanes;
+
+    int defaults_tile[2] = {LAYER_TILE_X, LAYER_TILE_Y};
+    for (int axis = 0; axis < 2; axis++) {
+        layer->size_A[axis] = size_A[axis];
+        layer->size_B[axis] = size_B[axis];
+        layer->size_C[axis] = size_A[axis] - size_B[axis] + 1;
+        int tile = opts->tile_A[axis] > 0 ? opts->tile_A[axis] : defaults_tile[axis];
+        layer->tile[axis] = tile < layer->size_C[axis] ? tile : layer->size_C[axis];
+        layer->tiles[axis] = (layer->size_C[axis] + layer->tile[axis] - 1) / layer->tile[axis];
+    }
+
+    size_t bytes = (size_t)layer->blocks_out * layer->blocks_in * size_B[0] * size_B[1] * 64 * layer->lanes;
+    layer->W = tc_alloc_aligned(bytes);
+    if (!layer->W) {
+        tc_layer_destroy(layer);
+        return NULL;
+    }
+
+    if (opts->pool) {
+        layer->pool = opts->pool;
+    } else if (opts->threads > 1) {
+        layer->pool = tc_pool_create(opts->threads);
+        layer->owns_pool = 1;
+        if (!layer->pool) {
+            tc_layer_destroy(layer);
+            return NULL;
+        }
+    }
+    return layer;
+}
+
+typedef struct {
+    const tc_layer *layer;
+    int batch;
+    const void *A;
+    void *C;
+} layer_job;
+
+static void layer_task(void *ctx, int index) {
+    const layer_job *job = (const layer_job *)ctx;
+    const tc_layer *layer = job->layer;
+    int tx = index % layer->tiles[0];
+    int ty = index / layer->tiles[0] % layer->tiles[1];
+    int ob = index / layer->tiles[0] / layer->tiles[1] % layer->blocks_out;
+    int n = index / layer->tiles[0] / layer->tiles[1] / layer->blocks_out;
+    switch (layer->dtype) {
+        case TC_FLOAT:
+            layer_tile_f(layer, (const float *)job->A, (float *)job->C, n, ob, tx, ty);
+            break;
+        case TC_DOUBLE:
+            layer_tile_d(layer, (const double *)job->A, (double *)job->C, n, ob, tx, ty);
+            break;
+        default:
+            layer_tile(layer, (const int *)job->A, (int *)job->C, n, ob, tx, ty);
+            break;
+    }
+}
+
+void tc_layer_run(const tc_layer *layer, int batch, const void *A, void *C) {
+    layer_job job = {layer, batch, A, C};
+    int tasks = batch * layer->blocks_out * layer->tiles[1] * layer->tiles[0];
+    if (layer->pool) {
+        tc_pool_run(layer->pool, tasks, layer_task, &job);
+    } else {
+        for (int t = 0; t < tasks; t++) layer_task(&job, t);
+    }
+}
+
+int tc_layer_block(const tc_layer *layer) {
+    return layer->lanes;
+}
+
+int tc_layer_output_size(const tc_layer *layer, int axis) {
+    return (axis == 0 || axis == 1) ? layer->size_C[axis] : 1;
+}
+
+long tc_layer_input_count(const tc_layer *layer, int batch) {
+    return (long)batch * layer->blocks_in * layer->lanes * layer->size_A[0] * layer->size_A[1];
+}
+
+long tc_layer_output_count(const tc_layer *layer, int batch) {
+    return (long)batch * layer->blocks_out * layer->lanes * layer->size_C[0] * layer->size_C[1];
+}
+
+void tc_layer_destroy(tc_layer *layer) {
+    if (!layer) return;
+    if (layer->owns_pool) tc_pool_destroy(layer->pool);
+    free(layer->W);
+    free(layer);
+}
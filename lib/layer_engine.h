@@ -0,0 +1,258 @@
+/*
+ * Type-generic multi-channel engine. Like gemm_engine.h there is deliberately
+ * no include guard: layer.c includes this file once per element type after
+ * defining
+ *
+ *   WT          the element type (int, float or double)
+ *   WS(name)    name with the type suffix (none, _f or _d)
+ *   WACC        the type the kernel accumulates in: unsigned for int, so sums
+ *               wrap modulo 2^32 exactly like the direct int kernels
+ *   WDTYPE      the tc_dtype of WT
+ *
+ * In the blocked layout the LAYER_LANES channels of a block are the innermost
+ * axis, so one 64-byte vector holds a pixel of a whole block. An output vector
+ * is accumulated as a sum of input scalars (one channel of one pixel,
+ * broadcast) times kernel vectors (that input channel's weight for each of the
+ * block's output channels): no horizontal sums, and every load is contiguous.
+ */
+
+#define LAYER_LANES ((int)(64 / sizeof(WT)))
+
+/*
+ * Accumulates the n output pixels from (x, y) of one output block in
+ * registers, on vectors of the given width: the widest native one of the ISA
+ * being built, since GCC lowers wider vector types through the stack. A pixel
+ * of a block is 512 / bits vectors, the weights of one input channel as many.
+ */
+#define LAYER_PIXELS(bits) \
+    typedef WACC WS(layer_vec##bits) __attribute__((vector_size(bits / 8))); \
+    static inline __attribute__((always_inline)) \
+    void WS(layer_pixels##bits)(const tc_layer *layer, const WT *A, const WT *W, WT *C, int channels, \
+                                int y, int x, int first, const int n) { \
+        const int lanes = LAYER_LANES, parts = 512 / bits, part = lanes / parts; \
+        int width_A = layer->size_A[0], width_B = layer->size_B[0], height_B = layer->size_B[1]; \
+        WS(layer_vec##bits) acc[8][512 / bits]; \
+        WT *c = C + ((long)y * layer->size_C[0] + x) * lanes; \
+        for (int r = 0; r < n; r++) { \
+            for (int v = 0; v < parts; v++) { \
+                if (first) { \
+                    acc[r][v] = (WS(layer_vec##bits)){0}; \
+                } else { \
+                    memcpy(&acc[r][v], c + r * lanes + v * part, sizeof(acc[r][v])); \
+                } \
+            } \
+        } \
+        for (int ky = 0; ky < height_B; ky++) { \
+            for (int kx = 0; kx < width_B; kx++) { \
+                const WT *a = A + ((long)(y + ky) * width_A + x + kx) * lanes; \
+                const WS(layer_vec##bits) *w = (const WS(layer_vec##bits) *)(W + (ky * width_B + kx) * lanes * lanes); \
+                for (int i = 0; i < channels; i++) { \
+                    for (int v = 0; v < parts; v++) { \
+                        WS(layer_vec##bits) w_i = w[i * parts + v]; \
+                        for (int r = 0; r < n; r++) acc[r][v] += (WACC)a[r * lanes + i] * w_i; \
+                    } \
+                } \
+            } \
+        } \
+        for (int r = 0; r < n; r++) { \
+            for (int v = 0; v < parts; v++) memcpy(c + r * lanes + v * part, &acc[r][v], sizeof(acc[r][v])); \
+        } \
+    }
+
+LAYER_PIXELS(128)
+LAYER_PIXELS(256)
+LAYER_PIXELS(512)
+
+#undef LAYER_PIXELS
+
+static inline __attribute__((always_inline))
+void WS(layer_pixels)(const tc_layer *layer, const WT *A, const WT *W, WT *C, int channels, int y, int x,
+                      int first, const int n, const int bits) {
+    if (bits == 512) {
+        WS(layer_pixels512)(layer, A, W, C, channels, y, x, first, n);
+    } else if (bits == 256) {
+        WS(layer_pixels256)(layer, A, W, C, channels, y, x, first, n);
+    } else {
+        WS(layer_pixels128)(layer, A, W, C, channels, y, x, first, n);
+    }
+}
+
+/**
+ * Accumulates one input channel block into rows [y0, y1), columns [x0, x1)
+ * of one output channel block. A, W and C point at the input block, the
+ * packed weights of the (output, input) block pair and the output block,
+ * whose first channels input channels are real (the rest are zero padding);
+ * first selects overwriting over accumulating into C. xr output pixels are
+ * held in registers at a time, xr x 512 / bits registers in all.
+ */
+static inline __attribute__((always_inline))
+void WS(layer_rows)(const tc_layer *layer, const WT *A, const WT *W, WT *C, int channels,
+                    int y0, int y1, int x0, int x1, int first, const int xr, const int bits) {
+    for (int y = y0; y < y1; y++) {
+        int x = x0;
+        for (; x + xr <= x1; x += xr) WS(layer_pixels)(layer, A, W, C, channels, y, x, first, xr, bits);
+        for (; x < x1; x++) WS(layer_pixels)(layer, A, W, C, channels, y, x, first, 1, bits);
+    }
+}
+
+typedef void (*WS(layer_rows_fn))(const tc_layer *layer, const WT *A, const WT *W, WT *C, int channels,
+                                  int y0, int y1, int x0, int x1, int first);
+
+// One build per ISA on its native vector width, with as many pixels in
+// registers as its register file holds next to the weight vector
+#define LAYER_BUILD(isa, target, xr, bits) \
+    target static void WS(layer_rows_##isa)(const tc_layer *layer, const WT *A, const WT *W, WT *C, \
+                                            int channels, int y0, int y1, int x0, int x1, int first) { \
+        WS(layer_rows)(layer, A, W, C, channels, y0, y1, x0, x1, first, xr, bits); \
+    }
+
+LAYER_BUILD(scalar, , 2, 128)
+#ifdef TC_X86
+LAYER_BUILD(avx2, __attribute__((target("avx2,fma"))), 6, 256)
+LAYER_BUILD(avx512, __attribute__((target("avx512f"))), 8, 512)
+#endif
+
+#undef LAYER_BUILD
+
+static WS(layer_rows_fn) WS(layer_rows_isa) = WS(layer_rows_scalar);
+
+static void WS(layer_select)(const char *isa) {
+    WS(layer_rows_isa) = WS(layer_rows_scalar);
+#ifdef TC_X86
+    if (strcmp(isa, "avx512") == 0) {
+        WS(layer_rows_isa) = WS(layer_rows_avx512);
+    } else if (strcmp(isa, "avx2") == 0) {
+        WS(layer_rows_isa) = WS(layer_rows_avx2);
+    }
+#endif
+}
+
+/**
+ * Packs the kernels (channels_out x channels_in x height_B x width_B, oriented
+ * for correlation by flip) into layer->W: per (output block, input block)
+ * pair, per kernel position, per input channel, one vector over the output
+ * channels of the block. Channels past the end are zero.
+ */
+static void WS(layer_pack)(tc_layer *layer, const WT *B, int flip) {
+    const int lanes = LAYER_LANES;
+    int width_B = layer->size_B[0], height_B = layer->size_B[1];
+    long positions = (long)width_B * height_B;
+    WT *W = (WT *)layer->W;
+
+    for (int ob = 0; ob < layer->blocks_out; ob++) {
+        for (int ib = 0; ib < layer->blocks_in; ib++) {
+            for (long k = 0; k < positions; k++) {
+                long source = flip ? positions - 1 - k : k;
+                for (int i = 0; i < lanes; i++) {
+                    for (int o = 0; o < lanes; o++) {
+                        int c_in = ib * lanes + i, c_out = ob * lanes + o;
+                        int inside = c_in < layer->channels_in && c_out < layer->channels_out;
+                        *W++ = inside ? B[((long)c_out * layer->channels_in + c_in) * positions + source] : 0;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Runs output tile (tx, ty) of channel block ob of image n, summing over
+ * every input block while the tile stays in cache.
+ */
+static void WS(layer_tile)(const tc_layer *layer, const WT *A, WT *C, int n, int ob, int tx, int ty) {
+    const int lanes = LAYER_LANES;
+    long plane_A = (long)layer->size_A[0] * layer->size_A[1] * lanes;
+    long plane_C = (long)layer->size_C[0] * layer->size_C[1] * lanes;
+    long pair_W = (long)layer->size_B[0] * layer->size_B[1] * lanes * lanes;
+    int x0 = tx * layer->tile[0], y0 = ty * layer->tile[1];
+    int x1 = x0 + layer->tile[0] < layer->size_C[0] ? x0 + layer->tile[0] : layer->size_C[0];
+    int y1 = y0 + layer->tile[1] < layer->size_C[1] ? y0 + layer->tile[1] : layer->size_C[1];
+
+    const WT *A_n = A + (long)n * layer->blocks_in * plane_A;
+    WT *C_o = C + ((long)n * layer->blocks_out + ob) * plane_C;
+    const WT *W_o = (const WT *)layer->W + (long)ob * layer->blocks_in * pair_W;
+    for (int ib = 0; ib < layer->blocks_in; ib++) {
+        int channels = layer->channels_in - ib * lanes < lanes ? layer->channels_in - ib * lanes : lanes;
+        WS(layer_rows_isa)(layer, A_n + ib * plane_A, W_o + ib * pair_W, C_o, channels, y0, y1, x0, x1, ib == 0);
+    }
+}
+
+void WS(tc_nchw_to_nchwc)(const WT *src, int batch, int channels, int height, int width, WT *dst) {
+    const int lanes = LAYER_LANES;
+    int blocks = (channels + lanes - 1) / lanes;
+    long plane = (long)height * width;
+
+    for (int n = 0; n < batch; n++) {
+        for (int b = 0; b < blocks; b++) {
+            WT *out = dst + ((long)n * blocks + b) * plane * lanes;
+            // Strips of 64 pixels keep the 64 output lines in L1 while each
+            // channel of the block is scattered into them
+            for (long p0 = 0; p0 < plane; p0 += 64) {
+                long p1 = p0 + 64 < plane ? p0 + 64 : plane;
+                for (int i = 0; i < lanes; i++) {
+                    int c = b * lanes + i;
+                    if (c < channels) {
+                        const WT *in = src + ((long)n * channels + c) * plane;
+                        for (long p = p0; p < p1; p++) out[p * lanes + i] = in[p];
+                    } else {
+                        for (long p = p0; p < p1; p++) out[p * lanes + i] = 0;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void WS(tc_nchwc_to_nchw)(const WT *src, int batch, int channels, int height, int width, WT *dst) {
+    const int lanes = LAYER_LANES;
+    int blocks = (channels + lanes - 1) / lanes;
+    long plane = (long)height * width;
+
+    for (int n = 0; n < batch; n++) {
+        for (int b = 0; b < blocks; b++) {
+            const WT *in = src + ((long)n * blocks + b) * plane * lanes;
+            int count = channels - b * lanes < lanes ? channels - b * lanes : lanes;
+            for (long p0 = 0; p0 < plane; p0 += 64) {
+                long p1 = p0 + 64 < plane ? p0 + 64 : plane;
+                for (int i = 0; i < count; i++) {
+                    WT *out = dst + ((long)n * channels + b * lanes + i) * plane;
+                    for (long p = p0; p < p1; p++) out[p] = in[p * lanes + i];
+                }
+            }
+        }
+    }
+}
+
+tc_layer *WS(tc_layer_create_2d)(tc_op op, int channels_in, int height_A, int width_A, int channels_out,
+                                 const WT *B, int height_B, int width_B, const tc_options *opts) {
+    int size_A[2] = {width_A, height_A}, size_B[2] = {width_B, height_B};
+    tc_layer *layer = tc_layer_create_typed(channels_in, size_A, channels_out, size_B, WDTYPE, opts);
+    if (layer) WS(layer_pack)(layer, B, op == TC_CONVOLUTION);
+    return layer;
+}
+
+int WS(tc_layer_execute_nchwc)(const tc_layer *layer, int batch, const WT *A, WT *C) {
+    if (layer->dtype != WDTYPE || batch < 1) return -1;
+    tc_layer_run(layer, batch, A, C);
+    return 0;
+}
+
+int WS(tc_layer_execute)(const tc_layer *layer, int batch, const WT *A, WT *C) {
+    if (layer->dtype != WDTYPE || batch < 1) return -1;
+    WT *A_blocked = (WT *)tc_alloc_aligned(tc_layer_input_count(layer, batch) * sizeof(WT));
+    WT *C_blocked = (WT *)tc_alloc_aligned(tc_layer_output_count(layer, batch) * sizeof(WT));
+    if (!A_blocked || !C_blocked) {
+        free(A_blocked);
+        free(C_blocked);
+        return -1;
+    }
+
+    WS(tc_nchw_to_nchwc)(A, batch, layer->channels_in, layer->size_A[1], layer->size_A[0], A_blocked);
+    tc_layer_run(layer, batch, A_blocked, C_blocked);
+    WS(tc_nchwc_to_nchw)(C_blocked, batch, layer->channels_out, layer->size_C[1], layer->size_C[0], C);
+    free(A_blocked);
+    free(C_blocked);
+    return 0;
+}
+
+#undef LAYER_LANES
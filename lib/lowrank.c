@@ -0,0 +1,206 @@
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "tileconv_internal.h"
+
+// Jacobi sweeps stop once every column pair is orthogonal to this relative precision
+#define JACOBI_EPSILON 1e-15
+#define JACOBI_MAX_SWEEPS 60
+
+/**
+ * Singular value decomposition of an m x n matrix (m >= n) by one-sided
+ * (Hestenes) Jacobi rotations. G holds the matrix column-major on entry and
+ * U * diag(sigma) on exit; V (n x n, column-major) accumulates the rotations,
+ * so that the input equals G * V^T. Kernels are small, so the O(n^2 m) sweeps
+ * cost nothing next to plan creation, and Jacobi gives accurate small
+ * singular values, which decide the rank.
+ */
+static void jacobi_svd(double *G, int m, int n, double *V) {
+    for (int i = 0; i < n * n; i++) V[i] = 0.0;
+    for (int i = 0; i < n; i++) V[i * n + i] = 1.0;
+
+    for (int sweep = 0; sweep < JACOBI_MAX_SWEEPS; sweep++) {
+        int rotated = 0;
+        for (int p = 0; p < n - 1; p++) {
+            for (int q = p + 1; q < n; q++) {
+                double *g_p = G + (long)p * m, *g_q = G + (long)q * m;
+                double alpha = 0.0, beta = 0.0, gamma = 0.0;
+                for (int i = 0; i < m; i++) {
+                    alpha += g_p[i] * g_p[i];
+                    beta += g_q[i] * g_q[i];
+                    gamma += g_p[i] * g_q[i];
+                }
+                if (fabs(gamma) <= JACOBI_EPSILON * sqrt(alpha * beta)) continue;
+
+                // Rotation that zeroes the off-diagonal entry of the 2 x 2 Gram matrix
+                double zeta = (beta - alpha) / (2.0 * gamma);
+                double t = (zeta >= 0 ? 1.0 : -1.0) / (fabs(zeta) + sqrt(1.0 + zeta * zeta));
+                double c = 1.0 / sqrt(1.0 + t * t), s = c * t;
+                for (int i = 0; i < m; i++) {
+                    double a = g_p[i], b = g_q[i];
+                    g_p[i] = c * a - s * b;
+                    g_q[i] = s * a + c * b;
+                }
+                double *v_p = V + (long)p * n, *v_q = V + (long)q * n;
+                for (int i = 0; i < n; i++) {
+                    double a = v_p[i], b = v_q[i];
+                    v_p[i] = c * a - s * b;
+                    v_q[i] = s * a + c * b;
+                }
+                rotated = 1;
+            }
+        }
+        if (!rotated) break;
+    }
+}
+
+/**
+ * Reads element i of the plan's float or double kernel.
+ */
+static double kernel_at(const tc_plan *plan, long i) {
+    return plan->dtype == TC_FLOAT ? ((const float *)plan->W_real)[i] : ((const double *)plan->W_real)[i];
+}
+
+int tc_lowrank_plan(tc_plan *plan, double tolerance) {
+    int bx = plan->size_B[0], by = plan->size_B[1];
+    long taps = (long)bx * by;
+
+    // Decompose the kernel, or its transpose, so that the matrix is tall
+    int transpose = bx > by;
+    int m = transpose ? bx : by, n = transpose ? by : bx;
+    double *G = (double *)malloc((size_t)(m * n + n * n + n) * sizeof(double));
+    if (!G) return -1;
+    double *V = G + m * n, *sigma = V + n * n;
+
+    // Column-major G: column j of the kernel (by rows, bx columns) or of its transpose
+    double norm_sq = 0.0;
+    for (int y = 0; y < by; y++) {
+        for (int x = 0; x < bx; x++) {
+            double w = kernel_at(plan, (long)y * bx + x);
+            if (transpose) {
+                G[(long)y * m + x] = w;
+            } else {
+                G[(long)x * m + y] = w;
+            }
+            norm_sq += w * w;
+        }
+    }
+    jacobi_svd(G, m, n, V);
+
+    // Sort the components by decreasing singular value
+    int *order = (int *)malloc(n * sizeof(int));
+    if (!order) {
+        free(G);
+        return -1;
+    }
+    for (int j = 0; j < n; j++) {
+        double s = 0.0;
+        for (int i = 0; i < m; i++) s += G[(long)j * m + i] * G[(long)j * m + i];
+        sigma[j] = sqrt(s);
+        order[j] = j;
+    }
+    for (int j = 1; j < n; j++) {
+        int key = order[j], i = j - 1;
+        while (i >= 0 && sigma[order[i]] < sigma[key]) {
+            order[i + 1] = order[i];
+            i--;
+        }
+        order[i + 1] = key;
+    }
+
+    // Smallest rank whose discarded singular values stay within the tolerance
+    // (Eckart-Young: the truncated SVD is the best approximation of that rank)
+    tc_lowrank_info *info = &plan->lowrank;
+    double tail_sq = norm_sq, limit_sq = tolerance * tolerance * norm_sq;
+    int rank = 0;
+    while (rank < n && tail_sq > limit_sq && sigma[order[rank]] > 0.0) {
+        double s = sigma[order[rank]];
+        tail_sq -= s * s;
+        rank++;
+    }
+    // Numerical rank: singular values above the rounding level of the element type
+    double rounding = (plan->dtype == TC_FLOAT ? FLT_EPSILON : DBL_EPSILON) * m * sigma[order[0]];
+    info->full_rank = 0;
+    for (int j = 0; j < n; j++) {
+        if (sigma[order[j]] > rounding) info->full_rank++;
+    }
+    info->rank = 0;
+    info->error = 0.0;
+    info->error_l1 = 0.0;
+    info->speedup = 1.0;
+
+    // Only worth it when r pairs of 1D passes are cheaper than the full kernel
+    if (rank == 0 || (long)rank * (bx + by) >= taps) {
+        free(order);
+        free(G);
+        return 0;
+    }
+
+    size_t element = plan->dtype == TC_FLOAT ? sizeof(float) : sizeof(double);
+    void *factors = malloc((size_t)rank * (bx + by) * element);
+    double *approx = (double *)calloc(taps, sizeof(double));
+    if (!factors || !approx) {
+        free(factors);
+        free(approx);
+        free(order);
+        free(G);
+        return -1;
+    }
+
+    // Component q is stored as its x factor (bx values) followed by its y factor
+    // (by values), each scaled by sqrt(sigma) to keep both in the same range
+    for (int q = 0; q < rank; q++) {
+        int j = order[q];
+        double root = sqrt(sigma[j]);
+        for (int k = 0; k < bx + by; k++) {
+            // Left singular vector entries are G[:, j] / sigma, right ones V[:, j]
+            int is_x = k < bx, index = is_x ? k : k - bx;
+            double value;
+            if (is_x == transpose) {
+                value = G[(long)j * m + index] / sigma[j] * root;
+            } else {
+                value = V[(long)j * n + index] * root;
+            }
+            if (plan->dtype == TC_FLOAT) {
+                ((float *)factors)[(long)q * (bx + by) + k] = (float)value;
+            } else {
+                ((double *)factors)[(long)q * (bx + by) + k] = value;
+            }
+        }
+    }
+
+    // Report the error of the factors actually stored, rounding included
+    for (int q = 0; q < rank; q++) {
+        for (int y = 0; y < by; y++) {
+            for (int x = 0; x < bx; x++) {
+                long base = (long)q * (bx + by);
+                double u, v;
+                if (plan->dtype == TC_FLOAT) {
+                    u = ((float *)factors)[base + x];
+                    v = ((float *)factors)[base + bx + y];
+                } else {
+                    u = ((double *)factors)[base + x];
+                    v = ((double *)factors)[base + bx + y];
+                }
+                approx[(long)y * bx + x] += u * v;
+            }
+        }
+    }
+    double residual_sq = 0.0;
+    for (long i = 0; i < taps; i++) {
+        double d = kernel_at(plan, i) - approx[i];
+        residual_sq += d * d;
+        info->error_l1 += fabs(d);
+    }
+    info->rank = rank;
+    info->error = norm_sq > 0.0 ? sqrt(residual_sq / norm_sq) : 0.0;
+    info->speedup = (double)taps / ((double)rank * (bx + by));
+
+    plan->W_lowrank = factors;
+    plan->engine = TC_ENGINE_LOWRANK;
+    free(approx);
+    free(order);
+    free(G);
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "tileconv_internal.h"
+
+// Ints per 64-byte cache line
+#define TC_LINE_INTS (TC_CACHE_LINE / (int)sizeof(int))
+
+void *tc_alloc_aligned(size_t bytes) {
+    // aligned_alloc requires the size to be a multiple of the alignment
+    size_t rounded = (bytes + TC_CACHE_LINE - 1) / TC_CACHE_LINE * TC_CACHE_LINE;
+    if (rounded == 0) rounded = TC_CACHE_LINE;
+    return aligned_alloc(TC_CACHE_LINE, rounded);
+}
+
+int tc_matrix_pitch(int width) {
+    int pitch = (width + TC_LINE_INTS - 1) / TC_LINE_INTS * TC_LINE_INTS;
+    if (pitch < TC_LINE_INTS) pitch = TC_LINE_INTS;
+
+    // Rows spaced by a multiple of 2 KB land in the same few L1 sets (and every
+    // other row shares a 4K page offset), so a kernel window spanning several
+    // rows evicts itself. One extra cache line staggers the rows across sets.
+    if ((pitch * sizeof(int)) % 2048 == 0) {
+        pitch += TC_LINE_INTS;
+    }
+    return pitch;
+}
+
+tc_matrix *tc_matrix_create(int height, int width) {
+    if (height < 1 || width < 1) return NULL;
+
+    tc_matrix *m = (tc_matrix *)malloc(sizeof(tc_matrix));
+    if (!m) return NULL;
+
+    m->height = height;
+    m->width = width;
+    m->pitch = tc_matrix_pitch(width);
+    m->data = (int *)tc_alloc_aligned((size_t)height * m->pitch * sizeof(int));
+    if (!m->data) {
+        free(m);
+        return NULL;
+    }
+    return m;
+}
+
+tc_matrix *tc_matrix_from_rows(int **rows, int height, int width) {
+    tc_matrix *m = tc_matrix_create(height, width);
+    if (!m) return NULL;
+
+    for (int i = 0; i < height; i++) {
+        memcpy(m->data + (long)i * m->pitch, rows[i], width * sizeof(int));
+    }
+    return m;
+}
+
+void tc_matrix_to_rows(const tc_matrix *m, int **rows) {
+    for (int i = 0; i < m->height; i++) {
+        memcpy(rows[i], m->data + (long)i * m->pitch, m->width * sizeof(int));
+    }
+}
+
+void tc_matrix_destroy(tc_matrix *m) {
+    if (!m) return;
+    free(m->data);
+    free(m);
+}
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "tileconv.h"
+
+struct tc_perf {
+    int fd[TC_PERF_EVENTS];     // -1 for events the kernel or CPU does not provide
+};
+
+static const char *event_names[TC_PERF_EVENTS] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"
+};
+
+const char *tc_perf_event_name(tc_perf_event event) {
+    return event_names[event];
+}
+
+#ifdef __linux__
+
+static long long cache_miss(int cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+/**
+ * Opens one user-space counter for this thread and every thread it creates
+ * afterwards (inherit), initially disabled.
+ */
+static int open_counter(int type, long long config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+tc_perf *tc_perf_open(void) {
+    tc_perf *perf = (tc_perf *)malloc(sizeof(tc_perf));
+    if (!perf) return NULL;
+
+    perf->fd[TC_PERF_CYCLES] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    perf->fd[TC_PERF_INSTRUCTIONS] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    perf->fd[TC_PERF_L1D_MISSES] = open_counter(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D));
+    perf->fd[TC_PERF_LLC_MISSES] = open_counter(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL));
+    perf->fd[TC_PERF_DTLB_MISSES] = open_counter(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB));
+    perf->fd[TC_PERF_BRANCH_MISSES] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+
+    // Without a single counter (no PMU, perf_event_paranoid, containers) there is nothing to report
+    int opened = 0;
+    for (int e = 0; e < TC_PERF_EVENTS; e++) {
+        if (perf->fd[e] >= 0) opened++;
+    }
+    if (!opened) {
+        free(perf);
+        return NULL;
+    }
+    return perf;
+}
+
+void tc_perf_start(tc_perf *perf) {
+    for (int e = 0; e < TC_PERF_EVENTS; e++) {
+        if (perf->fd[e] < 0) continue;
+        ioctl(perf->fd[e], PERF_EVENT_IOC_RESET, 0);
+        ioctl(perf->fd[e], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void tc_perf_stop(tc_perf *perf, tc_perf_counts *counts) {
+    for (int e = 0; e < TC_PERF_EVENTS; e++) {
+        long long value = 0;
+        counts->available[e] = 0;
+        counts->value[e] = 0;
+        if (perf->fd[e] < 0) continue;
+        ioctl(perf->fd[e], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(perf->fd[e], &value, sizeof(value)) == (ssize_t)sizeof(value)) {
+            counts->value[e] = value;
+            counts->available[e] = 1;
+        }
+    }
+}
+
+void tc_perf_close(tc_perf *perf) {
+    if (!perf) return;
+    for (int e = 0; e < TC_PERF_EVENTS; e++) {
+        if (perf->fd[e] >= 0) close(perf->fd[e]);
+    }
+    free(perf);
+}
+
+#else
+
+tc_perf *tc_perf_open(void) {
+    return NULL;
+}
+
+void tc_perf_start(tc_perf *perf) {
+    (void)perf;
+}
+
+void tc_perf_stop(tc_perf *perf, tc_perf_counts *counts) {
+    (void)perf;
+    memset(counts, 0, sizeof(*counts));
+}
+
+void tc_perf_close(tc_perf *perf) {
+    (void)perf;
+}
+
+#endif
+
+double tc_perf_ipc(const tc_perf_counts *counts) {
+    if (!counts->available[TC_PERF_CYCLES] || !counts->available[TC_PERF_INSTRUCTIONS] ||
+        counts->value[TC_PERF_CYCLES] == 0) {
+        return -1.0;
+    }
+    return (double)counts->value[TC_PERF_INSTRUCTIONS] / counts->value[TC_PERF_CYCLES];
+}
+
+double tc_perf_per_mac(const tc_perf_counts *counts, tc_perf_event event, double macs) {
+    if (!counts->available[event] || macs <= 0) return -1.0;
+    return counts->value[event] / macs;
+}
+
+void tc_perf_print(const char *label, const tc_perf_counts *counts, double macs) {
+    printf("Counters (%s):", label);
+    if (counts->available[TC_PERF_CYCLES]) {
+        printf(" %.3gM cycles,", counts->value[TC_PERF_CYCLES] / 1e6);
+    }
+    if (counts->available[TC_PERF_INSTRUCTIONS]) {
+        printf(" %.3gM instructions,", counts->value[TC_PERF_INSTRUCTIONS] / 1e6);
+    }
+    double ipc = tc_perf_ipc(counts);
+    if (ipc >= 0) {
+        printf(" IPC %.2f", ipc);
+    } else {
+        printf(" IPC n/a");
+    }
+
+    printf(" | misses per MAC:");
+    static const tc_perf_event misses[] = {
+        TC_PERF_L1D_MISSES, TC_PERF_LLC_MISSES, TC_PERF_DTLB_MISSES, TC_PERF_BRANCH_MISSES
+    };
+    static const char *short_names[] = {"L1D", "LLC", "dTLB", "branch"};
+    for (int i = 0; i < 4; i++) {
+        double per_mac = tc_perf_per_mac(counts, misses[i], macs);
+        if (per_mac >= 0) {
+            printf(" %s %.5f", short_names[i], per_mac);
+        } else {
+            printf(" %s n/a", short_names[i]);
+        }
+    }
+    printf("\n");
+}
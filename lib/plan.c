@@ -0,0 +1,448 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tileconv_internal.h"
+
+// Default output block per axis when the caller leaves tile_A at 0
+static const int default_tile_A[3] = {256, 16, 4};
+
+void tc_options_init(tc_options *opts) {
+    memset(opts, 0, sizeof(*opts));
+}
+
+/**
+ * Clamps a requested tile size to [1, extent], substituting fallback for 0.
+ */
+static int pick_tile(int requested, int fallback, int extent) {
+    int tile = requested > 0 ? requested : fallback;
+    if (tile > extent) tile = extent;
+    if (tile < 1) tile = 1;
+    return tile;
+}
+
+/**
+ * Bounds every partial sum of the oriented kernel over inputs in [lo, hi].
+ * Each product a * w with a in [lo, hi] lies between min(lo * w, hi * w) and
+ * max(lo * w, hi * w), so summing the negative and positive extremes bounds
+ * any subset of the taps, which covers both the running sums of the engines
+ * and every finished output. Computed in 128 bits so the bound itself cannot overflow.
+ */
+static void accumulator_bounds(const int *W, long taps, int lo, int hi,
+                               __int128 *min_sum, __int128 *max_sum) {
+    __int128 low = 0, high = 0;
+    for (long k = 0; k < taps; k++) {
+        __int128 p = (__int128)lo * W[k], q = (__int128)hi * W[k];
+        __int128 p_min = p < q ? p : q, p_max = p < q ? q : p;
+        if (p_min < 0) low += p_min;
+        if (p_max > 0) high += p_max;
+    }
+    *min_sum = low;
+    *max_sum = high;
+}
+
+/**
+ * Resolves the plan's accumulator from the requested one and the declared input range.
+ */
+static void choose_accumulator(tc_plan *plan, const tc_options *opts) {
+    int declared = opts->input_min != 0 || opts->input_max != 0;
+    int int32_safe = 0, int64_safe = 0;
+    if (declared) {
+        long taps = (long)plan->size_B[0] * plan->size_B[1] * plan->size_B[2];
+        __int128 min_sum, max_sum;
+        accumulator_bounds(plan->W, taps, opts->input_min, opts->input_max, &min_sum, &max_sum);
+        int32_safe = min_sum >= INT_MIN && max_sum <= INT_MAX;
+        int64_safe = min_sum >= LLONG_MIN && max_sum <= LLONG_MAX;
+    }
+
+    plan->accum = opts->accum;
+    if (plan->accum == TC_ACCUM_AUTO) {
+        plan->accum = (!declared || int32_safe) ? TC_ACCUM_INT32 : TC_ACCUM_INT64;
+    }
+    plan->overflow_free = (plan->accum == TC_ACCUM_INT32) ? int32_safe : int64_safe;
+}
+
+/**
+ * Factors a rows x cols integer matrix as M[i][j] = u[i] * v[j] with integer
+ * u and a primitive v (entries with gcd 1). Every rank-1 integer matrix
+ * factors this way: each row is a rational multiple of the pivot row divided
+ * by its gcd, and a rational multiple of a primitive integer vector is only
+ * integral for integer multiples. The factors are verified exactly.
+ *
+ * @return 1 if M is exactly the outer product u v, 0 otherwise (also for M = 0)
+ */
+static int factor_rank1(const int *M, long rows, long cols, int *u, int *v) {
+    long pivot = 0;
+    while (pivot < rows * cols && M[pivot] == 0) pivot++;
+    if (pivot == rows * cols) return 0;
+    long r = pivot / cols, c = pivot % cols;
+
+    long long g = 0;
+    for (long j = 0; j < cols; j++) {
+        long long a = llabs(M[r * cols + j]), b = g;
+        while (b) {
+            long long t = a % b;
+            a = b;
+            b = t;
+        }
+        g = a;
+    }
+    for (long j = 0; j < cols; j++) v[j] = (int)(M[r * cols + j] / g);
+    for (long i = 0; i < rows; i++) {
+        long long factor = (long long)M[i * cols + c] / v[c];
+        if (factor < INT_MIN || factor > INT_MAX) return 0;
+        u[i] = (int)factor;
+    }
+
+    for (long i = 0; i < rows; i++) {
+        for (long j = 0; j < cols; j++) {
+            if ((long long)u[i] * v[j] != M[i * cols + j]) return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Resolves the engine of a 2D or 3D int plan. The kernel is split into one
+ * factor per axis when it is exactly separable and either the separable
+ * engine was requested or the 1D passes need fewer multiply-adds (even a
+ * 3 x 3 kernel gains, as the scratch rows stay in cache).
+ *
+ * @return 0, or -1 if memory allocation failed
+ */
+static int choose_separable(tc_plan *plan, tc_engine requested) {
+    int bx = plan->size_B[0], by = plan->size_B[1], bz = plan->size_B[2];
+    long taps = (long)bx * by * bz;
+
+    plan->engine = TC_ENGINE_DIRECT;
+    if (requested == TC_ENGINE_DIRECT || plan->accum != TC_ACCUM_INT32) return 0;
+    if (requested == TC_ENGINE_AUTO && bx + by + (bz > 1 ? bz : 0) >= taps) return 0;
+
+    // x, y and z factors followed by the y-x slice left after splitting off z
+    int *factors = (int *)malloc((bx + by + bz + (size_t)by * bx) * sizeof(int));
+    if (!factors) return -1;
+    int *W_x = factors, *W_y = W_x + bx, *W_z = W_y + by, *slice = W_z + bz;
+
+    if (!factor_rank1(plan->W, bz, (long)by * bx, W_z, slice) ||
+        !factor_rank1(slice, by, bx, W_y, W_x)) {
+        free(factors);
+        return 0;
+    }
+    // A 2D kernel has a single z factor; fold it into y so the 2D engine needs no third pass
+    if (bz == 1) {
+        for (int y = 0; y < by; y++) W_y[y] *= W_z[0];
+        W_z[0] = 1;
+    }
+    plan->W_axis[0] = W_x;
+    plan->W_axis[1] = W_y;
+    plan->W_axis[2] = W_z;
+    plan->engine = TC_ENGINE_SEPARABLE;
+    return 0;
+}
+
+/**
+ * Returns the size in bytes of one element of the given type.
+ */
+static size_t dtype_size(tc_dtype dtype) {
+    switch (dtype) {
+        case TC_FLOAT: return sizeof(float);
+        case TC_DOUBLE: return sizeof(double);
+        default: return sizeof(int);
+    }
+}
+
+tc_plan *tc_plan_create_typed(tc_op op, int dims, const int size_A[3],
+                              const void *B, const int size_B[3], tc_dtype dtype,
+                              const tc_options *opts) {
+    tc_options defaults;
+    if (!opts) {
+        tc_options_init(&defaults);
+        opts = &defaults;
+    }
+
+    if (opts->output != TC_OUTPUT_VALID && opts->output != TC_OUTPUT_SAME && opts->output != TC_OUTPUT_FULL) {
+        return NULL;
+    }
+    if (opts->boundary < TC_BOUNDARY_ZERO || opts->boundary > TC_BOUNDARY_WRAP) return NULL;
+    // 'same' and 'full' outputs exist for kernels larger than the input too
+    int stride[3], dilation[3], extent_B[3];
+    for (int axis = 0; axis < 3; axis++) {
+        if (size_B[axis] < 1 || size_A[axis] < 1) return NULL;
+        if (opts->stride[axis] < 0 || opts->dilation[axis] < 0) return NULL;
+        stride[axis] = opts->stride[axis] > 0 ? opts->stride[axis] : 1;
+        dilation[axis] = opts->dilation[axis] > 0 ? opts->dilation[axis] : 1;
+        // Input span of the dilated kernel
+        long extent = (long)dilation[axis] * (size_B[axis] - 1) + 1;
+        if (extent > INT_MAX / 2) return NULL;
+        extent_B[axis] = (int)extent;
+        if (opts->output == TC_OUTPUT_VALID && extent_B[axis] > size_A[axis]) return NULL;
+    }
+    if (opts->input_min > opts->input_max || opts->rank_tolerance < 0.0) return NULL;
+    if (opts->winograd_tile != 0 && opts->winograd_tile != 2 && opts->winograd_tile != 4) return NULL;
+
+    // When every tile is left to the library, a shape tuned earlier (tc_tune)
+    // starts with its stored tiles and engine. The database is keyed by the
+    // options that change the work and by the requested engine; tc_tune only
+    // times int plans, so float and double plans keep their own defaults.
+    int tiles_given = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        tiles_given |= opts->tile_A[axis] | opts->tile_B[axis];
+    }
+    tc_options tuned;
+    if (!tiles_given && dtype == TC_INT) {
+        tuned = *opts;
+        if (tc_tune_lookup(op, dims, size_A, size_B, &tuned)) opts = &tuned;
+    }
+
+    tc_plan *plan = (tc_plan *)calloc(1, sizeof(tc_plan));
+    if (!plan) return NULL;
+
+    plan->op = op;
+    plan->dims = dims;
+    plan->dtype = dtype;
+    plan->boundary = opts->boundary;
+    for (int axis = 0; axis < 3; axis++) {
+        plan->size_A[axis] = size_A[axis];
+        plan->size_B[axis] = size_B[axis];
+        plan->stride[axis] = stride[axis];
+        plan->dilation[axis] = dilation[axis];
+        plan->strided |= (stride[axis] != 1 || dilation[axis] != 1);
+        // The output origin sits pad samples before the input origin; taps
+        // outside A read zeros, which the engines realize by clamping. Output o
+        // of a strided plan is centered on input o * stride for 'same'.
+        int span;
+        if (opts->output == TC_OUTPUT_FULL) {
+            plan->pad[axis] = extent_B[axis] - 1;
+            span = size_A[axis] + extent_B[axis] - 1;
+        } else if (opts->output == TC_OUTPUT_SAME) {
+            plan->pad[axis] = extent_B[axis] / 2;
+            span = size_A[axis];
+        } else {
+            span = size_A[axis] - extent_B[axis] + 1;
+        }
+        plan->size_C[axis] = (span - 1) / stride[axis] + 1;
+        plan->tile_A[axis] = pick_tile(opts->tile_A[axis], default_tile_A[axis], plan->size_C[axis]);
+        plan->tile_B[axis] = pick_tile(opts->tile_B[axis], size_B[axis], size_B[axis]);
+    }
+
+    size_t element = dtype_size(dtype);
+    void *W = malloc((size_t)size_B[0] * size_B[1] * size_B[2] * element);
+    if (dtype == TC_INT) {
+        plan->W = (int *)W;
+    } else {
+        plan->W_real = W;
+    }
+
+    // 2D and 3D blocks run on the caller's pool, or on a private one when threads are requested
+    if (dims > 1 && opts->pool) {
+        plan->pool = opts->pool;
+    } else if (dims > 1 && opts->threads > 1) {
+        plan->pool = tc_pool_create(opts->threads);
+        plan->owns_pool = 1;
+    }
+    if (!W || (plan->owns_pool && !plan->pool)) {
+        tc_plan_destroy(plan);
+        return NULL;
+    }
+
+    if (dims == 2 && plan->pool && tc_pool_size(plan->pool) > 1) {
+        // Threads write disjoint column ranges of the same output rows. Starting every
+        // tile on a cache line keeps two threads from ever writing the same line of C
+        // (for 64-byte aligned rows such as tc_matrix ones).
+        int line = TC_CACHE_LINE / (int)element;
+        int tile_width = (plan->tile_A[0] + line - 1) / line * line;
+        plan->tile_A[0] = tile_width < plan->size_C[0] ? tile_width : plan->size_C[0];
+    }
+
+    int bx = size_B[0], by = size_B[1], bz = size_B[2];
+
+    // Store the kernel in correlation orientation: convolution flips every axis once here
+    // so no engine ever computes size_B - 1 - k
+    for (int z = 0; z < bz; z++) {
+        for (int y = 0; y < by; y++) {
+            for (int x = 0; x < bx; x++) {
+                int src = z * by * bx + y * bx + x;
+                int dst = src;
+                if (op == TC_CONVOLUTION) {
+                    dst = (bz - 1 - z) * by * bx + (by - 1 - y) * bx + (bx - 1 - x);
+                }
+                memcpy((char *)W + dst * element, (const char *)B + src * element, element);
+            }
+        }
+    }
+
+    // Strided and dilated plans run the direct engine's phase path, on the x
+    // taps of every kernel row grouped by input phase (see tc_phase_split)
+    if (plan->strided) {
+        int in_phases, out_phases, step;
+        tc_phase_split(plan, &in_phases, &out_phases, &step);
+        plan->W_phase = malloc((size_t)bx * by * bz * element);
+        if (!plan->W_phase) {
+            tc_plan_destroy(plan);
+            return NULL;
+        }
+        for (long row = 0; row < (long)by * bz; row++) {
+            int dst = 0;
+            for (int r = 0; r < in_phases; r++) {
+                for (int k = r; k < bx; k += in_phases, dst++) {
+                    memcpy((char *)plan->W_phase + (row * bx + dst) * element, (char *)W + (row * bx + k) * element,
+                           element);
+                }
+            }
+        }
+        plan->engine = TC_ENGINE_DIRECT;
+        plan->accum = TC_ACCUM_INT32;
+        plan->lowrank.speedup = 1.0;
+        if (dtype == TC_INT) choose_accumulator(plan, opts);
+        return plan;
+    }
+
+    // Float and double plans run the direct engine, its low-rank form when a
+    // rank tolerance is given, or Winograd or GEMM when requested; the accumulator
+    // modes only apply to int plans
+    if (dtype != TC_INT) {
+        plan->engine = TC_ENGINE_DIRECT;
+        plan->accum = TC_ACCUM_INT32;
+        plan->lowrank.speedup = 1.0;
+        if (dims == 2 && opts->rank_tolerance > 0.0 && tc_lowrank_plan(plan, opts->rank_tolerance) != 0) {
+            tc_plan_destroy(plan);
+            return NULL;
+        }
+        if (plan->engine == TC_ENGINE_DIRECT &&
+            (tc_winograd_plan(plan, opts) != 0 || tc_gemm_plan(plan, opts) != 0)) {
+            tc_plan_destroy(plan);
+            return NULL;
+        }
+        return plan;
+    }
+
+    choose_accumulator(plan, opts);
+
+    // 1D plans choose between the direct and FFT engines, 2D and 3D plans
+    // between the direct and separable ones; 2D plans may request Winograd or GEMM
+    int status;
+    if (dims == 1) {
+        plan->engine = (opts->engine == TC_ENGINE_SEPARABLE) ? TC_ENGINE_DIRECT : opts->engine;
+        status = tc_fft_plan_1d(plan);
+    } else {
+        status = choose_separable(plan, opts->engine);
+        if (status == 0 && plan->engine == TC_ENGINE_DIRECT) status = tc_winograd_plan(plan, opts);
+        if (status == 0 && plan->engine == TC_ENGINE_DIRECT) status = tc_gemm_plan(plan, opts);
+    }
+    if (status != 0) {
+        tc_plan_destroy(plan);
+        return NULL;
+    }
+
+    return plan;
+}
+
+tc_plan *tc_plan_create_1d(tc_op op, int size_A, const int *B, int size_B,
+                           const tc_options *opts) {
+    int shape_A[3] = {size_A, 1, 1};
+    int shape_B[3] = {size_B, 1, 1};
+    return tc_plan_create_typed(op, 1, shape_A, B, shape_B, TC_INT, opts);
+}
+
+tc_plan *tc_plan_create_2d(tc_op op, int height_A, int width_A,
+                           const int *B, int height_B, int width_B,
+                           const tc_options *opts) {
+    int shape_A[3] = {width_A, height_A, 1};
+    int shape_B[3] = {width_B, height_B, 1};
+    return tc_plan_create_typed(op, 2, shape_A, B, shape_B, TC_INT, opts);
+}
+
+tc_plan *tc_plan_create_3d(tc_op op, int size_A_x, int size_A_y, int size_A_z,
+                           const int *B, int size_B_x, int size_B_y, int size_B_z,
+                           const tc_options *opts) {
+    int shape_A[3] = {size_A_x, size_A_y, size_A_z};
+    int shape_B[3] = {size_B_x, size_B_y, size_B_z};
+    return tc_plan_create_typed(op, 3, shape_A, B, shape_B, TC_INT, opts);
+}
+
+/**
+ * Runs the plan's engine, writing int outputs to C or exact 64-bit sums to C64.
+ */
+static void execute(const tc_plan *plan, const int *A, int *C, long long *C64) {
+    switch (plan->dims) {
+        case 1:
+            if (plan->engine == TC_ENGINE_FFT) {
+                tc_fft_execute_1d(plan, A, C, C64);
+            } else {
+                tc_direct_range_1d(plan, A, C, C64, 0, plan->size_C[0]);
+            }
+            break;
+        case 2:
+            tc_direct_2d(plan, A, plan->size_A[0], C, C64, plan->size_C[0]);
+            break;
+        default:
+            tc_direct_3d(plan, A, plan->size_A[0], (long)plan->size_A[0] * plan->size_A[1],
+                         C, C64, plan->size_C[0], (long)plan->size_C[0] * plan->size_C[1]);
+            break;
+    }
+}
+
+void tc_execute(const tc_plan *plan, const int *A, int *C) {
+    if (plan->dtype != TC_INT) return;
+    execute(plan, A, C, NULL);
+}
+
+void tc_execute_i64(const tc_plan *plan, const int *A, long long *C) {
+    if (plan->dtype != TC_INT) return;
+    execute(plan, A, NULL, C);
+}
+
+int tc_execute_2d(const tc_plan *plan, const tc_matrix *A, tc_matrix *C) {
+    if (plan->dims != 2 || plan->dtype != TC_INT) return -1;
+    if (A->height != plan->size_A[1] || A->width != plan->size_A[0]) return -1;
+    if (C->height != plan->size_C[1] || C->width != plan->size_C[0]) return -1;
+
+    tc_direct_2d(plan, A->data, A->pitch, C->data, NULL, C->pitch);
+    return 0;
+}
+
+tc_engine tc_plan_engine(const tc_plan *plan) {
+    return plan->engine;
+}
+
+tc_dtype tc_plan_dtype(const tc_plan *plan) {
+    return plan->dtype;
+}
+
+tc_accum tc_plan_accum(const tc_plan *plan) {
+    return plan->accum;
+}
+
+int tc_plan_overflow_free(const tc_plan *plan) {
+    return plan->overflow_free;
+}
+
+void tc_plan_lowrank(const tc_plan *plan, tc_lowrank_info *info) {
+    *info = plan->lowrank;
+}
+
+int tc_plan_output_size(const tc_plan *plan, int axis) {
+    return plan->size_C[axis];
+}
+
+long tc_plan_output_count(const tc_plan *plan) {
+    return (long)plan->size_C[0] * plan->size_C[1] * plan->size_C[2];
+}
+
+tc_pool *tc_plan_pool(const tc_plan *plan) {
+    return plan->pool;
+}
+
+void tc_plan_destroy(tc_plan *plan) {
+    if (!plan) return;
+    if (plan->owns_pool) tc_pool_destroy(plan->pool);
+    tc_fft_plan_free(plan);
+    free(plan->W);
+    free(plan->W_real);
+    free(plan->W_axis[0]);
+    free(plan->W_lowrank);
+    free(plan->W_winograd);
+    free(plan->W_gemm);
+    free(plan->W_phase);
+    free(plan);
+}
@@ -0,0 +1,260 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tileconv_internal.h"
+
+/**
+ * Per-worker deque of task indices. The tasks of one run are integers, so a
+ * deque is simply the index range [top, bottom): the owner pops from the
+ * bottom, which keeps it walking through neighbouring blocks, and thieves take
+ * from the top. Each worker sits on its own cache line so that the owner's
+ * pops never invalidate another worker's deque or counters.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    int top;
+    int bottom;
+
+    // Statistics, written only by the owning worker
+    double busy;
+    long tasks;
+    long steals;
+} __attribute__((aligned(TC_CACHE_LINE))) pool_worker;
+
+struct tc_pool {
+    int size;
+    pool_worker *workers;
+    pthread_t *threads;         // size - 1 threads; the caller of tc_pool_run is worker 0
+
+    pthread_mutex_t lock;       // Protects everything below
+    pthread_cond_t start;
+    pthread_cond_t done;
+    pthread_mutex_t run_lock;   // Serializes concurrent tc_pool_run calls
+    long generation;            // Incremented once per run
+    int active;                 // Workers that have not finished the current run
+    int shutdown;
+    void (*fn)(void *ctx, int index);
+    void *ctx;
+
+    double elapsed;             // Total wall time spent in tc_pool_run
+};
+
+/**
+ * Pops the next task from the bottom of worker's own deque.
+ *
+ * @return The task index, or -1 if the deque is empty
+ */
+static int pop_own(pool_worker *worker) {
+    int index = -1;
+    pthread_mutex_lock(&worker->lock);
+    if (worker->top < worker->bottom) {
+        index = --worker->bottom;
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return index;
+}
+
+/**
+ * Steals half of the first non-empty victim deque into worker self's own
+ * (empty) deque. Taking half rather than one task means a thief rarely has to
+ * come back, and the stolen blocks stay contiguous.
+ *
+ * @return 1 if anything was stolen, 0 if every deque is empty
+ */
+static int steal(tc_pool *pool, int self) {
+    for (int offset = 1; offset < pool->size; offset++) {
+        pool_worker *victim = &pool->workers[(self + offset) % pool->size];
+        pthread_mutex_lock(&victim->lock);
+        int available = victim->bottom - victim->top;
+        if (available > 0) {
+            int take = (available + 1) / 2;
+            int first = victim->top;
+            victim->top += take;
+            pthread_mutex_unlock(&victim->lock);
+
+            pool_worker *own = &pool->workers[self];
+            pthread_mutex_lock(&own->lock);
+            own->top = first;
+            own->bottom = first + take;
+            pthread_mutex_unlock(&own->lock);
+            own->steals++;
+            return 1;
+        }
+        pthread_mutex_unlock(&victim->lock);
+    }
+    return 0;
+}
+
+/**
+ * Runs tasks until no deque has any left. Tasks are never added during a run,
+ * so once every deque is empty the worker can stop; tasks a thief is moving
+ * between deques are executed by that thief.
+ */
+static void work(tc_pool *pool, int self) {
+    pool_worker *own = &pool->workers[self];
+    for (;;) {
+        int index = pop_own(own);
+        if (index < 0) {
+            if (!steal(pool, self)) break;
+            continue;
+        }
+        double start = tc_now();
+        pool->fn(pool->ctx, index);
+        own->busy += tc_now() - start;
+        own->tasks++;
+    }
+}
+
+typedef struct {
+    tc_pool *pool;
+    int self;
+} worker_arg;
+
+static void *worker_main(void *arg) {
+    worker_arg *wa = (worker_arg *)arg;
+    tc_pool *pool = wa->pool;
+    int self = wa->self;
+    free(wa);
+
+    long seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen && !pool->shutdown) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->shutdown) break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        work(pool, self);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+tc_pool *tc_pool_create(int threads) {
+    if (threads < 1) threads = 1;
+
+    tc_pool *pool = (tc_pool *)calloc(1, sizeof(tc_pool));
+    if (!pool) return NULL;
+
+    pool->workers = (pool_worker *)tc_alloc_aligned((size_t)threads * sizeof(pool_worker));
+    pool->threads = (pthread_t *)malloc((size_t)threads * sizeof(pthread_t));
+    if (!pool->workers || !pool->threads) {
+        free(pool->workers);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+    memset(pool->workers, 0, (size_t)threads * sizeof(pool_worker));
+    for (int w = 0; w < threads; w++) {
+        pthread_mutex_init(&pool->workers[w].lock, NULL);
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_mutex_init(&pool->run_lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    // Worker 0 is whichever thread calls tc_pool_run; a pool that cannot start
+    // all its threads simply runs with fewer workers
+    pool->size = 1;
+    for (int w = 1; w < threads; w++) {
+        worker_arg *wa = (worker_arg *)malloc(sizeof(worker_arg));
+        if (!wa) break;
+        wa->pool = pool;
+        wa->self = w;
+        if (pthread_create(&pool->threads[w], NULL, worker_main, wa) != 0) {
+            free(wa);
+            break;
+        }
+        pool->size++;
+    }
+
+    return pool;
+}
+
+void tc_pool_destroy(tc_pool *pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (int w = 1; w < pool->size; w++) {
+        pthread_join(pool->threads[w], NULL);
+    }
+
+    for (int w = 0; w < pool->size; w++) {
+        pthread_mutex_destroy(&pool->workers[w].lock);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->run_lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    free(pool->workers);
+    free(pool->threads);
+    free(pool);
+}
+
+int tc_pool_size(const tc_pool *pool) {
+    return pool->size;
+}
+
+void tc_pool_run(tc_pool *pool, int count, void (*fn)(void *ctx, int index), void *ctx) {
+    if (count <= 0) return;
+
+    pthread_mutex_lock(&pool->run_lock);
+    double start = tc_now();
+
+    // Deal the tasks out as contiguous ranges so each worker starts on
+    // neighbouring blocks; stealing evens out whatever the split gets wrong
+    for (int w = 0; w < pool->size; w++) {
+        pool->workers[w].top = (int)((long)count * w / pool->size);
+        pool->workers[w].bottom = (int)((long)count * (w + 1) / pool->size);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->active = pool->size - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    work(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    pool->elapsed += tc_now() - start;
+    pthread_mutex_unlock(&pool->run_lock);
+}
+
+void tc_pool_stats(const tc_pool *pool, int worker, tc_pool_worker_stats *stats) {
+    const pool_worker *w = &pool->workers[worker];
+    stats->busy_seconds = w->busy;
+    stats->elapsed_seconds = pool->elapsed;
+    stats->utilization = pool->elapsed > 0 ? w->busy / pool->elapsed : 0.0;
+    stats->tasks = w->tasks;
+    stats->steals = w->steals;
+}
+
+void tc_pool_reset_stats(tc_pool *pool) {
+    pthread_mutex_lock(&pool->run_lock);
+    for (int w = 0; w < pool->size; w++) {
+        pool->workers[w].busy = 0.0;
+        pool->workers[w].tasks = 0;
+        pool->workers[w].steals = 0;
+    }
+    pool->elapsed = 0.0;
+    pthread_mutex_unlock(&pool->run_lock);
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TC_X86 1
+#endif
+
+#include "tileconv_internal.h"
+
+/*
+ * Float and double engines, both generated from real_engine.h. Each type
+ * supplies its element type, name suffix and the vector operations of its
+ * FMA kernels.
+ */
+
+#define REAL float
+#define RS(name) name##_f
+#define REAL_DTYPE TC_FLOAT
+#define V2_T __m256
+#define V2_LANES 8
+#define V2_ZERO _mm256_setzero_ps
+#define V2_LOAD _mm256_loadu_ps
+#define V2_STORE _mm256_storeu_ps
+#define V2_SET1 _mm256_set1_ps
+#define V2_FMA _mm256_fmadd_ps
+#define V5_T __m512
+#define V5_LANES 16
+#define V5_MASK_T __mmask16
+#define V5_ZERO _mm512_setzero_ps
+#define V5_LOAD _mm512_loadu_ps
+#define V5_STORE _mm512_storeu_ps
+#define V5_SET1 _mm512_set1_ps
+#define V5_FMA _mm512_fmadd_ps
+#define V5_MASKZ_LOAD _mm512_maskz_loadu_ps
+#define V5_MASK_STORE _mm512_mask_storeu_ps
+#include "real_engine.h"
+#undef REAL
+#undef RS
+#undef REAL_DTYPE
+#undef V2_T
+#undef V2_LANES
+#undef V2_ZERO
+#undef V2_LOAD
+#undef V2_STORE
+#undef V2_SET1
+#undef V2_FMA
+#undef V5_T
+#undef V5_LANES
+#undef V5_MASK_T
+#undef V5_ZERO
+#undef V5_LOAD
+#undef V5_STORE
+#undef V5_SET1
+#undef V5_FMA
+#undef V5_MASKZ_LOAD
+#undef V5_MASK_STORE
+
+#define REAL double
+#define RS(name) name##_d
+#define REAL_DTYPE TC_DOUBLE
+#define V2_T __m256d
+#define V2_LANES 4
+#define V2_ZERO _mm256_setzero_pd
+#define V2_LOAD _mm256_loadu_pd
+#define V2_STORE _mm256_storeu_pd
+#define V2_SET1 _mm256_set1_pd
+#define V2_FMA _mm256_fmadd_pd
+#define V5_T __m512d
+#define V5_LANES 8
+#define V5_MASK_T __mmask8
+#define V5_ZERO _mm512_setzero_pd
+#define V5_LOAD _mm512_loadu_pd
+#define V5_STORE _mm512_storeu_pd
+#define V5_SET1 _mm512_set1_pd
+#define V5_FMA _mm512_fmadd_pd
+#define V5_MASKZ_LOAD _mm512_maskz_loadu_pd
+#define V5_MASK_STORE _mm512_mask_storeu_pd
+#include "real_engine.h"
+
+void tc_real_select_kernels(const char *isa) {
+    select_row_kernel_f(isa);
+    select_row_kernel_d(isa);
+}
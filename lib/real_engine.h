@@ -0,0 +1,966 @@
+/*
+ * Type-generic float / double engines. There is deliberately no include
+ * guard: real.c includes this file once per element type after defining
+ *
+ *   REAL            the element type (float or double)
+ *   RS(name)        name with the type suffix (name##_f or name##_d)
+ *   REAL_DTYPE      TC_FLOAT or TC_DOUBLE
+ *   V2_* / V5_*     AVX2 + FMA and AVX-512 vector operations on REAL
+ *
+ * so the row kernels, the tiled engines, the plan entry points and the naive
+ * and one-shot tiled functions of both types come from this one source. The
+ * structure mirrors the int engines in direct.c and compat.c: the same output
+ * blocks, kernel tiles, interior / boundary split and pool tasks. The boundary
+ * points, halo gathers and phase split and merge are shared with the int
+ * engine through halo_engine.h.
+ */
+
+/**
+ * Portable row kernel: c[j] = (first ? 0 : c[j]) + sum_k a[j + k] * w[k].
+ */
+static void RS(row_correlate_scalar)(REAL *c, const REAL *a, const REAL *w, int taps, int n, int first) {
+    int k = 0;
+    if (first) {
+        REAL w0 = w[0];
+        for (int j = 0; j < n; j++) {
+            c[j] = a[j] * w0;
+        }
+        k = 1;
+    }
+    for (; k < taps; k++) {
+        const REAL *a_k = a + k;
+        REAL w_k = w[k];
+        for (int j = 0; j < n; j++) {
+            c[j] += a_k[j] * w_k;
+        }
+    }
+}
+
+/**
+ * Portable column kernel: c[j] = (first ? 0 : c[j]) + sum_k t[k * pitch + j] * w[k].
+ */
+static void RS(column_correlate_scalar)(REAL *c, const REAL *t, long pitch, const REAL *w, int taps, int n,
+                                        int first) {
+    int k = 0;
+    if (first) {
+        REAL w0 = w[0];
+        for (int j = 0; j < n; j++) {
+            c[j] = t[j] * w0;
+        }
+        k = 1;
+    }
+    for (; k < taps; k++) {
+        const REAL *t_k = t + k * pitch;
+        REAL w_k = w[k];
+        for (int j = 0; j < n; j++) {
+            c[j] += t_k[j] * w_k;
+        }
+    }
+}
+
+#ifdef TC_X86
+
+/**
+ * AVX2 row kernel. Four accumulators stay in registers while every tap is
+ * broadcast and fused-multiply-added against the shifted input.
+ */
+__attribute__((target("avx2,fma")))
+static void RS(row_correlate_avx2)(REAL *c, const REAL *a, const REAL *w, int taps, int n, int first) {
+    int j = 0;
+    for (; j + 4 * V2_LANES <= n; j += 4 * V2_LANES) {
+        V2_T acc0, acc1, acc2, acc3;
+        if (first) {
+            acc0 = acc1 = acc2 = acc3 = V2_ZERO();
+        } else {
+            acc0 = V2_LOAD(c + j);
+            acc1 = V2_LOAD(c + j + V2_LANES);
+            acc2 = V2_LOAD(c + j + 2 * V2_LANES);
+            acc3 = V2_LOAD(c + j + 3 * V2_LANES);
+        }
+        const REAL *a_j = a + j;
+        for (int k = 0; k < taps; k++) {
+            V2_T w_k = V2_SET1(w[k]);
+            const REAL *a_k = a_j + k;
+            acc0 = V2_FMA(V2_LOAD(a_k), w_k, acc0);
+            acc1 = V2_FMA(V2_LOAD(a_k + V2_LANES), w_k, acc1);
+            acc2 = V2_FMA(V2_LOAD(a_k + 2 * V2_LANES), w_k, acc2);
+            acc3 = V2_FMA(V2_LOAD(a_k + 3 * V2_LANES), w_k, acc3);
+        }
+        V2_STORE(c + j, acc0);
+        V2_STORE(c + j + V2_LANES, acc1);
+        V2_STORE(c + j + 2 * V2_LANES, acc2);
+        V2_STORE(c + j + 3 * V2_LANES, acc3);
+    }
+    for (; j + V2_LANES <= n; j += V2_LANES) {
+        V2_T acc = first ? V2_ZERO() : V2_LOAD(c + j);
+        for (int k = 0; k < taps; k++) {
+            acc = V2_FMA(V2_LOAD(a + j + k), V2_SET1(w[k]), acc);
+        }
+        V2_STORE(c + j, acc);
+    }
+    for (; j < n; j++) {
+        REAL sum = first ? 0 : c[j];
+        for (int k = 0; k < taps; k++) {
+            sum += a[j + k] * w[k];
+        }
+        c[j] = sum;
+    }
+}
+
+/**
+ * AVX-512 row kernel. Four accumulators per pass; the tail uses masked loads
+ * and stores instead of a scalar loop.
+ */
+__attribute__((target("avx512f")))
+static void RS(row_correlate_avx512)(REAL *c, const REAL *a, const REAL *w, int taps, int n, int first) {
+    int j = 0;
+    for (; j + 4 * V5_LANES <= n; j += 4 * V5_LANES) {
+        V5_T acc0, acc1, acc2, acc3;
+        if (first) {
+            acc0 = acc1 = acc2 = acc3 = V5_ZERO();
+        } else {
+            acc0 = V5_LOAD(c + j);
+            acc1 = V5_LOAD(c + j + V5_LANES);
+            acc2 = V5_LOAD(c + j + 2 * V5_LANES);
+            acc3 = V5_LOAD(c + j + 3 * V5_LANES);
+        }
+        const REAL *a_j = a + j;
+        for (int k = 0; k < taps; k++) {
+            V5_T w_k = V5_SET1(w[k]);
+            const REAL *a_k = a_j + k;
+            acc0 = V5_FMA(V5_LOAD(a_k), w_k, acc0);
+            acc1 = V5_FMA(V5_LOAD(a_k + V5_LANES), w_k, acc1);
+            acc2 = V5_FMA(V5_LOAD(a_k + 2 * V5_LANES), w_k, acc2);
+            acc3 = V5_FMA(V5_LOAD(a_k + 3 * V5_LANES), w_k, acc3);
+        }
+        V5_STORE(c + j, acc0);
+        V5_STORE(c + j + V5_LANES, acc1);
+        V5_STORE(c + j + 2 * V5_LANES, acc2);
+        V5_STORE(c + j + 3 * V5_LANES, acc3);
+    }
+    while (j < n) {
+        int lanes = (n - j < V5_LANES) ? n - j : V5_LANES;
+        V5_MASK_T mask = (V5_MASK_T)((1u << lanes) - 1);
+        V5_T acc = first ? V5_ZERO() : V5_MASKZ_LOAD(mask, c + j);
+        for (int k = 0; k < taps; k++) {
+            acc = V5_FMA(V5_MASKZ_LOAD(mask, a + j + k), V5_SET1(w[k]), acc);
+        }
+        V5_MASK_STORE(c + j, mask, acc);
+        j += lanes;
+    }
+}
+
+/**
+ * AVX2 column kernel: the row kernel's register blocking, with tap k reading
+ * row k of t instead of a shifted window.
+ */
+__attribute__((target("avx2,fma")))
+static void RS(column_correlate_avx2)(REAL *c, const REAL *t, long pitch, const REAL *w, int taps, int n,
+                                      int first) {
+    int j = 0;
+    for (; j + 4 * V2_LANES <= n; j += 4 * V2_LANES) {
+        V2_T acc0, acc1, acc2, acc3;
+        if (first) {
+            acc0 = acc1 = acc2 = acc3 = V2_ZERO();
+        } else {
+            acc0 = V2_LOAD(c + j);
+            acc1 = V2_LOAD(c + j + V2_LANES);
+            acc2 = V2_LOAD(c + j + 2 * V2_LANES);
+            acc3 = V2_LOAD(c + j + 3 * V2_LANES);
+        }
+        const REAL *t_k = t + j;
+        for (int k = 0; k < taps; k++) {
+            V2_T w_k = V2_SET1(w[k]);
+            acc0 = V2_FMA(V2_LOAD(t_k), w_k, acc0);
+            acc1 = V2_FMA(V2_LOAD(t_k + V2_LANES), w_k, acc1);
+            acc2 = V2_FMA(V2_LOAD(t_k + 2 * V2_LANES), w_k, acc2);
+            acc3 = V2_FMA(V2_LOAD(t_k + 3 * V2_LANES), w_k, acc3);
+            t_k += pitch;
+        }
+        V2_STORE(c + j, acc0);
+        V2_STORE(c + j + V2_LANES, acc1);
+        V2_STORE(c + j + 2 * V2_LANES, acc2);
+        V2_STORE(c + j + 3 * V2_LANES, acc3);
+    }
+    for (; j + V2_LANES <= n; j += V2_LANES) {
+        V2_T acc = first ? V2_ZERO() : V2_LOAD(c + j);
+        for (int k = 0; k < taps; k++) {
+            acc = V2_FMA(V2_LOAD(t + k * pitch + j), V2_SET1(w[k]), acc);
+        }
+        V2_STORE(c + j, acc);
+    }
+    for (; j < n; j++) {
+        REAL sum = first ? 0 : c[j];
+        for (int k = 0; k < taps; k++) {
+            sum += t[k * pitch + j] * w[k];
+        }
+        c[j] = sum;
+    }
+}
+
+/**
+ * AVX-512 column kernel with a masked tail.
+ */
+__attribute__((target("avx512f")))
+static void RS(column_correlate_avx512)(REAL *c, const REAL *t, long pitch, const REAL *w, int taps, int n,
+                                        int first) {
+    int j = 0;
+    for (; j + 4 * V5_LANES <= n; j += 4 * V5_LANES) {
+        V5_T acc0, acc1, acc2, acc3;
+        if (first) {
+            acc0 = acc1 = acc2 = acc3 = V5_ZERO();
+        } else {
+            acc0 = V5_LOAD(c + j);
+            acc1 = V5_LOAD(c + j + V5_LANES);
+            acc2 = V5_LOAD(c + j + 2 * V5_LANES);
+            acc3 = V5_LOAD(c + j + 3 * V5_LANES);
+        }
+        const REAL *t_k = t + j;
+        for (int k = 0; k < taps; k++) {
+            V5_T w_k = V5_SET1(w[k]);
+            acc0 = V5_FMA(V5_LOAD(t_k), w_k, acc0);
+            acc1 = V5_FMA(V5_LOAD(t_k + V5_LANES), w_k, acc1);
+            acc2 = V5_FMA(V5_LOAD(t_k + 2 * V5_LANES), w_k, acc2);
+            acc3 = V5_FMA(V5_LOAD(t_k + 3 * V5_LANES), w_k, acc3);
+            t_k += pitch;
+        }
+        V5_STORE(c + j, acc0);
+        V5_STORE(c + j + V5_LANES, acc1);
+        V5_STORE(c + j + 2 * V5_LANES, acc2);
+        V5_STORE(c + j + 3 * V5_LANES, acc3);
+    }
+    while (j < n) {
+        int lanes = (n - j < V5_LANES) ? n - j : V5_LANES;
+        V5_MASK_T mask = (V5_MASK_T)((1u << lanes) - 1);
+        V5_T acc = first ? V5_ZERO() : V5_MASKZ_LOAD(mask, c + j);
+        for (int k = 0; k < taps; k++) {
+            acc = V5_FMA(V5_MASKZ_LOAD(mask, t + k * pitch + j), V5_SET1(w[k]), acc);
+        }
+        V5_MASK_STORE(c + j, mask, acc);
+        j += lanes;
+    }
+}
+
+#endif
+
+static void (*RS(row_correlate))(REAL *c, const REAL *a, const REAL *w, int taps, int n, int first) =
+    RS(row_correlate_scalar);
+static void (*RS(column_correlate))(REAL *c, const REAL *t, long pitch, const REAL *w, int taps, int n,
+                                    int first) = RS(column_correlate_scalar);
+
+/**
+ * Points the row and column kernels at the given ISA ("scalar", "avx2" or
+ * "avx512"). The AVX2 kernels also need FMA.
+ */
+static void RS(select_row_kernel)(const char *isa) {
+    RS(row_correlate) = RS(row_correlate_scalar);
+    RS(column_correlate) = RS(column_correlate_scalar);
+#ifdef TC_X86
+    if (strcmp(isa, "avx512") == 0) {
+        RS(row_correlate) = RS(row_correlate_avx512);
+        RS(column_correlate) = RS(column_correlate_avx512);
+    } else if (strcmp(isa, "avx2") == 0 && __builtin_cpu_supports("fma")) {
+        RS(row_correlate) = RS(row_correlate_avx2);
+        RS(column_correlate) = RS(column_correlate_avx2);
+    }
+#endif
+}
+
+#define ELEM REAL
+#define ACC REAL
+#define ES(name) RS(name)
+#define ELEM_W(plan) ((const REAL *)(plan)->W_real)
+#include "halo_engine.h"
+#undef ELEM
+#undef ACC
+#undef ES
+#undef ELEM_W
+
+/**
+ * Computes outputs [x0, x1) of row (y, z) in the halo with the row kernels:
+ * one call per chunk of outputs and kernel row that reads A (the remapped
+ * input row under an extended boundary), on an input run gathered into a
+ * stack buffer where it leaves A along x. The kernel must be narrower than
+ * TC_HALO_CHUNK / 2 unless the outputs are inside along x.
+ */
+static void RS(halo_span)(const tc_plan *plan, const REAL *A, long row_A, long slice_A,
+                          REAL *C, long row_C, long slice_C, int x0, int x1, int y, int z) {
+    int size_B_x = plan->size_B[0], size_B_y = plan->size_B[1], size_B_z = plan->size_B[2];
+    REAL *C_row = C + z * slice_C + y * row_C;
+    REAL ext[TC_HALO_CHUNK];
+    int chunk = TC_HALO_CHUNK / 2;
+
+    for (int j0 = x0; j0 < x1; j0 += chunk) {
+        int m = x1 - j0 < chunk ? x1 - j0 : chunk;
+        int first = 1;
+        for (int kz = 0; kz < size_B_z; kz++) {
+            for (int ky = 0; ky < size_B_y; ky++) {
+                const REAL *a = RS(halo_row)(plan, A, row_A, slice_A, y, z, ky, kz);
+                if (!a) continue;
+                a = RS(halo_samples)(plan, a, j0 - plan->pad[0], m + size_B_x - 1, ext);
+                RS(row_correlate)(C_row + j0, a, (const REAL *)plan->W_real + ((long)kz * size_B_y + ky) * size_B_x,
+                                  size_B_x, m, first);
+                first = 0;
+            }
+        }
+        if (first) {
+            for (int j = 0; j < m; j++) C_row[j0 + j] = 0;
+        }
+    }
+}
+
+/**
+ * Computes outputs [x0, x1) of row (y, z), all of whose footprints cross the
+ * input boundary: the outputs tc_halo_split picks through halo_span, the rest
+ * one clamped point at a time.
+ */
+static void RS(boundary_row)(const tc_plan *plan, const REAL *A, long row_A, long slice_A,
+                             REAL *C, long row_C, long slice_C, int x0, int x1, int y, int z) {
+    if (x0 >= x1) return;
+    int sx0, sx1;
+    if (tc_halo_split(plan, x0, x1, &sx0, &sx1)) {
+        RS(halo_span)(plan, A, row_A, slice_A, C, row_C, slice_C, sx0, sx1, y, z);
+        RS(boundary_row)(plan, A, row_A, slice_A, C, row_C, slice_C, x0, sx0, y, z);
+        RS(boundary_row)(plan, A, row_A, slice_A, C, row_C, slice_C, sx1, x1, y, z);
+        return;
+    }
+
+    long row = z * slice_C + y * row_C;
+    for (int x = x0; x < x1; x++) {
+        C[row + x] = RS(boundary_point)(plan, A, row_A, slice_A, x, y, z);
+    }
+}
+
+/**
+ * Tiled 1D engine: blocks of tile_A outputs, each swept by kernel tiles of tile_B taps.
+ */
+void RS(tc_direct_1d)(const tc_plan *plan, const REAL *A, REAL *C, int size_C) {
+    int size_B = plan->size_B[0];
+    int tile_A = plan->tile_A[0];
+    int tile_B = plan->tile_B[0];
+    const REAL *W = (const REAL *)plan->W_real;
+
+    for (int j_start = 0; j_start < size_C; j_start += tile_A) {
+        int j_end = (j_start + tile_A < size_C) ? j_start + tile_A : size_C;
+        for (int k_start = 0; k_start < size_B; k_start += tile_B) {
+            int k_end = (k_start + tile_B < size_B) ? k_start + tile_B : size_B;
+            RS(row_correlate)(C + j_start, A + j_start + k_start, W + k_start,
+                              k_end - k_start, j_end - j_start, k_start == 0);
+        }
+    }
+}
+
+/**
+ * Phase path of strided and dilated plans (see phase_box in direct.c):
+ * outputs [x0, x1) x [y0, y1) x [z0, z1), halo included. The input rows of
+ * up to TC_PHASE_ROWS output rows are split into their phases once, then each
+ * output row makes one row kernel call per output phase, kernel row and input
+ * phase on contiguous runs and interleaves the output phases into C.
+ */
+static void RS(phase_box)(const tc_plan *plan, const REAL *A, long row_A, long slice_A,
+                          REAL *C, long row_C, long slice_C, int x0, int x1, int y0, int y1, int z0, int z1) {
+    int size_B_x = plan->size_B[0], size_B_y = plan->size_B[1], size_B_z = plan->size_B[2];
+    tc_phase_layout layout;
+    tc_phase_layout_init(plan, x1 - x0, y1 - y0, &layout);
+    int in_phases = layout.in_phases, out_phases = layout.out_phases, m_max = layout.m_max;
+
+    REAL *G = (REAL *)malloc((size_t)tc_phase_scratch(&layout) * sizeof(REAL));
+    const REAL **row_G = (const REAL **)malloc(layout.rows * sizeof(REAL *));
+    if (!G || !row_G) {
+        free(G);
+        free(row_G);
+        for (int z = z0; z < z1; z++) {
+            for (int y = y0; y < y1; y++) {
+                for (int x = x0; x < x1; x++) {
+                    C[z * slice_C + y * row_C + x] = RS(phase_point)(plan, A, row_A, slice_A, x, y, z);
+                }
+            }
+        }
+        return;
+    }
+    REAL *ext = G + layout.rows * layout.step * layout.len;
+    REAL *T = ext + layout.span;
+
+    for (int z = z0; z < z1; z++) {
+        for (int yc = y0; yc < y1; yc += TC_PHASE_ROWS) {
+            int yc1 = yc + TC_PHASE_ROWS < y1 ? yc + TC_PHASE_ROWS : y1;
+            int ny = tc_phase_rows(plan, yc1 - yc);
+
+            for (int c0 = x0; c0 < x1; c0 += layout.chunk) {
+                int n = x1 - c0 < layout.chunk ? x1 - c0 : layout.chunk;
+                RS(phase_fill)(plan, &layout, A, row_A, slice_A, c0, n, yc, ny, z, G, row_G, ext);
+
+                for (int y = yc; y < yc1; y++) {
+                    long row = z * slice_C + y * row_C + c0;
+                    for (int p = 0; p < out_phases && p < n; p++) {
+                        int m = (n - p + out_phases - 1) / out_phases;
+                        REAL *dst = out_phases == 1 ? C + row : T + (long)p * m_max;
+                        int first = 1;
+                        for (int kz = 0; kz < size_B_z; kz++) {
+                            for (int ky = 0; ky < size_B_y; ky++) {
+                                const REAL *g = row_G[tc_phase_fill_row(plan, ny, y - yc, ky, kz)];
+                                if (!g) continue;
+                                const REAL *w = (const REAL *)plan->W_phase + ((long)kz * size_B_y + ky) * size_B_x;
+                                for (int r = 0; r < in_phases && r < size_B_x; r++) {
+                                    int taps = tc_phase_taps(plan, &layout, r);
+                                    RS(row_correlate)(dst, g + tc_phase_run(plan, &layout, p, r), w, taps, m, first);
+                                    first = 0;
+                                    w += taps;
+                                }
+                            }
+                        }
+                        if (first) {
+                            for (int j = 0; j < m; j++) dst[j] = 0;
+                        }
+                    }
+                    if (out_phases > 1) RS(phase_merge)(T, m_max, out_phases, n, C + row);
+                }
+            }
+        }
+    }
+    free(G);
+    free(row_G);
+}
+
+/**
+ * Computes outputs [x0, x1) of a 1D plan: the interior on the tiled engine,
+ * the halo through boundary_row.
+ */
+static void RS(direct_range_1d)(const tc_plan *plan, const REAL *A, REAL *C, int x0, int x1) {
+    if (plan->strided) {
+        RS(phase_box)(plan, A, 0, 0, C, 0, 0, x0, x1, 0, 1, 0, 1);
+        return;
+    }
+    int lo[3], hi[3];
+    tc_interior_range(plan, lo, hi);
+    int ix0 = x0 > lo[0] ? x0 : lo[0], ix1 = x1 < hi[0] ? x1 : hi[0];
+    if (ix0 >= ix1) {
+        RS(boundary_row)(plan, A, 0, 0, C, 0, 0, x0, x1, 0, 0);
+        return;
+    }
+    RS(boundary_row)(plan, A, 0, 0, C, 0, 0, x0, ix0, 0, 0);
+    RS(tc_direct_1d)(plan, A + (ix0 - plan->pad[0]), C + ix0, ix1 - ix0);
+    RS(boundary_row)(plan, A, 0, 0, C, 0, 0, ix1, x1, 0, 0);
+}
+
+/**
+ * Low-rank path of a 2D tile: for each kernel component, a row pass with its
+ * x factor over the input rows the tile needs, into a scratch block, then a
+ * column pass with its y factor that accumulates into the tile of C.
+ *
+ * @return 0, or -1 if the scratch block could not be allocated (the caller
+ *         then applies the exact kernel)
+ */
+static int RS(lowrank_tile_2d)(const tc_plan *plan, const REAL *A, long pitch_A, REAL *C, long pitch_C,
+                               int i_tile, int j_tile, int height, int width) {
+    int width_B = plan->size_B[0], height_B = plan->size_B[1];
+    int rows = height + height_B - 1;
+    REAL *T = (REAL *)malloc((size_t)rows * width * sizeof(REAL));
+    if (!T) return -1;
+
+    const REAL *factors = (const REAL *)plan->W_lowrank;
+    for (int q = 0; q < plan->lowrank.rank; q++) {
+        const REAL *W_x = factors + (long)q * (width_B + height_B);
+        const REAL *W_y = W_x + width_B;
+        for (int r = 0; r < rows; r++) {
+            RS(row_correlate)(T + (long)r * width, A + (i_tile + r) * pitch_A + j_tile, W_x, width_B, width, 1);
+        }
+        for (int i = 0; i < height; i++) {
+            RS(column_correlate)(C + (i_tile + i) * pitch_C + j_tile, T + (long)i * width, width,
+                                 W_y, height_B, width, q == 0);
+        }
+    }
+    free(T);
+    return 0;
+}
+
+/**
+ * Full-footprint path of output rows [i0, i1), columns [j0, j0 + width).
+ */
+static void RS(direct_rows_2d)(const tc_plan *plan, const REAL *A, long pitch_A, REAL *C, long pitch_C,
+                               int i0, int i1, int j0, int width) {
+    int width_B = plan->size_B[0], height_B = plan->size_B[1];
+    const REAL *W = (const REAL *)plan->W_real;
+    for (int i_global = i0; i_global < i1; i_global++) {
+        REAL *c_row = C + i_global * pitch_C + j0;
+        const REAL *a_row = A + i_global * pitch_A + j0;
+
+        for (int ki = 0; ki < height_B; ki++) {
+            RS(row_correlate)(c_row, a_row, W + ki * width_B, width_B, width, ki == 0);
+            a_row += pitch_A;
+        }
+    }
+}
+
+/**
+ * Computes the curr_tile_height x curr_tile_width output tile at (i_tile,
+ * j_tile) on the plan's engine, addressed as if the output were 'valid' (C
+ * shifted by pad), with its whole footprint inside A.
+ */
+static void RS(interior_tile_2d)(const tc_plan *plan, const REAL *A, long pitch_A, REAL *C, long pitch_C,
+                                 int i_tile, int j_tile, int curr_tile_height, int curr_tile_width) {
+    if (plan->engine == TC_ENGINE_LOWRANK &&
+        RS(lowrank_tile_2d)(plan, A, pitch_A, C, pitch_C, i_tile, j_tile, curr_tile_height, curr_tile_width) == 0) {
+        return;
+    }
+
+    if (plan->engine == TC_ENGINE_WINOGRAD &&
+        RS(tc_winograd_tile_2d)(plan, A, pitch_A, C, pitch_C, i_tile, j_tile, curr_tile_height, curr_tile_width) == 0) {
+        // Rows and columns past the last whole Winograd tile take the full footprint
+        int m = plan->winograd_m;
+        int rows = curr_tile_height - curr_tile_height % m, cols = curr_tile_width - curr_tile_width % m;
+        RS(direct_rows_2d)(plan, A, pitch_A, C, pitch_C, i_tile, i_tile + rows, j_tile + cols,
+                           curr_tile_width - cols);
+        RS(direct_rows_2d)(plan, A, pitch_A, C, pitch_C, i_tile + rows, i_tile + curr_tile_height, j_tile,
+                           curr_tile_width);
+        return;
+    }
+
+    if (plan->engine == TC_ENGINE_GEMM) {
+        RS(tc_gemm_tile_2d)(plan, A, pitch_A, C, pitch_C, i_tile, j_tile, curr_tile_height, curr_tile_width);
+        return;
+    }
+
+    RS(direct_rows_2d)(plan, A, pitch_A, C, pitch_C, i_tile, i_tile + curr_tile_height, j_tile, curr_tile_width);
+}
+
+/**
+ * Computes one tile_A[1] x tile_A[0] output tile of a 2D plan: its interior
+ * on the plan's engine and the halo rows and columns around it through
+ * boundary_row. Strided and dilated plans take the phase path.
+ */
+static void RS(direct_tile_2d)(const tc_plan *plan, const REAL *A, long pitch_A,
+                               REAL *C, long pitch_C, int i_tile, int j_tile) {
+    int x1 = (j_tile + plan->tile_A[0] < plan->size_C[0]) ? j_tile + plan->tile_A[0] : plan->size_C[0];
+    int y1 = (i_tile + plan->tile_A[1] < plan->size_C[1]) ? i_tile + plan->tile_A[1] : plan->size_C[1];
+    if (plan->strided) {
+        RS(phase_box)(plan, A, pitch_A, 0, C, pitch_C, 0, j_tile, x1, i_tile, y1, 0, 1);
+        return;
+    }
+    int lo[3], hi[3];
+    tc_interior_range(plan, lo, hi);
+    int ix0 = j_tile > lo[0] ? j_tile : lo[0], ix1 = x1 < hi[0] ? x1 : hi[0];
+    int iy0 = i_tile > lo[1] ? i_tile : lo[1], iy1 = y1 < hi[1] ? y1 : hi[1];
+    int has_interior = (iy0 < iy1 && ix0 < ix1);
+
+    if (has_interior) {
+        RS(interior_tile_2d)(plan, A, pitch_A, C + plan->pad[1] * pitch_C + plan->pad[0], pitch_C,
+                             iy0 - plan->pad[1], ix0 - plan->pad[0], iy1 - iy0, ix1 - ix0);
+    }
+    for (int y = i_tile; y < y1; y++) {
+        if (has_interior && y >= iy0 && y < iy1) {
+            RS(boundary_row)(plan, A, pitch_A, 0, C, pitch_C, 0, j_tile, ix0, y, 0);
+            RS(boundary_row)(plan, A, pitch_A, 0, C, pitch_C, 0, ix1, x1, y, 0);
+        } else {
+            RS(boundary_row)(plan, A, pitch_A, 0, C, pitch_C, 0, j_tile, x1, y, 0);
+        }
+    }
+}
+
+typedef struct {
+    const tc_plan *plan;
+    const REAL *A;
+    long pitch_A;
+    REAL *C;
+    long pitch_C;
+    int tiles_x;
+} RS(direct_2d_job);
+
+static void RS(direct_tile_2d_task)(void *ctx, int index) {
+    const RS(direct_2d_job) *job = (const RS(direct_2d_job) *)ctx;
+    int i_tile = index / job->tiles_x * job->plan->tile_A[1];
+    int j_tile = index % job->tiles_x * job->plan->tile_A[0];
+    RS(direct_tile_2d)(job->plan, job->A, job->pitch_A, job->C, job->pitch_C, i_tile, j_tile);
+}
+
+/**
+ * Tiled 2D engine on pitched rows; a plan with a pool submits each tile as one task.
+ */
+void RS(tc_direct_2d)(const tc_plan *plan, const REAL *A, long pitch_A, REAL *C, long pitch_C) {
+    int width_C = plan->size_C[0], height_C = plan->size_C[1];
+    int tile_width = plan->tile_A[0], tile_height = plan->tile_A[1];
+
+    if (plan->pool) {
+        int tiles_x = (width_C + tile_width - 1) / tile_width;
+        int tiles_y = (height_C + tile_height - 1) / tile_height;
+        RS(direct_2d_job) job = {plan, A, pitch_A, C, pitch_C, tiles_x};
+        tc_pool_run(plan->pool, tiles_x * tiles_y, RS(direct_tile_2d_task), &job);
+        return;
+    }
+
+    for (int i_tile = 0; i_tile < height_C; i_tile += tile_height) {
+        for (int j_tile = 0; j_tile < width_C; j_tile += tile_width) {
+            RS(direct_tile_2d)(plan, A, pitch_A, C, pitch_C, i_tile, j_tile);
+        }
+    }
+}
+
+/**
+ * Computes the interior output box [x0, x1) x [y0, y1) x [z0, z1) with every
+ * kernel tile applied while the box is cache-resident.
+ */
+static void RS(interior_box_3d)(const tc_plan *plan, const REAL *A, long row_A, long slice_A,
+                                REAL *C, long row_C, long slice_C,
+                                int x0, int x1, int y0, int y1, int z0, int z1) {
+    int size_B_x = plan->size_B[0], size_B_y = plan->size_B[1], size_B_z = plan->size_B[2];
+    int tile_B_x = plan->tile_B[0], tile_B_y = plan->tile_B[1], tile_B_z = plan->tile_B[2];
+    long slice_B = (long)size_B_y * size_B_x;
+    int n = x1 - x0;
+
+    const REAL *A_box = A + (z0 - plan->pad[2]) * slice_A + (y0 - plan->pad[1]) * row_A + (x0 - plan->pad[0]);
+    REAL *C_box = C + z0 * slice_C + y0 * row_C + x0;
+
+    for (int kz_start = 0; kz_start < size_B_z; kz_start += tile_B_z) {
+        int kz_end = (kz_start + tile_B_z < size_B_z) ? kz_start + tile_B_z : size_B_z;
+        for (int ky_start = 0; ky_start < size_B_y; ky_start += tile_B_y) {
+            int ky_end = (ky_start + tile_B_y < size_B_y) ? ky_start + tile_B_y : size_B_y;
+            for (int kx_start = 0; kx_start < size_B_x; kx_start += tile_B_x) {
+                int taps = ((kx_start + tile_B_x < size_B_x) ? kx_start + tile_B_x : size_B_x) - kx_start;
+                int first_tile = (kz_start == 0 && ky_start == 0 && kx_start == 0);
+                const REAL *W_tile = (const REAL *)plan->W_real + kz_start * slice_B + (long)ky_start * size_B_x + kx_start;
+                const REAL *A_tile = A_box + kz_start * slice_A + ky_start * row_A + kx_start;
+
+                REAL *c_plane = C_box;
+                const REAL *a_plane = A_tile;
+                for (int z = z0; z < z1; z++) {
+                    REAL *c_row = c_plane;
+                    const REAL *a_row = a_plane;
+                    for (int y = y0; y < y1; y++) {
+                        int first = first_tile;
+                        const REAL *a_kz = a_row;
+                        const REAL *w_kz = W_tile;
+                        for (int kz = kz_start; kz < kz_end; kz++) {
+                            const REAL *a_ky = a_kz;
+                            const REAL *w_ky = w_kz;
+                            for (int ky = ky_start; ky < ky_end; ky++) {
+                                RS(row_correlate)(c_row, a_ky, w_ky, taps, n, first);
+                                first = 0;
+                                a_ky += row_A;
+                                w_ky += size_B_x;
+                            }
+                            a_kz += slice_A;
+                            w_kz += slice_B;
+                        }
+                        c_row += row_C;
+                        a_row += row_A;
+                    }
+                    c_plane += slice_C;
+                    a_plane += slice_A;
+                }
+            }
+        }
+    }
+}
+
+typedef struct {
+    const tc_plan *plan;
+    const REAL *A;
+    long row_A, slice_A;
+    REAL *C;
+    long row_C, slice_C;
+    int lo[3], hi[3];   // Interior output range per axis
+    int blocks_x, blocks_y;
+} RS(direct_3d_job);
+
+/**
+ * Computes the output block at x0, y0, z0: its interior on the kernel-tiled
+ * path and the boundary shell around it one clamped point at a time.
+ */
+static void RS(direct_block_3d)(const RS(direct_3d_job) *job, int x0, int y0, int z0) {
+    const tc_plan *plan = job->plan;
+    const int *lo = job->lo, *hi = job->hi;
+    int x1 = (x0 + plan->tile_A[0] < plan->size_C[0]) ? x0 + plan->tile_A[0] : plan->size_C[0];
+    int y1 = (y0 + plan->tile_A[1] < plan->size_C[1]) ? y0 + plan->tile_A[1] : plan->size_C[1];
+    int z1 = (z0 + plan->tile_A[2] < plan->size_C[2]) ? z0 + plan->tile_A[2] : plan->size_C[2];
+    if (plan->strided) {
+        RS(phase_box)(plan, job->A, job->row_A, job->slice_A, job->C, job->row_C, job->slice_C,
+                      x0, x1, y0, y1, z0, z1);
+        return;
+    }
+    int ix0 = x0 > lo[0] ? x0 : lo[0], ix1 = x1 < hi[0] ? x1 : hi[0];
+    int iy0 = y0 > lo[1] ? y0 : lo[1], iy1 = y1 < hi[1] ? y1 : hi[1];
+    int iz0 = z0 > lo[2] ? z0 : lo[2], iz1 = z1 < hi[2] ? z1 : hi[2];
+    int has_interior = (iz0 < iz1 && iy0 < iy1 && ix0 < ix1);
+
+    if (has_interior) {
+        RS(interior_box_3d)(plan, job->A, job->row_A, job->slice_A, job->C, job->row_C, job->slice_C,
+                            ix0, ix1, iy0, iy1, iz0, iz1);
+        if (ix0 == x0 && ix1 == x1 && iy0 == y0 && iy1 == y1 && iz0 == z0 && iz1 == z1) {
+            return;
+        }
+    }
+
+    for (int z = z0; z < z1; z++) {
+        for (int y = y0; y < y1; y++) {
+            if (has_interior && z >= iz0 && z < iz1 && y >= iy0 && y < iy1) {
+                RS(boundary_row)(plan, job->A, job->row_A, job->slice_A, job->C, job->row_C, job->slice_C,
+                                 x0, ix0, y, z);
+                RS(boundary_row)(plan, job->A, job->row_A, job->slice_A, job->C, job->row_C, job->slice_C,
+                                 ix1, x1, y, z);
+            } else {
+                RS(boundary_row)(plan, job->A, job->row_A, job->slice_A, job->C, job->row_C, job->slice_C,
+                                 x0, x1, y, z);
+            }
+        }
+    }
+}
+
+static void RS(direct_block_3d_task)(void *ctx, int index) {
+    const RS(direct_3d_job) *job = (const RS(direct_3d_job) *)ctx;
+    int bx = index % job->blocks_x;
+    int by = index / job->blocks_x % job->blocks_y;
+    int bz = index / job->blocks_x / job->blocks_y;
+    RS(direct_block_3d)(job, bx * job->plan->tile_A[0], by * job->plan->tile_A[1], bz * job->plan->tile_A[2]);
+}
+
+/**
+ * Tiled 3D engine on strided volumes, one pool task per output block.
+ */
+void RS(tc_direct_3d)(const tc_plan *plan, const REAL *A, long row_A, long slice_A,
+                      REAL *C, long row_C, long slice_C) {
+    RS(direct_3d_job) job = {plan, A, row_A, slice_A, C, row_C, slice_C};
+    tc_interior_range(plan, job.lo, job.hi);
+
+    int tile_A_x = plan->tile_A[0], tile_A_y = plan->tile_A[1], tile_A_z = plan->tile_A[2];
+    int size_C_x = plan->size_C[0], size_C_y = plan->size_C[1], size_C_z = plan->size_C[2];
+
+    if (plan->pool) {
+        job.blocks_x = (size_C_x + tile_A_x - 1) / tile_A_x;
+        job.blocks_y = (size_C_y + tile_A_y - 1) / tile_A_y;
+        int blocks_z = (size_C_z + tile_A_z - 1) / tile_A_z;
+        tc_pool_run(plan->pool, job.blocks_x * job.blocks_y * blocks_z, RS(direct_block_3d_task), &job);
+        return;
+    }
+
+    for (int z0 = 0; z0 < size_C_z; z0 += tile_A_z) {
+        for (int y0 = 0; y0 < size_C_y; y0 += tile_A_y) {
+            for (int x0 = 0; x0 < size_C_x; x0 += tile_A_x) {
+                RS(direct_block_3d)(&job, x0, y0, z0);
+            }
+        }
+    }
+}
+
+void RS(tc_direct_block)(const tc_plan *plan, const REAL *A, long row_A, long slice_A,
+                         REAL *C, long row_C, long slice_C, int x0, int y0, int z0) {
+    if (plan->dims == 1) {
+        int x1 = (x0 + plan->tile_A[0] < plan->size_C[0]) ? x0 + plan->tile_A[0] : plan->size_C[0];
+        RS(direct_range_1d)(plan, A, C, x0, x1);
+    } else if (plan->dims == 2) {
+        RS(direct_tile_2d)(plan, A, row_A, C, row_C, y0, x0);
+    } else {
+        RS(direct_3d_job) job = {plan, A, row_A, slice_A, C, row_C, slice_C};
+        tc_interior_range(plan, job.lo, job.hi);
+        RS(direct_block_3d)(&job, x0, y0, z0);
+    }
+}
+
+/*
+ * Plan entry points
+ */
+
+tc_plan *RS(tc_plan_create_1d)(tc_op op, int size_A, const REAL *B, int size_B,
+                               const tc_options *opts) {
+    int shape_A[3] = {size_A, 1, 1};
+    int shape_B[3] = {size_B, 1, 1};
+    return tc_plan_create_typed(op, 1, shape_A, B, shape_B, REAL_DTYPE, opts);
+}
+
+tc_plan *RS(tc_plan_create_2d)(tc_op op, int height_A, int width_A,
+                               const REAL *B, int height_B, int width_B,
+                               const tc_options *opts) {
+    int shape_A[3] = {width_A, height_A, 1};
+    int shape_B[3] = {width_B, height_B, 1};
+    return tc_plan_create_typed(op, 2, shape_A, B, shape_B, REAL_DTYPE, opts);
+}
+
+tc_plan *RS(tc_plan_create_3d)(tc_op op, int size_A_x, int size_A_y, int size_A_z,
+                               const REAL *B, int size_B_x, int size_B_y, int size_B_z,
+                               const tc_options *opts) {
+    int shape_A[3] = {size_A_x, size_A_y, size_A_z};
+    int shape_B[3] = {size_B_x, size_B_y, size_B_z};
+    return tc_plan_create_typed(op, 3, shape_A, B, shape_B, REAL_DTYPE, opts);
+}
+
+void RS(tc_execute)(const tc_plan *plan, const REAL *A, REAL *C) {
+    if (plan->dtype != REAL_DTYPE) return;
+    switch (plan->dims) {
+        case 1:
+            RS(direct_range_1d)(plan, A, C, 0, plan->size_C[0]);
+            break;
+        case 2:
+            RS(tc_direct_2d)(plan, A, plan->size_A[0], C, plan->size_C[0]);
+            break;
+        default:
+            RS(tc_direct_3d)(plan, A, plan->size_A[0], (long)plan->size_A[0] * plan->size_A[1],
+                             C, plan->size_C[0], (long)plan->size_C[0] * plan->size_C[1]);
+            break;
+    }
+}
+
+tc_bank *RS(tc_bank_create_1d)(tc_op op, int size_A, int count, const REAL *const *B, const int *size_B,
+                               const tc_options *opts) {
+    int shape_A[3] = {size_A, 1, 1};
+    const int *shape_B[3] = {size_B, NULL, NULL};
+    return tc_bank_create_typed(op, 1, shape_A, count, (const void *const *)B, shape_B, REAL_DTYPE, opts);
+}
+
+tc_bank *RS(tc_bank_create_2d)(tc_op op, int height_A, int width_A, int count, const REAL *const *B,
+                               const int *height_B, const int *width_B, const tc_options *opts) {
+    int shape_A[3] = {width_A, height_A, 1};
+    const int *shape_B[3] = {width_B, height_B, NULL};
+    return tc_bank_create_typed(op, 2, shape_A, count, (const void *const *)B, shape_B, REAL_DTYPE, opts);
+}
+
+tc_bank *RS(tc_bank_create_3d)(tc_op op, int size_A_x, int size_A_y, int size_A_z, int count,
+                               const REAL *const *B, const int *size_B_x, const int *size_B_y,
+                               const int *size_B_z, const tc_options *opts) {
+    int shape_A[3] = {size_A_x, size_A_y, size_A_z};
+    const int *shape_B[3] = {size_B_x, size_B_y, size_B_z};
+    return tc_bank_create_typed(op, 3, shape_A, count, (const void *const *)B, shape_B, REAL_DTYPE, opts);
+}
+
+void RS(tc_bank_execute)(const tc_bank *bank, const REAL *A, REAL *const *C) {
+    if (tc_plan_dtype(tc_bank_plan(bank, 0)) != REAL_DTYPE) return;
+    tc_bank_run(bank, A, (void *const *)C);
+}
+
+/*
+ * Naive reference implementations: the textbook loops of the standalone
+ * naive programs, on dense row-major arrays of any of the three ranks.
+ */
+
+static void RS(naive_correlate)(tc_op op, const REAL *A, const int size_A[3],
+                                const REAL *B, const int size_B[3], REAL *C) {
+    int size_C[3];
+    for (int axis = 0; axis < 3; axis++) size_C[axis] = size_A[axis] - size_B[axis] + 1;
+
+    for (int z = 0; z < size_C[2]; z++) {
+        for (int y = 0; y < size_C[1]; y++) {
+            for (int x = 0; x < size_C[0]; x++) {
+                REAL sum = 0;
+                for (int kz = 0; kz < size_B[2]; kz++) {
+                    for (int ky = 0; ky < size_B[1]; ky++) {
+                        for (int kx = 0; kx < size_B[0]; kx++) {
+                            int bx = kx, by = ky, bz = kz;
+                            if (op == TC_CONVOLUTION) {
+                                bx = size_B[0] - 1 - kx;
+                                by = size_B[1] - 1 - ky;
+                                bz = size_B[2] - 1 - kz;
+                            }
+                            sum += A[((long)(z + kz) * size_A[1] + y + ky) * size_A[0] + x + kx] *
+                                   B[((long)bz * size_B[1] + by) * size_B[0] + bx];
+                        }
+                    }
+                }
+                C[((long)z * size_C[1] + y) * size_C[0] + x] = sum;
+            }
+        }
+    }
+}
+
+void RS(naive_cross_correlation_1d)(const REAL *A, int size_A, const REAL *B, int size_B, REAL *C) {
+    int shape_A[3] = {size_A, 1, 1}, shape_B[3] = {size_B, 1, 1};
+    RS(naive_correlate)(TC_CROSS_CORRELATION, A, shape_A, B, shape_B, C);
+}
+
+void RS(naive_convolution_1d)(const REAL *A, int size_A, const REAL *B, int size_B, REAL *C) {
+    int shape_A[3] = {size_A, 1, 1}, shape_B[3] = {size_B, 1, 1};
+    RS(naive_correlate)(TC_CONVOLUTION, A, shape_A, B, shape_B, C);
+}
+
+void RS(naive_cross_correlation_2d)(const REAL *A, int height_A, int width_A,
+                                    const REAL *B, int height_B, int width_B, REAL *C) {
+    int shape_A[3] = {width_A, height_A, 1}, shape_B[3] = {width_B, height_B, 1};
+    RS(naive_correlate)(TC_CROSS_CORRELATION, A, shape_A, B, shape_B, C);
+}
+
+void RS(naive_convolution_2d)(const REAL *A, int height_A, int width_A,
+                              const REAL *B, int height_B, int width_B, REAL *C) {
+    int shape_A[3] = {width_A, height_A, 1}, shape_B[3] = {width_B, height_B, 1};
+    RS(naive_correlate)(TC_CONVOLUTION, A, shape_A, B, shape_B, C);
+}
+
+void RS(naive_cross_correlation_3d)(const REAL *A, int size_A_x, int size_A_y, int size_A_z,
+                                    const REAL *B, int size_B_x, int size_B_y, int size_B_z, REAL *C) {
+    int shape_A[3] = {size_A_x, size_A_y, size_A_z}, shape_B[3] = {size_B_x, size_B_y, size_B_z};
+    RS(naive_correlate)(TC_CROSS_CORRELATION, A, shape_A, B, shape_B, C);
+}
+
+void RS(naive_convolution_3d)(const REAL *A, int size_A_x, int size_A_y, int size_A_z,
+                              const REAL *B, int size_B_x, int size_B_y, int size_B_z, REAL *C) {
+    int shape_A[3] = {size_A_x, size_A_y, size_A_z}, shape_B[3] = {size_B_x, size_B_y, size_B_z};
+    RS(naive_correlate)(TC_CONVOLUTION, A, shape_A, B, shape_B, C);
+}
+
+/*
+ * One-shot tiled entry points. Each call builds a temporary plan and aborts
+ * like the standalone programs when it cannot.
+ */
+
+static void RS(tiled_run)(tc_op op, int dims, const REAL *A, const int shape_A[3],
+                          const REAL *B, const int shape_B[3], REAL *C,
+                          const int tile_A[3], const int tile_B[3]) {
+    tc_options opts;
+    tc_options_init(&opts);
+    for (int axis = 0; axis < 3; axis++) {
+        opts.tile_A[axis] = tile_A[axis];
+        opts.tile_B[axis] = tile_B[axis];
+    }
+
+    tc_plan *plan = tc_plan_create_typed(op, dims, shape_A, B, shape_B, REAL_DTYPE, &opts);
+    if (!plan) {
+        printf("Memory allocation failed\n");
+        exit(1);
+    }
+    RS(tc_execute)(plan, A, C);
+    tc_plan_destroy(plan);
+}
+
+void RS(tiled_cross_correlation_1d)(const REAL *A, int size_A, const REAL *B, int size_B, REAL *C,
+                                    int tile_A, int tile_B) {
+    int shape_A[3] = {size_A, 1, 1}, shape_B[3] = {size_B, 1, 1};
+    int tiles_A[3] = {tile_A, 1, 1}, tiles_B[3] = {tile_B, 1, 1};
+    RS(tiled_run)(TC_CROSS_CORRELATION, 1, A, shape_A, B, shape_B, C, tiles_A, tiles_B);
+}
+
+void RS(tiled_convolution_1d)(const REAL *A, int size_A, const REAL *B, int size_B, REAL *C,
+                              int tile_A, int tile_B) {
+    int shape_A[3] = {size_A, 1, 1}, shape_B[3] = {size_B, 1, 1};
+    int tiles_A[3] = {tile_A, 1, 1}, tiles_B[3] = {tile_B, 1, 1};
+    RS(tiled_run)(TC_CONVOLUTION, 1, A, shape_A, B, shape_B, C, tiles_A, tiles_B);
+}
+
+void RS(tiled_cross_correlation_2d)(const REAL *A, int height_A, int width_A,
+                                    const REAL *B, int height_B, int width_B, REAL *C,
+                                    int tile_height, int tile_width) {
+    int shape_A[3] = {width_A, height_A, 1}, shape_B[3] = {width_B, height_B, 1};
+    int tiles_A[3] = {tile_width, tile_height, 1}, tiles_B[3] = {0, 0, 0};
+    RS(tiled_run)(TC_CROSS_CORRELATION, 2, A, shape_A, B, shape_B, C, tiles_A, tiles_B);
+}
+
+void RS(tiled_convolution_2d)(const REAL *A, int height_A, int width_A,
+                              const REAL *B, int height_B, int width_B, REAL *C,
+                              int tile_height, int tile_width) {
+    int shape_A[3] = {width_A, height_A, 1}, shape_B[3] = {width_B, height_B, 1};
+    int tiles_A[3] = {tile_width, tile_height, 1}, tiles_B[3] = {0, 0, 0};
+    RS(tiled_run)(TC_CONVOLUTION, 2, A, shape_A, B, shape_B, C, tiles_A, tiles_B);
+}
+
+void RS(tiled_cross_correlation_3d)(const REAL *A, int size_A_x, int size_A_y, int size_A_z,
+                                    const REAL *B, int size_B_x, int size_B_y, int size_B_z, REAL *C,
+                                    int tile_A_x, int tile_A_y, int tile_A_z,
+                                    int tile_B_x, int tile_B_y, int tile_B_z) {
+    int shape_A[3] = {size_A_x, size_A_y, size_A_z}, shape_B[3] = {size_B_x, size_B_y, size_B_z};
+    int tiles_A[3] = {tile_A_x, tile_A_y, tile_A_z}, tiles_B[3] = {tile_B_x, tile_B_y, tile_B_z};
+    RS(tiled_run)(TC_CROSS_CORRELATION, 3, A, shape_A, B, shape_B, C, tiles_A, tiles_B);
+}
+
+void RS(tiled_convolution_3d)(const REAL *A, int size_A_x, int size_A_y, int size_A_z,
+                              const REAL *B, int size_B_x, int size_B_y, int size_B_z, REAL *C,
+                              int tile_A_x, int tile_A_y, int tile_A_z,
+                              int tile_B_x, int tile_B_y, int tile_B_z) {
+    int shape_A[3] = {size_A_x, size_A_y, size_A_z}, shape_B[3] = {size_B_x, size_B_y, size_B_z};
+    int tiles_A[3] = {tile_A_x, tile_A_y, tile_A_z}, tiles_B[3] = {tile_B_x, tile_B_y, tile_B_z};
+    RS(tiled_run)(TC_CONVOLUTION, 3, A, shape_A, B, shape_B, C, tiles_A, tiles_B);
+}
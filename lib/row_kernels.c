@@ -0,0 +1,441 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TC_X86 1
+#endif
+
+#include "tileconv_internal.h"
+
+/**
+ * Portable row kernel: one pass per tap keeps the inner loop unit-stride over
+ * the outputs, which the compiler vectorizes for the baseline ISA.
+ */
+static void row_correlate_scalar(int *c, const int *a, const int *w, int taps, int n, int first) {
+    int k = 0;
+    if (first) {
+        int w0 = w[0];
+        for (int j = 0; j < n; j++) {
+            c[j] = a[j] * w0;
+        }
+        k = 1;
+    }
+    for (; k < taps; k++) {
+        const int *a_k = a + k;
+        int w_k = w[k];
+        for (int j = 0; j < n; j++) {
+            c[j] += a_k[j] * w_k;
+        }
+    }
+}
+
+/**
+ * Portable column kernel: the first tap stores, later taps accumulate one
+ * unit-stride row at a time.
+ */
+static void column_correlate_scalar(int *c, const int *t, long pitch, const int *w, int taps, int n) {
+    int w0 = w[0];
+    for (int j = 0; j < n; j++) {
+        c[j] = t[j] * w0;
+    }
+    for (int k = 1; k < taps; k++) {
+        const int *t_k = t + k * pitch;
+        int w_k = w[k];
+        for (int j = 0; j < n; j++) {
+            c[j] += t_k[j] * w_k;
+        }
+    }
+}
+
+#ifdef TC_X86
+
+/**
+ * AVX2 row kernel. Four 8-lane accumulators (32 outputs) stay in registers
+ * while every tap is broadcast and multiplied against the shifted input, so C
+ * is loaded and stored once per call instead of once per tap.
+ */
+__attribute__((target("avx2")))
+static void row_correlate_avx2(int *c, const int *a, const int *w, int taps, int n, int first) {
+    int j = 0;
+    for (; j + 32 <= n; j += 32) {
+        __m256i acc0, acc1, acc2, acc3;
+        if (first) {
+            acc0 = acc1 = acc2 = acc3 = _mm256_setzero_si256();
+        } else {
+            acc0 = _mm256_loadu_si256((const __m256i *)(c + j));
+            acc1 = _mm256_loadu_si256((const __m256i *)(c + j + 8));
+            acc2 = _mm256_loadu_si256((const __m256i *)(c + j + 16));
+            acc3 = _mm256_loadu_si256((const __m256i *)(c + j + 24));
+        }
+        const int *a_j = a + j;
+        for (int k = 0; k < taps; k++) {
+            __m256i w_k = _mm256_set1_epi32(w[k]);
+            const int *a_k = a_j + k;
+            acc0 = _mm256_add_epi32(acc0, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(a_k)), w_k));
+            acc1 = _mm256_add_epi32(acc1, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(a_k + 8)), w_k));
+            acc2 = _mm256_add_epi32(acc2, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(a_k + 16)), w_k));
+            acc3 = _mm256_add_epi32(acc3, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(a_k + 24)), w_k));
+        }
+        _mm256_storeu_si256((__m256i *)(c + j), acc0);
+        _mm256_storeu_si256((__m256i *)(c + j + 8), acc1);
+        _mm256_storeu_si256((__m256i *)(c + j + 16), acc2);
+        _mm256_storeu_si256((__m256i *)(c + j + 24), acc3);
+    }
+    for (; j + 8 <= n; j += 8) {
+        __m256i acc = first ? _mm256_setzero_si256() : _mm256_loadu_si256((const __m256i *)(c + j));
+        for (int k = 0; k < taps; k++) {
+            __m256i a_k = _mm256_loadu_si256((const __m256i *)(a + j + k));
+            acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(a_k, _mm256_set1_epi32(w[k])));
+        }
+        _mm256_storeu_si256((__m256i *)(c + j), acc);
+    }
+    for (; j < n; j++) {
+        int sum = first ? 0 : c[j];
+        for (int k = 0; k < taps; k++) {
+            sum += a[j + k] * w[k];
+        }
+        c[j] = sum;
+    }
+}
+
+/**
+ * AVX-512 row kernel. Four 16-lane accumulators cover 64 outputs; the tail
+ * uses masked loads and stores instead of a scalar loop.
+ */
+__attribute__((target("avx512f")))
+static void row_correlate_avx512(int *c, const int *a, const int *w, int taps, int n, int first) {
+    int j = 0;
+    for (; j + 64 <= n; j += 64) {
+        __m512i acc0, acc1, acc2, acc3;
+        if (first) {
+            acc0 = acc1 = acc2 = acc3 = _mm512_setzero_si512();
+        } else {
+            acc0 = _mm512_loadu_si512(c + j);
+            acc1 = _mm512_loadu_si512(c + j + 16);
+            acc2 = _mm512_loadu_si512(c + j + 32);
+            acc3 = _mm512_loadu_si512(c + j + 48);
+        }
+        const int *a_j = a + j;
+        for (int k = 0; k < taps; k++) {
+            __m512i w_k = _mm512_set1_epi32(w[k]);
+            const int *a_k = a_j + k;
+            acc0 = _mm512_add_epi32(acc0, _mm512_mullo_epi32(_mm512_loadu_si512(a_k), w_k));
+            acc1 = _mm512_add_epi32(acc1, _mm512_mullo_epi32(_mm512_loadu_si512(a_k + 16), w_k));
+            acc2 = _mm512_add_epi32(acc2, _mm512_mullo_epi32(_mm512_loadu_si512(a_k + 32), w_k));
+            acc3 = _mm512_add_epi32(acc3, _mm512_mullo_epi32(_mm512_loadu_si512(a_k + 48), w_k));
+        }
+        _mm512_storeu_si512(c + j, acc0);
+        _mm512_storeu_si512(c + j + 16, acc1);
+        _mm512_storeu_si512(c + j + 32, acc2);
+        _mm512_storeu_si512(c + j + 48, acc3);
+    }
+    while (j < n) {
+        int lanes = (n - j < 16) ? n - j : 16;
+        __mmask16 mask = (__mmask16)((1u << lanes) - 1);
+        __m512i acc = first ? _mm512_setzero_si512() : _mm512_maskz_loadu_epi32(mask, c + j);
+        for (int k = 0; k < taps; k++) {
+            __m512i a_k = _mm512_maskz_loadu_epi32(mask, a + j + k);
+            acc = _mm512_add_epi32(acc, _mm512_mullo_epi32(a_k, _mm512_set1_epi32(w[k])));
+        }
+        _mm512_mask_storeu_epi32(c + j, mask, acc);
+        j += lanes;
+    }
+}
+
+/**
+ * AVX2 column kernel. Like the row kernel, 32 outputs stay in registers over
+ * all taps; tap k reads row k of t instead of a shifted window.
+ */
+__attribute__((target("avx2")))
+static void column_correlate_avx2(int *c, const int *t, long pitch, const int *w, int taps, int n) {
+    int j = 0;
+    for (; j + 32 <= n; j += 32) {
+        __m256i acc0 = _mm256_setzero_si256(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        const int *t_k = t + j;
+        for (int k = 0; k < taps; k++) {
+            __m256i w_k = _mm256_set1_epi32(w[k]);
+            acc0 = _mm256_add_epi32(acc0, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(t_k)), w_k));
+            acc1 = _mm256_add_epi32(acc1, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(t_k + 8)), w_k));
+            acc2 = _mm256_add_epi32(acc2, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(t_k + 16)), w_k));
+            acc3 = _mm256_add_epi32(acc3, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(t_k + 24)), w_k));
+            t_k += pitch;
+        }
+        _mm256_storeu_si256((__m256i *)(c + j), acc0);
+        _mm256_storeu_si256((__m256i *)(c + j + 8), acc1);
+        _mm256_storeu_si256((__m256i *)(c + j + 16), acc2);
+        _mm256_storeu_si256((__m256i *)(c + j + 24), acc3);
+    }
+    for (; j + 8 <= n; j += 8) {
+        __m256i acc = _mm256_setzero_si256();
+        for (int k = 0; k < taps; k++) {
+            __m256i t_k = _mm256_loadu_si256((const __m256i *)(t + k * pitch + j));
+            acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(t_k, _mm256_set1_epi32(w[k])));
+        }
+        _mm256_storeu_si256((__m256i *)(c + j), acc);
+    }
+    for (; j < n; j++) {
+        int sum = 0;
+        for (int k = 0; k < taps; k++) {
+            sum += t[k * pitch + j] * w[k];
+        }
+        c[j] = sum;
+    }
+}
+
+/**
+ * AVX-512 column kernel: 64 outputs per pass and a masked tail.
+ */
+__attribute__((target("avx512f")))
+static void column_correlate_avx512(int *c, const int *t, long pitch, const int *w, int taps, int n) {
+    int j = 0;
+    for (; j + 64 <= n; j += 64) {
+        __m512i acc0 = _mm512_setzero_si512(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        const int *t_k = t + j;
+        for (int k = 0; k < taps; k++) {
+            __m512i w_k = _mm512_set1_epi32(w[k]);
+            acc0 = _mm512_add_epi32(acc0, _mm512_mullo_epi32(_mm512_loadu_si512(t_k), w_k));
+            acc1 = _mm512_add_epi32(acc1, _mm512_mullo_epi32(_mm512_loadu_si512(t_k + 16), w_k));
+            acc2 = _mm512_add_epi32(acc2, _mm512_mullo_epi32(_mm512_loadu_si512(t_k + 32), w_k));
+            acc3 = _mm512_add_epi32(acc3, _mm512_mullo_epi32(_mm512_loadu_si512(t_k + 48), w_k));
+            t_k += pitch;
+        }
+        _mm512_storeu_si512(c + j, acc0);
+        _mm512_storeu_si512(c + j + 16, acc1);
+        _mm512_storeu_si512(c + j + 32, acc2);
+        _mm512_storeu_si512(c + j + 48, acc3);
+    }
+    while (j < n) {
+        int lanes = (n - j < 16) ? n - j : 16;
+        __mmask16 mask = (__mmask16)((1u << lanes) - 1);
+        __m512i acc = _mm512_setzero_si512();
+        for (int k = 0; k < taps; k++) {
+            __m512i t_k = _mm512_maskz_loadu_epi32(mask, t + k * pitch + j);
+            acc = _mm512_add_epi32(acc, _mm512_mullo_epi32(t_k, _mm512_set1_epi32(w[k])));
+        }
+        _mm512_mask_storeu_epi32(c + j, mask, acc);
+        j += lanes;
+    }
+}
+
+#endif
+
+/*
+ * Wide kernels for the 64-bit accumulator modes. Each call covers the whole
+ * kernel footprint of its outputs, so the 64-bit sums stay in registers and
+ * never have to be stored between calls:
+ * sum_j = sum over z < bz, y < by, x < bx of
+ *         a[z * slice_a + y * row_a + j + x] * w[(z * by + y) * bx + x]
+ * is written to c64[j], or clamped to the int range and written to c32[j] when
+ * c64 is NULL.
+ */
+
+static inline void store_wide(long long *c64, int *c32, int j, long long sum) {
+    if (c64) {
+        c64[j] = sum;
+    } else {
+        c32[j] = sum > INT_MAX ? INT_MAX : (sum < INT_MIN ? INT_MIN : (int)sum);
+    }
+}
+
+// Outputs accumulated per pass of the portable wide kernel
+#define WIDE_CHUNK 64
+
+/**
+ * Portable wide kernel: a chunk of 64-bit sums is updated one tap at a time so
+ * the inner loop is unit-stride and vectorizable for the baseline ISA.
+ */
+static void wide_correlate_scalar(long long *c64, int *c32, const int *a, long row_a, long slice_a,
+                                  const int *w, int bx, int by, int bz, int n) {
+    long long acc[WIDE_CHUNK];
+    for (int j0 = 0; j0 < n; j0 += WIDE_CHUNK) {
+        int m = (n - j0 < WIDE_CHUNK) ? n - j0 : WIDE_CHUNK;
+        for (int j = 0; j < m; j++) acc[j] = 0;
+        for (int z = 0; z < bz; z++) {
+            for (int y = 0; y < by; y++) {
+                const int *a_row = a + z * slice_a + y * row_a + j0;
+                const int *w_row = w + ((long)z * by + y) * bx;
+                for (int x = 0; x < bx; x++) {
+                    long long w_x = w_row[x];
+                    const int *a_x = a_row + x;
+                    for (int j = 0; j < m; j++) {
+                        acc[j] += a_x[j] * w_x;
+                    }
+                }
+            }
+        }
+        for (int j = 0; j < m; j++) store_wide(c64, c32, j0 + j, acc[j]);
+    }
+}
+
+#ifdef TC_X86
+
+/**
+ * Stores four 64-bit sums to c64, or clamps them to the int range and stores
+ * them to c32.
+ */
+__attribute__((target("avx2")))
+static inline void store_wide_avx2(long long *c64, int *c32, int j, __m256i v) {
+    if (c64) {
+        _mm256_storeu_si256((__m256i *)(c64 + j), v);
+        return;
+    }
+    __m256i hi = _mm256_set1_epi64x(INT_MAX), lo = _mm256_set1_epi64x(INT_MIN);
+    v = _mm256_blendv_epi8(v, hi, _mm256_cmpgt_epi64(v, hi));
+    v = _mm256_blendv_epi8(v, lo, _mm256_cmpgt_epi64(lo, v));
+    __m256i packed = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+    _mm_storeu_si128((__m128i *)(c32 + j), _mm256_castsi256_si128(packed));
+}
+
+/**
+ * AVX2 wide kernel. Inputs are sign-extended to 64-bit lanes and multiplied
+ * with vpmuldq; four 4-lane accumulators cover 16 outputs.
+ */
+__attribute__((target("avx2")))
+static void wide_correlate_avx2(long long *c64, int *c32, const int *a, long row_a, long slice_a,
+                                const int *w, int bx, int by, int bz, int n) {
+    int j = 0;
+    for (; j + 16 <= n; j += 16) {
+        __m256i acc0 = _mm256_setzero_si256(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        for (int z = 0; z < bz; z++) {
+            for (int y = 0; y < by; y++) {
+                const int *a_row = a + z * slice_a + y * row_a + j;
+                const int *w_row = w + ((long)z * by + y) * bx;
+                for (int x = 0; x < bx; x++) {
+                    __m256i w_x = _mm256_set1_epi64x(w_row[x]);
+                    const int *a_x = a_row + x;
+                    acc0 = _mm256_add_epi64(acc0, _mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(a_x))), w_x));
+                    acc1 = _mm256_add_epi64(acc1, _mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(a_x + 4))), w_x));
+                    acc2 = _mm256_add_epi64(acc2, _mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(a_x + 8))), w_x));
+                    acc3 = _mm256_add_epi64(acc3, _mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(a_x + 12))), w_x));
+                }
+            }
+        }
+        store_wide_avx2(c64, c32, j, acc0);
+        store_wide_avx2(c64, c32, j + 4, acc1);
+        store_wide_avx2(c64, c32, j + 8, acc2);
+        store_wide_avx2(c64, c32, j + 12, acc3);
+    }
+    for (; j + 4 <= n; j += 4) {
+        __m256i acc = _mm256_setzero_si256();
+        for (int z = 0; z < bz; z++) {
+            for (int y = 0; y < by; y++) {
+                const int *a_row = a + z * slice_a + y * row_a + j;
+                const int *w_row = w + ((long)z * by + y) * bx;
+                for (int x = 0; x < bx; x++) {
+                    __m256i a_x = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(a_row + x)));
+                    acc = _mm256_add_epi64(acc, _mm256_mul_epi32(a_x, _mm256_set1_epi64x(w_row[x])));
+                }
+            }
+        }
+        store_wide_avx2(c64, c32, j, acc);
+    }
+    if (j < n) {
+        wide_correlate_scalar(c64 ? c64 + j : NULL, c64 ? NULL : c32 + j, a + j, row_a, slice_a,
+                              w, bx, by, bz, n - j);
+    }
+}
+
+/**
+ * AVX-512 wide kernel. Four 8-lane accumulators cover 32 outputs; int results
+ * are narrowed with signed saturation (vpmovsqd), and the tail uses masks.
+ */
+__attribute__((target("avx512f")))
+static void wide_correlate_avx512(long long *c64, int *c32, const int *a, long row_a, long slice_a,
+                                  const int *w, int bx, int by, int bz, int n) {
+    int j = 0;
+    for (; j + 32 <= n; j += 32) {
+        __m512i acc0 = _mm512_setzero_si512(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        for (int z = 0; z < bz; z++) {
+            for (int y = 0; y < by; y++) {
+                const int *a_row = a + z * slice_a + y * row_a + j;
+                const int *w_row = w + ((long)z * by + y) * bx;
+                for (int x = 0; x < bx; x++) {
+                    __m512i w_x = _mm512_set1_epi64(w_row[x]);
+                    const int *a_x = a_row + x;
+                    acc0 = _mm512_add_epi64(acc0, _mm512_mul_epi32(_mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)(a_x))), w_x));
+                    acc1 = _mm512_add_epi64(acc1, _mm512_mul_epi32(_mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)(a_x + 8))), w_x));
+                    acc2 = _mm512_add_epi64(acc2, _mm512_mul_epi32(_mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)(a_x + 16))), w_x));
+                    acc3 = _mm512_add_epi64(acc3, _mm512_mul_epi32(_mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)(a_x + 24))), w_x));
+                }
+            }
+        }
+        if (c64) {
+            _mm512_storeu_si512(c64 + j, acc0);
+            _mm512_storeu_si512(c64 + j + 8, acc1);
+            _mm512_storeu_si512(c64 + j + 16, acc2);
+            _mm512_storeu_si512(c64 + j + 24, acc3);
+        } else {
+            _mm256_storeu_si256((__m256i *)(c32 + j), _mm512_cvtsepi64_epi32(acc0));
+            _mm256_storeu_si256((__m256i *)(c32 + j + 8), _mm512_cvtsepi64_epi32(acc1));
+            _mm256_storeu_si256((__m256i *)(c32 + j + 16), _mm512_cvtsepi64_epi32(acc2));
+            _mm256_storeu_si256((__m256i *)(c32 + j + 24), _mm512_cvtsepi64_epi32(acc3));
+        }
+    }
+    while (j < n) {
+        int lanes = (n - j < 8) ? n - j : 8;
+        __mmask16 load_mask = (__mmask16)((1u << lanes) - 1);
+        __mmask8 mask = (__mmask8)load_mask;
+        __m512i acc = _mm512_setzero_si512();
+        for (int z = 0; z < bz; z++) {
+            for (int y = 0; y < by; y++) {
+                const int *a_row = a + z * slice_a + y * row_a + j;
+                const int *w_row = w + ((long)z * by + y) * bx;
+                for (int x = 0; x < bx; x++) {
+                    __m256i a32 = _mm512_castsi512_si256(_mm512_maskz_loadu_epi32(load_mask, a_row + x));
+                    acc = _mm512_add_epi64(acc, _mm512_mul_epi32(_mm512_cvtepi32_epi64(a32),
+                                                                 _mm512_set1_epi64(w_row[x])));
+                }
+            }
+        }
+        if (c64) {
+            _mm512_mask_storeu_epi64(c64 + j, mask, acc);
+        } else {
+            _mm512_mask_cvtsepi64_storeu_epi32(c32 + j, mask, acc);
+        }
+        j += lanes;
+    }
+}
+
+#endif
+
+tc_row_correlate_fn tc_row_correlate = row_correlate_scalar;
+tc_column_correlate_fn tc_column_correlate = column_correlate_scalar;
+tc_wide_correlate_fn tc_wide_correlate = wide_correlate_scalar;
+static const char *row_kernel_isa = "scalar";
+
+/**
+ * Picks the widest row kernels the CPU supports when the library is loaded.
+ * TILECONV_ISA=scalar|avx2|avx512 caps the choice, e.g. to compare kernels
+ * on one machine.
+ */
+__attribute__((constructor))
+static void select_row_kernel(void) {
+#ifdef TC_X86
+    const char *cap = getenv("TILECONV_ISA");
+    int allow_avx512 = !cap || strcmp(cap, "avx512") == 0;
+    int allow_avx2 = allow_avx512 || strcmp(cap, "avx2") == 0;
+
+    __builtin_cpu_init();
+    if (allow_avx512 && __builtin_cpu_supports("avx512f")) {
+        tc_row_correlate = row_correlate_avx512;
+        tc_column_correlate = column_correlate_avx512;
+        tc_wide_correlate = wide_correlate_avx512;
+        row_kernel_isa = "avx512";
+    } else if (allow_avx2 && __builtin_cpu_supports("avx2")) {
+        tc_row_correlate = row_correlate_avx2;
+        tc_column_correlate = column_correlate_avx2;
+        tc_wide_correlate = wide_correlate_avx2;
+        row_kernel_isa = "avx2";
+    }
+#endif
+    tc_real_select_kernels(row_kernel_isa);
+    tc_winograd_select_kernels(row_kernel_isa);
+    tc_gemm_select_kernels(row_kernel_isa);
+    tc_layer_select_kernels(row_kernel_isa);
+}
+
+const char *tc_isa(void) {
+    return row_kernel_isa;
+}
@@ -0,0 +1,118 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "tileconv_internal.h"
+
+// Default outputs per block: a multiple of the kernel so that the size_B - 1
+// history copied between blocks stays a small fraction of the work
+#define STREAM_MIN_BLOCK 4096
+#define STREAM_KERNEL_MULTIPLE 8
+
+/**
+ * Overlap-save stream. buffer holds the size_B - 1 history followed by up to
+ * block new samples; fill counts the samples currently in it.
+ */
+struct tc_stream {
+    tc_plan *plan;      // 1D plan over size_B - 1 + block samples
+    int size_B;
+    int block;
+    int *buffer;
+    int fill;
+};
+
+tc_stream *tc_stream_create(tc_op op, const int *B, int size_B, int block,
+                            const tc_options *opts) {
+    if (size_B < 1 || block < 0) return NULL;
+    if (block == 0) {
+        block = size_B * STREAM_KERNEL_MULTIPLE;
+        if (block < STREAM_MIN_BLOCK) block = STREAM_MIN_BLOCK;
+    }
+
+    tc_stream *stream = (tc_stream *)calloc(1, sizeof(tc_stream));
+    if (!stream) return NULL;
+
+    // The carried history is the halo, so the plan itself produces unit-stride 'valid' outputs
+    tc_options plan_opts;
+    if (opts) {
+        plan_opts = *opts;
+    } else {
+        tc_options_init(&plan_opts);
+    }
+    plan_opts.output = TC_OUTPUT_VALID;
+    for (int axis = 0; axis < 3; axis++) {
+        plan_opts.stride[axis] = 1;
+        plan_opts.dilation[axis] = 1;
+    }
+
+    stream->size_B = size_B;
+    stream->block = block;
+    stream->plan = tc_plan_create_1d(op, size_B - 1 + block, B, size_B, &plan_opts);
+    stream->buffer = (int *)tc_alloc_aligned((size_t)(size_B - 1 + block) * sizeof(int));
+    if (!stream->plan || !stream->buffer) {
+        tc_stream_destroy(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+/**
+ * Computes every output the buffered samples determine and keeps the last
+ * size_B - 1 samples as history for the next block.
+ */
+static int emit(tc_stream *stream, int *out) {
+    int outputs = stream->fill - stream->size_B + 1;
+    if (outputs <= 0) return 0;
+
+    if (outputs == stream->block) {
+        tc_execute(stream->plan, stream->buffer, out);
+    } else {
+        tc_direct_1d(stream->plan, stream->buffer, out, NULL, outputs);
+    }
+
+    memmove(stream->buffer, stream->buffer + outputs, (size_t)(stream->size_B - 1) * sizeof(int));
+    stream->fill = stream->size_B - 1;
+    return outputs;
+}
+
+int tc_stream_push(tc_stream *stream, const int *chunk, int count, int *out) {
+    int capacity = stream->size_B - 1 + stream->block;
+    int immediate = (stream->plan->engine != TC_ENGINE_FFT);
+    int written = 0;
+
+    while (count > 0) {
+        int take = capacity - stream->fill;
+        if (take > count) take = count;
+        memcpy(stream->buffer + stream->fill, chunk, (size_t)take * sizeof(int));
+        stream->fill += take;
+        chunk += take;
+        count -= take;
+
+        // Full blocks always run through the plan; the direct engine also
+        // emits partial blocks right away since it has no per-block overhead
+        if (stream->fill == capacity || immediate) {
+            written += emit(stream, out + written);
+        }
+    }
+
+    return written;
+}
+
+int tc_stream_flush(tc_stream *stream, int *out) {
+    return emit(stream, out);
+}
+
+int tc_stream_latency(const tc_stream *stream) {
+    return stream->plan->engine == TC_ENGINE_FFT ? stream->block - 1 : 0;
+}
+
+void tc_stream_reset(tc_stream *stream) {
+    stream->fill = 0;
+}
+
+void tc_stream_destroy(tc_stream *stream) {
+    if (!stream) return;
+    tc_plan_destroy(stream->plan);
+    free(stream->buffer);
+    free(stream);
+}
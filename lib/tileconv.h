@@ -0,0 +1,781 @@
+#ifndef TILECONV_H
+#define TILECONV_H
+
+/**
+ * Plan-based convolution / cross-correlation library.
+ *
+ * A plan is created once for an operation, a shape and a kernel. Creation
+ * orients the kernel (flipping it for convolution), packs it contiguously
+ * and picks tile sizes, so tc_execute() does no setup work and can be called
+ * any number of times.
+ *
+ * Arrays are dense and row-major. 3D volumes use the same layout as the 3D
+ * comparison program: element (x, y, z) lives at z * size_y * size_x + y * size_x + x.
+ * Outputs are 'valid' (size_A - size_B + 1 along each axis) unless the plan
+ * asks for 'same' or 'full' extents, which read zeros outside A.
+ */
+
+typedef enum {
+    TC_CONVOLUTION,
+    TC_CROSS_CORRELATION
+} tc_op;
+
+typedef enum {
+    TC_ENGINE_AUTO,     // Pick the fastest engine for the shape
+    TC_ENGINE_DIRECT,   // Tiled direct loops
+    TC_ENGINE_FFT,      // Overlap-save FFT (1D only)
+    TC_ENGINE_SEPARABLE,// Successive 1D passes for exactly separable 2D / 3D int kernels
+    TC_ENGINE_LOWRANK,  // Sum of separable passes approximating a float / double 2D kernel
+    TC_ENGINE_WINOGRAD, // Winograd minimal filtering for square 3 x 3 and 5 x 5 2D kernels
+    TC_ENGINE_GEMM      // Implicit GEMM: packed input patches times the packed kernel matrix (2D)
+} tc_engine;
+
+// Element type of a plan's kernel, input and output
+typedef enum {
+    TC_INT,
+    TC_FLOAT,
+    TC_DOUBLE
+} tc_dtype;
+
+/**
+ * Accumulator of the direct engines. The 64-bit modes multiply 32-bit inputs
+ * into 64-bit sums with their own vectorized kernels.
+ */
+typedef enum {
+    TC_ACCUM_AUTO,      // Cheapest width that is provably overflow-free for the declared input range
+    TC_ACCUM_INT32,     // 32-bit sums; wrap on overflow (fastest)
+    TC_ACCUM_INT64,     // 64-bit sums; tc_execute_i64 returns them exactly
+    TC_ACCUM_SAT32      // 64-bit sums clamped to the int range on output
+} tc_accum;
+
+/**
+ * Output extent along each axis. 'same' and 'full' outputs read zeros outside
+ * A; no padded copy of A is made: only the outputs whose footprint crosses the
+ * input boundary take the clamped path, the interior runs on the plan's engine.
+ */
+typedef enum {
+    TC_OUTPUT_VALID,    // size_A - size_B + 1: outputs whose footprint lies inside A
+    TC_OUTPUT_SAME,     // size_A, centered like 'same' in NumPy / SciPy (pad = size_B / 2)
+    TC_OUTPUT_FULL      // size_A + size_B - 1
+} tc_output;
+
+/**
+ * What 'same' and 'full' outputs read outside A, for an axis of n samples
+ * a b c d. Like the zeros, the extension is never materialized: only the
+ * halo outputs remap their input indices.
+ */
+typedef enum {
+    TC_BOUNDARY_ZERO,       // 0 0 | a b c d | 0 0
+    TC_BOUNDARY_REFLECT,    // b a | a b c d | d c  (mirrored about the edge, period 2n)
+    TC_BOUNDARY_REPLICATE,  // a a | a b c d | d d
+    TC_BOUNDARY_WRAP        // c d | a b c d | a b  (periodic, period n)
+} tc_boundary;
+
+/**
+ * Plan creation options. Call tc_options_init() before setting fields.
+ * Axis order is x, y, z; for 2D plans x is the width and y the height.
+ * A tile size of 0 lets the library choose.
+ */
+typedef struct tc_pool tc_pool;
+
+typedef struct {
+    int tile_A[3];  // Output block size per axis
+    int tile_B[3];  // Kernel tile size per axis
+    tc_engine engine;
+    int threads;    // Threads sharing the output blocks of 2D and 3D plans; 0 or 1 runs on the caller
+    tc_pool *pool;  // Existing pool to run 2D and 3D blocks on instead of a private one (overrides threads)
+    tc_accum accum;
+    int input_min;  // Declared range of the values of A for the accumulator bound check;
+    int input_max;  // both 0 means undeclared
+    double rank_tolerance;  // Float / double 2D plans: run a low-rank approximation of the kernel
+                            // within this relative error (0 runs the exact kernel)
+    int winograd_tile;      // Output tile m of TC_ENGINE_WINOGRAD: 2 or 4 (3 x 3 kernels only); 0 picks
+    tc_output output;       // Output extent; the kernel may be larger than A for 'same' and 'full'
+    tc_boundary boundary;   // Input extension read by 'same' and 'full' outputs
+    int stride[3];          // Input step between consecutive outputs per axis; 0 means 1
+    int dilation[3];        // Input step between consecutive kernel taps per axis; 0 means 1
+} tc_options;
+
+typedef struct tc_plan tc_plan;
+typedef struct tc_bank tc_bank;
+typedef struct tc_layer tc_layer;
+
+/**
+ * Contiguous 2D matrix with a row pitch. data is 64-byte aligned and row i
+ * starts at data + i * pitch. The pitch is a whole number of cache lines and
+ * is padded by one extra line when rows would otherwise be spaced by a
+ * multiple of 2 KB, which keeps power-of-two widths out of 4K cache-set aliasing.
+ */
+typedef struct {
+    int *data;
+    int height;
+    int width;
+    int pitch;      // Elements between the starts of consecutive rows
+} tc_matrix;
+
+// Element (i, j) of a tc_matrix
+#define TC_AT(m, i, j) ((m)->data[(long)(i) * (m)->pitch + (j)])
+
+/**
+ * Fills opts with the library defaults.
+ */
+void tc_options_init(tc_options *opts);
+
+/**
+ * Creates a 1D plan for an input of size_A elements and a kernel B of size_B elements.
+ * B is copied, so it may be freed after the call. opts may be NULL.
+ *
+ * @return The plan, or NULL if the shapes or the input range are invalid or memory allocation failed
+ */
+tc_plan *tc_plan_create_1d(tc_op op, int size_A, const int *B, int size_B,
+                           const tc_options *opts);
+
+/**
+ * Creates a 2D plan for a height_A x width_A input and a height_B x width_B kernel
+ * stored row-major in B.
+ */
+tc_plan *tc_plan_create_2d(tc_op op, int height_A, int width_A,
+                           const int *B, int height_B, int width_B,
+                           const tc_options *opts);
+
+/**
+ * Creates a 3D plan for a size_A_x x size_A_y x size_A_z input and a
+ * size_B_x x size_B_y x size_B_z kernel.
+ */
+tc_plan *tc_plan_create_3d(tc_op op, int size_A_x, int size_A_y, int size_A_z,
+                           const int *B, int size_B_x, int size_B_y, int size_B_z,
+                           const tc_options *opts);
+
+/*
+ * Float and double plans. tc_plan_create_{1,2,3}d_f / _d take the same shapes
+ * and options as the int constructors and run the same tiled engines and pool
+ * on FMA-vectorized kernels; tc_execute_f / tc_execute_d run them. The
+ * filter bank and multi-channel layer functions have _f / _d variants with
+ * the same arguments as well. Both types are generated from one source
+ * (real_engine.h), as are the naive reference and one-shot tiled functions
+ * below. Float plans use the direct engine
+ * unless the low-rank or Winograd engine is requested; accum and the input
+ * range only apply to int plans.
+ *
+ * The naive_* and tiled_* functions take dense row-major arrays, also in 2D
+ * (element (i, j) at i * width + j), and the same tile arguments as the int
+ * one-shot functions; tiled_* abort with "Memory allocation failed" when the
+ * temporary plan cannot be built.
+ */
+#define TC_DECLARE_REAL(REAL, S) \
+    tc_plan *tc_plan_create_1d##S(tc_op op, int size_A, const REAL *B, int size_B, \
+                                  const tc_options *opts); \
+    tc_plan *tc_plan_create_2d##S(tc_op op, int height_A, int width_A, \
+                                  const REAL *B, int height_B, int width_B, \
+                                  const tc_options *opts); \
+    tc_plan *tc_plan_create_3d##S(tc_op op, int size_A_x, int size_A_y, int size_A_z, \
+                                  const REAL *B, int size_B_x, int size_B_y, int size_B_z, \
+                                  const tc_options *opts); \
+    void tc_execute##S(const tc_plan *plan, const REAL *A, REAL *C); \
+    tc_bank *tc_bank_create_1d##S(tc_op op, int size_A, int count, const REAL *const *B, const int *size_B, \
+                                  const tc_options *opts); \
+    tc_bank *tc_bank_create_2d##S(tc_op op, int height_A, int width_A, int count, const REAL *const *B, \
+                                  const int *height_B, const int *width_B, const tc_options *opts); \
+    tc_bank *tc_bank_create_3d##S(tc_op op, int size_A_x, int size_A_y, int size_A_z, int count, \
+                                  const REAL *const *B, const int *size_B_x, const int *size_B_y, \
+                                  const int *size_B_z, const tc_options *opts); \
+    void tc_bank_execute##S(const tc_bank *bank, const REAL *A, REAL *const *C); \
+    tc_layer *tc_layer_create_2d##S(tc_op op, int channels_in, int height_A, int width_A, int channels_out, \
+                                    const REAL *B, int height_B, int width_B, const tc_options *opts); \
+    int tc_layer_execute##S(const tc_layer *layer, int batch, const REAL *A, REAL *C); \
+    int tc_layer_execute_nchwc##S(const tc_layer *layer, int batch, const REAL *A, REAL *C); \
+    void tc_nchw_to_nchwc##S(const REAL *src, int batch, int channels, int height, int width, REAL *dst); \
+    void tc_nchwc_to_nchw##S(const REAL *src, int batch, int channels, int height, int width, REAL *dst); \
+    void naive_cross_correlation_1d##S(const REAL *A, int size_A, const REAL *B, int size_B, REAL *C); \
+    void naive_convolution_1d##S(const REAL *A, int size_A, const REAL *B, int size_B, REAL *C); \
+    void naive_cross_correlation_2d##S(const REAL *A, int height_A, int width_A, \
+                                       const REAL *B, int height_B, int width_B, REAL *C); \
+    void naive_convolution_2d##S(const REAL *A, int height_A, int width_A, \
+                                 const REAL *B, int height_B, int width_B, REAL *C); \
+    void naive_cross_correlation_3d##S(const REAL *A, int size_A_x, int size_A_y, int size_A_z, \
+                                       const REAL *B, int size_B_x, int size_B_y, int size_B_z, REAL *C); \
+    void naive_convolution_3d##S(const REAL *A, int size_A_x, int size_A_y, int size_A_z, \
+                                 const REAL *B, int size_B_x, int size_B_y, int size_B_z, REAL *C); \
+    void tiled_cross_correlation_1d##S(const REAL *A, int size_A, const REAL *B, int size_B, REAL *C, \
+                                       int tile_A, int tile_B); \
+    void tiled_convolution_1d##S(const REAL *A, int size_A, const REAL *B, int size_B, REAL *C, \
+                                 int tile_A, int tile_B); \
+    void tiled_cross_correlation_2d##S(const REAL *A, int height_A, int width_A, \
+                                       const REAL *B, int height_B, int width_B, REAL *C, \
+                                       int tile_height, int tile_width); \
+    void tiled_convolution_2d##S(const REAL *A, int height_A, int width_A, \
+                                 const REAL *B, int height_B, int width_B, REAL *C, \
+                                 int tile_height, int tile_width); \
+    void tiled_cross_correlation_3d##S(const REAL *A, int size_A_x, int size_A_y, int size_A_z, \
+                                       const REAL *B, int size_B_x, int size_B_y, int size_B_z, REAL *C, \
+                                       int tile_A_x, int tile_A_y, int tile_A_z, \
+                                       int tile_B_x, int tile_B_y, int tile_B_z); \
+    void tiled_convolution_3d##S(const REAL *A, int size_A_x, int size_A_y, int size_A_z, \
+                                 const REAL *B, int size_B_x, int size_B_y, int size_B_z, REAL *C, \
+                                 int tile_A_x, int tile_A_y, int tile_A_z, \
+                                 int tile_B_x, int tile_B_y, int tile_B_z);
+
+TC_DECLARE_REAL(float, _f)
+TC_DECLARE_REAL(double, _d)
+
+#undef TC_DECLARE_REAL
+
+/*
+ * Type-generic plan API (C11 _Generic): the constructor is picked from the
+ * type of B and the executor from the type of C, so the same call works for
+ * int, float and double data.
+ */
+#define TC_PLAN_CREATE_1D(op, size_A, B, size_B, opts) \
+    _Generic((B), float *: tc_plan_create_1d_f, const float *: tc_plan_create_1d_f, \
+                  double *: tc_plan_create_1d_d, const double *: tc_plan_create_1d_d, \
+                  default: tc_plan_create_1d)(op, size_A, B, size_B, opts)
+
+#define TC_PLAN_CREATE_2D(op, height_A, width_A, B, height_B, width_B, opts) \
+    _Generic((B), float *: tc_plan_create_2d_f, const float *: tc_plan_create_2d_f, \
+                  double *: tc_plan_create_2d_d, const double *: tc_plan_create_2d_d, \
+                  default: tc_plan_create_2d)(op, height_A, width_A, B, height_B, width_B, opts)
+
+#define TC_PLAN_CREATE_3D(op, size_A_x, size_A_y, size_A_z, B, size_B_x, size_B_y, size_B_z, opts) \
+    _Generic((B), float *: tc_plan_create_3d_f, const float *: tc_plan_create_3d_f, \
+                  double *: tc_plan_create_3d_d, const double *: tc_plan_create_3d_d, \
+                  default: tc_plan_create_3d)(op, size_A_x, size_A_y, size_A_z, \
+                                              B, size_B_x, size_B_y, size_B_z, opts)
+
+#define TC_EXECUTE(plan, A, C) \
+    _Generic((C), float *: tc_execute_f, double *: tc_execute_d, default: tc_execute)(plan, A, C)
+
+/**
+ * Runs the plan on input A, writing the output to C.
+ * C does not need to be zeroed beforehand.
+ */
+void tc_execute(const tc_plan *plan, const int *A, int *C);
+
+/**
+ * Runs the plan with 64-bit accumulation and writes the exact sums to C,
+ * whatever accumulator the plan uses for tc_execute.
+ */
+void tc_execute_i64(const tc_plan *plan, const int *A, long long *C);
+
+/**
+ * Returns the element type the plan was created for. tc_execute, tc_execute_f
+ * and tc_execute_d do nothing on a plan of another type.
+ */
+tc_dtype tc_plan_dtype(const tc_plan *plan);
+
+/**
+ * Returns the engine the plan runs (never TC_ENGINE_AUTO).
+ *
+ * 2D and 3D int plans factor the kernel at creation time. When it is exactly
+ * the outer product of integer 1D kernels (Sobel, box and binomial / Gaussian
+ * filters, ...), TC_ENGINE_SEPARABLE runs one 1D pass per axis, so an output
+ * costs size_B_x + size_B_y + size_B_z multiply-adds instead of their product.
+ * TC_ENGINE_AUTO picks it whenever that saves multiply-adds (from 3 x 2 up);
+ * requesting it for a kernel that does not factor runs the direct engine.
+ * Plans with a 64-bit accumulator, and tc_execute_i64, always use the full
+ * footprint. 32-bit results are the same as the direct engine's, including
+ * wrapping, since both compute the same sum modulo 2^32.
+ *
+ * TC_ENGINE_WINOGRAD runs square 3 x 3 and 5 x 5 2D kernels as Winograd
+ * minimal filtering: F(4 x 4, 3 x 3) (or F(2 x 2, 3 x 3) with
+ * opts.winograd_tile = 2) and F(2 x 2, 5 x 5), with the transformed kernel
+ * computed once per plan. Float and double results differ from the direct
+ * engine by rounding. Int plans are exact: they need a declared input range
+ * (opts.input_min / input_max) under which every scaled transform fits in an
+ * int, and otherwise try the smaller tile, then keep the direct engine. On a
+ * single channel the transforms cost more than the multiplies they save, so
+ * TC_ENGINE_AUTO never picks Winograd; it has to be requested.
+ *
+ * TC_ENGINE_GEMM runs a 2D plan as an implicit GEMM: blocks of output pixels
+ * have their input patches packed into small panels (never the whole im2col
+ * matrix) that a register-blocked micro-kernel multiplies with the packed
+ * kernel. Int results are the same as the direct engine's, wrapping included.
+ * With a single kernel the packing costs about as much as the multiplies, so
+ * it pays off for filter banks and multi-channel inputs; TC_ENGINE_AUTO never
+ * picks it for a single-kernel plan.
+ */
+tc_engine tc_plan_engine(const tc_plan *plan);
+
+/**
+ * Returns the accumulator of the plan (never TC_ACCUM_AUTO).
+ *
+ * With TC_ACCUM_AUTO and a declared input range, plan creation bounds every
+ * partial sum of the kernel over inputs in [input_min, input_max] and picks
+ * int32 if the bound fits in an int, else int64. Without a declared range
+ * nothing can be proven and AUTO keeps the 32-bit accumulator.
+ */
+tc_accum tc_plan_accum(const tc_plan *plan);
+
+/**
+ * Returns 1 if the bound check proved that the plan's accumulator cannot
+ * overflow for inputs in the declared range, 0 otherwise.
+ */
+int tc_plan_overflow_free(const tc_plan *plan);
+
+/**
+ * Low-rank mode of float and double 2D plans (opts.rank_tolerance > 0).
+ *
+ * Plan creation computes the SVD of the kernel and keeps the fewest
+ * components r whose truncation error ||W - W_r|| / ||W|| (Frobenius) is at
+ * most the tolerance. The plan then runs TC_ENGINE_LOWRANK: per output tile,
+ * r pairs of 1D passes (a row pass along x, then a column pass along y)
+ * accumulated into C, which costs r * (width_B + height_B) multiply-adds per
+ * output instead of width_B * height_B. When that would not be cheaper the
+ * plan keeps the exact kernel and rank is 0.
+ */
+typedef struct {
+    int rank;           // Components evaluated; 0 if the plan runs the exact kernel
+    int full_rank;      // Numerical rank of the kernel
+    double error;       // Relative Frobenius error of the kernel actually applied
+    double error_l1;    // Sum of |W - W_r|: |C - C_exact| <= error_l1 * max |A| for every output
+    double speedup;     // Expected speedup in multiply-adds over the exact kernel (1 if rank is 0)
+} tc_lowrank_info;
+
+/**
+ * Fills info with the low-rank decomposition the plan runs.
+ */
+void tc_plan_lowrank(const tc_plan *plan, tc_lowrank_info *info);
+
+/**
+ * Returns the output extent of the plan along axis (0 = x, 1 = y, 2 = z).
+ */
+int tc_plan_output_size(const tc_plan *plan, int axis);
+
+/**
+ * Returns the total number of output elements of the plan.
+ */
+long tc_plan_output_count(const tc_plan *plan);
+
+/**
+ * Returns the pool the plan runs its blocks on, or NULL for a single-threaded plan.
+ * Use it with tc_pool_stats to check load balance.
+ */
+tc_pool *tc_plan_pool(const tc_plan *plan);
+
+void tc_plan_destroy(tc_plan *plan);
+
+/**
+ * Filter bank: count kernels applied to the same input in one pass.
+ *
+ * Kernel k is B[k] with its own size (size_B[k], or height_B[k] x width_B[k],
+ * or size_B_x[k] x size_B_y[k] x size_B_z[k]); sizes may differ between
+ * kernels. Each kernel gets a plan as tc_plan_create_* would build it from
+ * opts, but execution walks the output in blocks and runs every kernel on a
+ * block before moving to the next, so each block of the input is loaded into
+ * cache once for the whole bank rather than once per kernel. With
+ * TC_ENGINE_GEMM, 2D kernels of the same shape are grouped into one implicit
+ * GEMM per block, which reuses every packed input panel for all of them.
+ * opts.threads or opts.pool run the blocks in parallel. 1D kernels whose
+ * plans pick the FFT engine run on their own.
+ *
+ * @return The bank, or NULL if count < 1, a plan could not be created for
+ *         one of the kernels, or memory allocation failed
+ */
+tc_bank *tc_bank_create_1d(tc_op op, int size_A, int count, const int *const *B, const int *size_B,
+                           const tc_options *opts);
+tc_bank *tc_bank_create_2d(tc_op op, int height_A, int width_A, int count, const int *const *B,
+                           const int *height_B, const int *width_B, const tc_options *opts);
+tc_bank *tc_bank_create_3d(tc_op op, int size_A_x, int size_A_y, int size_A_z, int count,
+                           const int *const *B, const int *size_B_x, const int *size_B_y, const int *size_B_z,
+                           const tc_options *opts);
+
+/**
+ * Runs the bank on input A, writing the output of kernel k to C[k]
+ * (dense, of tc_plan_output_count(tc_bank_plan(bank, k)) elements).
+ */
+void tc_bank_execute(const tc_bank *bank, const int *A, int *const *C);
+
+/**
+ * Returns the number of kernels of the bank.
+ */
+int tc_bank_size(const tc_bank *bank);
+
+/**
+ * Returns the plan of kernel index, for its output shape, engine and
+ * accumulator, or NULL if index is out of range. It belongs to the bank.
+ */
+const tc_plan *tc_bank_plan(const tc_bank *bank, int index);
+
+/**
+ * Returns 1 if kernel index runs in one of the bank's GEMM groups, 0 if it
+ * runs on its own plan.
+ */
+int tc_bank_grouped(const tc_bank *bank, int index);
+
+void tc_bank_destroy(tc_bank *bank);
+
+/**
+ * Batched multi-channel 2D layer: channels_out kernels, each summing a
+ * height_B x width_B kernel over all channels_in input channels.
+ *
+ * B holds channels_out x channels_in x height_B x width_B elements (kernel
+ * (o, i) at (o * channels_in + i) * height_B * width_B) and is copied. Inputs
+ * are batch x channels_in x height_A x width_A and outputs batch x
+ * channels_out x height_C x width_C, with 'valid' extents (opts.output must
+ * be TC_OUTPUT_VALID, with unit stride and dilation).
+ * Int layers accumulate in 32 bits and wrap on overflow, whatever opts.accum
+ * says. opts.tile_A[0] / [1] set the output tile, and opts.threads or
+ * opts.pool spread the (image, channel block, tile) tasks over threads.
+ *
+ * Layers compute in the channel-blocked NCHWc layout: channels in blocks of
+ * tc_layer_block(layer) (16 for int and float, 8 for double; one 64-byte
+ * vector), stored [n][block][y][x][channel in block], with the channels past
+ * the last one zero. tc_layer_execute takes plain NCHW and converts on the
+ * way in and out; tc_layer_execute_nchwc skips the conversions, so a chain of
+ * layers can keep its activations blocked.
+ *
+ * @return The layer, or NULL if a shape is invalid or memory allocation failed
+ */
+tc_layer *tc_layer_create_2d(tc_op op, int channels_in, int height_A, int width_A, int channels_out,
+                             const int *B, int height_B, int width_B, const tc_options *opts);
+
+/**
+ * Runs the layer on batch images in NCHW layout.
+ *
+ * @return 0 on success, -1 if batch < 1, the layer has another element type
+ *         or memory allocation failed
+ */
+int tc_layer_execute(const tc_layer *layer, int batch, const int *A, int *C);
+
+/**
+ * Runs the layer on batch images already in NCHWc layout: A of
+ * tc_layer_input_count(layer, batch) and C of tc_layer_output_count(layer,
+ * batch) elements.
+ *
+ * @return 0 on success, -1 if batch < 1 or the layer has another element type
+ */
+int tc_layer_execute_nchwc(const tc_layer *layer, int batch, const int *A, int *C);
+
+/**
+ * Returns the number of channels per NCHWc block of the layer.
+ */
+int tc_layer_block(const tc_layer *layer);
+
+/**
+ * Returns the output extent of the layer along axis (0 = x, 1 = y).
+ */
+int tc_layer_output_size(const tc_layer *layer, int axis);
+
+/**
+ * Returns the number of elements of batch blocked inputs or outputs,
+ * padding channels included.
+ */
+long tc_layer_input_count(const tc_layer *layer, int batch);
+long tc_layer_output_count(const tc_layer *layer, int batch);
+
+void tc_layer_destroy(tc_layer *layer);
+
+/**
+ * Converts batch x channels x height x width elements between NCHW and NCHWc
+ * with blocks of 64 bytes of the element type. The blocked side has its
+ * channel count rounded up to a whole block; tc_nchw_to_nchwc zeroes the
+ * extra channels and tc_nchwc_to_nchw ignores them.
+ */
+void tc_nchw_to_nchwc(const int *src, int batch, int channels, int height, int width, int *dst);
+void tc_nchwc_to_nchw(const int *src, int batch, int channels, int height, int width, int *dst);
+
+/**
+ * Runs a 2D plan on pitched matrices. A must be height_A x width_A and C
+ * (height_A - height_B + 1) x (width_A - width_B + 1); pitches may differ.
+ *
+ * @return 0 on success, -1 if the plan is not 2D or the matrix shapes do not match it
+ */
+int tc_execute_2d(const tc_plan *plan, const tc_matrix *A, tc_matrix *C);
+
+/**
+ * Returns the row pitch, in elements, that tc_matrix_create uses for a given width.
+ */
+int tc_matrix_pitch(int width);
+
+/**
+ * Allocates a height x width matrix as a single aligned buffer. Contents are uninitialized.
+ *
+ * @return The matrix, or NULL if memory allocation failed
+ */
+tc_matrix *tc_matrix_create(int height, int width);
+
+/**
+ * Adapter for int** row arrays: allocates a matrix and copies the rows into it.
+ */
+tc_matrix *tc_matrix_from_rows(int **rows, int height, int width);
+
+/**
+ * Adapter for int** row arrays: copies the matrix back into existing rows.
+ */
+void tc_matrix_to_rows(const tc_matrix *m, int **rows);
+
+void tc_matrix_destroy(tc_matrix *m);
+
+/**
+ * Streaming 1D convolution / cross-correlation over an unbounded signal.
+ *
+ * Input arrives in chunks of any size and every 'valid' output is emitted once
+ * the samples it depends on have been pushed: after N samples in total, the
+ * stream has produced N - size_B + 1 outputs. Only the last size_B - 1 samples
+ * are carried between blocks (overlap-save), so memory does not grow with the
+ * signal length.
+ */
+typedef struct tc_stream tc_stream;
+
+/**
+ * Creates a stream for kernel B of size_B elements. block is the number of
+ * outputs computed per plan execution (0 lets the library choose); opts
+ * selects tiles and the engine as for tc_plan_create_1d and may be NULL.
+ * With the direct engine every push emits its outputs immediately; the FFT
+ * engine holds samples back until a whole block is buffered.
+ *
+ * @return The stream, or NULL if the arguments are invalid or memory allocation failed
+ */
+tc_stream *tc_stream_create(tc_op op, const int *B, int size_B, int block,
+                            const tc_options *opts);
+
+/**
+ * Pushes count samples and writes the outputs they complete to out, which
+ * must have room for count + tc_stream_latency(stream) elements.
+ *
+ * @return The number of outputs written
+ */
+int tc_stream_push(tc_stream *stream, const int *chunk, int count, int *out);
+
+/**
+ * Emits every output that the samples pushed so far determine but that is
+ * still held back in a partial FFT block. out must have room for
+ * tc_stream_latency(stream) elements.
+ *
+ * @return The number of outputs written
+ */
+int tc_stream_flush(tc_stream *stream, int *out);
+
+/**
+ * Returns the maximum number of samples the stream holds back beyond the
+ * size_B - 1 history: 0 for the direct engine, block - 1 for FFT.
+ */
+int tc_stream_latency(const tc_stream *stream);
+
+/**
+ * Forgets all pushed samples so the stream can start a new signal.
+ */
+void tc_stream_reset(tc_stream *stream);
+
+void tc_stream_destroy(tc_stream *stream);
+
+/**
+ * Work-stealing thread pool. Every worker owns a deque of block tasks; a run
+ * deals the blocks out in contiguous ranges and idle workers steal half of a
+ * busy worker's remaining range, so blocks of uneven cost (boundary vs
+ * interior, different kernel sizes) still keep every core busy.
+ *
+ * A pool can be shared by any number of plans through tc_options.pool.
+ */
+typedef struct {
+    double busy_seconds;        // Time spent inside tasks
+    double elapsed_seconds;     // Wall time of all runs of the pool
+    double utilization;         // busy_seconds / elapsed_seconds
+    long tasks;                 // Tasks executed
+    long steals;                // Successful steals from other workers
+} tc_pool_worker_stats;
+
+/**
+ * Creates a pool of threads workers; the thread that calls tc_pool_run is
+ * worker 0, so threads - 1 threads are started.
+ *
+ * @return The pool, or NULL if memory allocation failed
+ */
+tc_pool *tc_pool_create(int threads);
+
+/**
+ * Returns the number of workers, which may be lower than requested if threads could not be started.
+ */
+int tc_pool_size(const tc_pool *pool);
+
+/**
+ * Calls fn(ctx, index) for every index in [0, count) on the pool's workers and
+ * returns when all calls have finished. Concurrent runs on one pool are serialized.
+ */
+void tc_pool_run(tc_pool *pool, int count, void (*fn)(void *ctx, int index), void *ctx);
+
+/**
+ * Reports the accumulated statistics of one worker (0 <= worker < tc_pool_size).
+ */
+void tc_pool_stats(const tc_pool *pool, int worker, tc_pool_worker_stats *stats);
+
+void tc_pool_reset_stats(tc_pool *pool);
+
+void tc_pool_destroy(tc_pool *pool);
+
+/**
+ * Hardware performance counters (Linux perf_event_open) for measuring an
+ * engine run. Counters cover the calling thread and every thread it creates
+ * after tc_perf_open, so open them before creating threaded plans or pools.
+ * Only user-space events are counted.
+ */
+typedef enum {
+    TC_PERF_CYCLES,
+    TC_PERF_INSTRUCTIONS,
+    TC_PERF_L1D_MISSES,
+    TC_PERF_LLC_MISSES,
+    TC_PERF_DTLB_MISSES,
+    TC_PERF_BRANCH_MISSES,
+    TC_PERF_EVENTS
+} tc_perf_event;
+
+typedef struct {
+    long long value[TC_PERF_EVENTS];
+    int available[TC_PERF_EVENTS];      // 0 if the event could not be counted
+} tc_perf_counts;
+
+typedef struct tc_perf tc_perf;
+
+/**
+ * Opens every counter the kernel and CPU provide.
+ *
+ * @return The counter set, or NULL if no counter is available (not Linux,
+ *         no PMU, or perf_event_paranoid forbids it)
+ */
+tc_perf *tc_perf_open(void);
+
+/**
+ * Resets and starts all counters.
+ */
+void tc_perf_start(tc_perf *perf);
+
+/**
+ * Stops all counters and reads them into counts.
+ */
+void tc_perf_stop(tc_perf *perf, tc_perf_counts *counts);
+
+void tc_perf_close(tc_perf *perf);
+
+const char *tc_perf_event_name(tc_perf_event event);
+
+/**
+ * Returns instructions per cycle, or -1 if cycles or instructions were not counted.
+ */
+double tc_perf_ipc(const tc_perf_counts *counts);
+
+/**
+ * Returns event count / macs, or -1 if the event was not counted.
+ */
+double tc_perf_per_mac(const tc_perf_counts *counts, tc_perf_event event, double macs);
+
+/**
+ * Prints one line with cycles, instructions, IPC and misses per MAC.
+ */
+void tc_perf_print(const char *label, const tc_perf_counts *counts, double macs);
+
+/**
+ * Tile autotuner with a persistent tuning database.
+ *
+ * tc_tune times candidate tile sizes (and, for 1D, the FFT engine) for one
+ * op and shape in-process and records the winner in a tuning database keyed
+ * by CPU model, row-kernel ISA, op, shape, thread count, output mode,
+ * boundary, stride, dilation, accumulator and requested engine. Int plan
+ * creation consults the database whenever the caller leaves every tile at 0,
+ * so a shape tuned once starts with its tuned configuration in every later
+ * process.
+ *
+ * The database is a text file, one tab-separated entry per line, located at
+ * $TILECONV_TUNING_DB or else $HOME/.tileconv_tuning. Setting TILECONV_TUNING_DB
+ * to an empty string disables it. Entries are only ever appended; the last
+ * entry for a key wins.
+ */
+typedef struct {
+    tc_options options;     // Base options with the winning tiles and engine filled in
+    double seconds;         // Best measured time of one tc_execute
+    double mean_seconds;    // Mean of ci_runs fresh runs of the winner (0 when taken from the database)
+    double ci_low;          // 95% confidence interval of mean_seconds
+    double ci_high;
+    int ci_runs;
+    int evaluated;          // Configurations timed on the real shape (0 when taken from the database)
+    int proxy_evaluated;    // Configurations timed on the shrunken 3D proxy
+    int cached;             // 1 if the result came from the database without tuning
+    int saved;              // 1 if a new result was written to the database
+} tc_tune_result;
+
+/**
+ * Tunes the tiles of a plan. 1D and 2D plans use coordinate descent over
+ * power-of-two tiles. 3D plans sample tile_A and tile_B independently
+ * (including non-powers of two), rank the samples by successive halving on a
+ * proxy with about half the extent per axis, and refine the best of them on
+ * the real shape.
+ *
+ * Shapes are x, y, z extents as in the plan (for
+ * 2D, x is the width and y the height; unused axes are 1). base supplies the
+ * threads or pool the plan will run with, and the output mode, boundary,
+ * stride, dilation and accumulator of the plans being timed; it may be NULL.
+ * The kernel may be larger than A when base asks for 'same' or 'full'
+ * output. A base engine of TC_ENGINE_DIRECT keeps 1D tuning off the FFT
+ * engine. The search stops after
+ * roughly budget_seconds (0 for the default of 10 s). Unless force is set, a
+ * shape already in the database is returned without timing anything.
+ *
+ * @return 0 on success, -1 if the shapes are invalid or memory allocation failed.
+ *         A result that cannot be saved to the database is still returned.
+ */
+int tc_tune(tc_op op, int dims, const int size_A[3], const int size_B[3],
+            const tc_options *base, double budget_seconds, int force,
+            tc_tune_result *result);
+
+/**
+ * Looks a shape up in the tuning database using the threads or pool, output
+ * mode, boundary, stride, dilation, accumulator and engine of opts.
+ * On a hit, fills tile_A and tile_B of opts, and for 1D the engine if it is
+ * TC_ENGINE_AUTO and the entry was tuned with TC_ENGINE_AUTO too.
+ *
+ * @return 1 if the shape was found, 0 otherwise
+ */
+int tc_tune_lookup(tc_op op, int dims, const int size_A[3], const int size_B[3],
+                   tc_options *opts);
+
+/**
+ * Overrides the tuning database location. NULL restores the default and an
+ * empty string disables the database.
+ */
+void tc_tune_set_db_path(const char *path);
+
+/**
+ * Returns the tuning database path, or NULL if the database is disabled.
+ */
+const char *tc_tune_db_path(void);
+
+/**
+ * Returns the CPU model name the tuning database is keyed by ("unknown" if
+ * the platform does not report one).
+ */
+const char *tc_cpu_model(void);
+
+/**
+ * Returns the instruction set of the row kernels selected at load time
+ * ("avx512", "avx2" or "scalar"). Set TILECONV_ISA to cap the selection.
+ */
+const char *tc_isa(void);
+
+/*
+ * One-shot entry points with the same signatures as the standalone
+ * implementations. Each call builds a temporary plan, so prefer the plan API
+ * when the same kernel is applied more than once.
+ */
+void tiled_cross_correlation_1d(int *A, int size_A, int *B, int size_B, int *C, int tile_A, int tile_B);
+
+void tiled_convolution_1d(int *A, int size_A, int *B, int size_B, int *C, int tile_A, int tile_B);
+
+void tiled_cross_correlation_2d(int **A, int height_A, int width_A,
+                                int **B, int height_B, int width_B,
+                                int **C, int tile_height, int tile_width);
+
+void tiled_convolution_2d(int **A, int height_A, int width_A,
+                          int **B, int height_B, int width_B,
+                          int **C, int tile_height, int tile_width);
+
+void tiled_cross_correlation_3d(int *A, int size_A_x, int size_A_y, int size_A_z,
+                                int *B, int size_B_x, int size_B_y, int size_B_z,
+                                int *C,
+                                int tile_A_x, int tile_A_y, int tile_A_z,
+                                int tile_B_x, int tile_B_y, int tile_B_z);
+
+void tiled_convolution_3d(int *A, int size_A_x, int size_A_y, int size_A_z,
+                          int *B, int size_B_x, int size_B_y, int size_B_z,
+                          int *C,
+                          int tile_A_x, int tile_A_y, int tile_A_z,
+                          int tile_B_x, int tile_B_y, int tile_B_z);
+
+#endif
@@ -0,0 +1,421 @@
+#ifndef TILECONV_INTERNAL_H
+#define TILECONV_INTERNAL_H
+
+#include <stddef.h>
+
+#include "tileconv.h"
+
+#define TC_CACHE_LINE 64
+
+/**
+ * Real-input FFT of n points (a power of two), computed as an n/2-point
+ * complex FFT plus a split step (fft.c).
+ */
+typedef struct {
+    int n;
+    int half;
+    int *bitrev;        // Bit-reversal permutation of the half-size transform
+    double *twiddle;    // e^{-2 pi i k / half}, interleaved, k < half / 2
+    double *post;       // e^{-2 pi i k / n}, interleaved, k < half
+} tc_fft;
+
+tc_fft *tc_fft_create(int n);
+void tc_fft_destroy(tc_fft *fft);
+void tc_fft_forward(const tc_fft *fft, const double *x, double *X);
+void tc_fft_inverse(const tc_fft *fft, double *X);
+
+/**
+ * A plan stores every shape as three axes (x, y, z); unused axes have extent 1.
+ * The kernel is stored in correlation orientation, i.e. already flipped for
+ * convolution, so every engine computes C[o] = sum_k A[o + k] * W[k].
+ */
+struct tc_plan {
+    tc_op op;
+    int dims;
+    int size_A[3];
+    int size_B[3];
+    int size_C[3];
+    int tile_A[3];
+    int tile_B[3];
+    int pad[3];     // Input offset of the output origin per axis; 0 for 'valid' output
+    tc_boundary boundary;   // What the halo reads outside A
+    int stride[3];      // Output o reads input o * stride - pad + k * dilation along each axis
+    int dilation[3];
+    int strided;        // Some stride or dilation is not 1: the direct engine's phase path runs the plan
+    void *W_phase;      // Phase path: the x taps of each kernel row grouped by input phase
+    tc_dtype dtype;
+    int *W;         // Oriented, packed kernel (size_B[0] * size_B[1] * size_B[2] elements) of int plans
+    void *W_real;   // The same for float and double plans
+    void *W_lowrank;            // Low-rank engine: per component, the x factor then the y factor
+    tc_lowrank_info lowrank;
+    void *W_winograd;           // Winograd engine: transformed kernel U (n x n, n = winograd_m + size_B - 1)
+    int winograd_m;             // Winograd engine: output tile edge
+    void *W_gemm;               // GEMM engine: kernel matrix packed by tc_gemm_pack
+    tc_pool *pool;  // Pool for 2D and 3D blocks; NULL runs on the calling thread
+    int owns_pool;  // The pool was created for this plan and is destroyed with it
+    int *W_axis[3];     // Separable engine: 1D factors with W[z][y][x] = W_axis[2][z] * W_axis[1][y] * W_axis[0][x],
+                        // all in one allocation owned by W_axis[0]
+    tc_accum accum;     // Never TC_ACCUM_AUTO
+    int overflow_free;  // The bound check proved that accum cannot overflow for the declared inputs
+
+    tc_engine engine;
+    tc_fft *fft;        // FFT engine: transform of fft->n points per overlap-save block
+    double *H;          // Spectrum of the reversed oriented kernel (fft->n + 2 doubles)
+    double fft_error;   // Worst-case FFT rounding error per unit of max |A|
+};
+
+/**
+ * Row kernel shared by all direct engines:
+ * c[j] = (first ? 0 : c[j]) + sum_k a[j + k] * w[k] for j in [0, n), k in [0, taps).
+ * Points at the widest implementation the CPU supports (row_kernels.c).
+ */
+typedef void (*tc_row_correlate_fn)(int *c, const int *a, const int *w, int taps, int n, int first);
+extern tc_row_correlate_fn tc_row_correlate;
+
+/**
+ * Column kernel of the separable engine: c[j] = sum_k t[k * pitch + j] * w[k]
+ * for j in [0, n), k in [0, taps). Applies a 1D kernel along a strided axis
+ * as unit-stride sweeps over whole rows (row_kernels.c).
+ */
+typedef void (*tc_column_correlate_fn)(int *c, const int *t, long pitch, const int *w, int taps, int n);
+extern tc_column_correlate_fn tc_column_correlate;
+
+/**
+ * Wide kernel of the 64-bit accumulator modes, covering a whole bx x by x bz
+ * kernel footprint per call so the sums never leave registers:
+ * sum_j = sum a[z * slice_a + y * row_a + j + x] * w[(z * by + y) * bx + x]
+ * for j in [0, n), written to c64[j], or clamped to the int range and written
+ * to c32[j] when c64 is NULL (row_kernels.c).
+ */
+typedef void (*tc_wide_correlate_fn)(long long *c64, int *c32, const int *a, long row_a, long slice_a,
+                                     const int *w, int bx, int by, int bz, int n);
+extern tc_wide_correlate_fn tc_wide_correlate;
+
+// Direct engines (direct.c). Pitches and slice strides are in elements.
+// tc_direct_1d computes size_C outputs whose footprints all lie inside A,
+// with C[j] starting at A[j] ('valid' alignment, whatever the plan's pad);
+// tc_direct_range_1d computes outputs [x0, x1) of the plan, halo included.
+// When C64 is not NULL the exact 64-bit sums are written there (with C's
+// strides) instead of to C; otherwise plans with a 64-bit accumulator clamp
+// their outputs to the int range.
+void tc_direct_1d(const tc_plan *plan, const int *A, int *C, long long *C64, int size_C);
+void tc_direct_range_1d(const tc_plan *plan, const int *A, int *C, long long *C64, int x0, int x1);
+void tc_direct_2d(const tc_plan *plan, const int *A, long pitch_A, int *C, long long *C64, long pitch_C);
+void tc_direct_3d(const tc_plan *plan, const int *A, long row_A, long slice_A,
+                  int *C, long long *C64, long row_C, long slice_C);
+
+/**
+ * Computes the output block of a plan whose origin (x0, y0, z0) is a multiple
+ * of its tile_A, exactly as the block loops of tc_direct_1d/2d/3d would; used
+ * by filter banks to interleave the blocks of several plans. Strides are as
+ * for tc_direct_3d (row_A is the pitch of 2D plans; 1D plans ignore them).
+ */
+void tc_direct_block(const tc_plan *plan, const int *A, long row_A, long slice_A,
+                     int *C, long row_C, long slice_C, int x0, int y0, int z0);
+
+/**
+ * Clamps the tap range of output o along one axis so that o - pad + k stays
+ * inside [0, size_A).
+ */
+static inline void tc_clamp_taps(int o, int pad, int size_A, int size_B, int *k_lo, int *k_hi) {
+    int start = o - pad;
+    *k_lo = start < 0 ? -start : 0;
+    *k_hi = (size_A - start < size_B) ? size_A - start : size_B;
+}
+
+/**
+ * Maps input index i of an axis of size samples, possibly outside [0, size),
+ * to the sample a non-zero boundary extension reads there.
+ */
+static inline int tc_extend_index(int i, int size, tc_boundary boundary) {
+    if (i >= 0 && i < size) return i;
+    switch (boundary) {
+        case TC_BOUNDARY_REPLICATE:
+            return i < 0 ? 0 : size - 1;
+        case TC_BOUNDARY_WRAP:
+            // Halos within one period skip the division
+            if (i < 0 && i >= -size) return i + size;
+            if (i >= size && i < 2 * size) return i - size;
+            i %= size;
+            return i < 0 ? i + size : i;
+        default:
+            if (i < 0 && i >= -size) return -1 - i;
+            if (i >= size && i < 2 * size) return 2 * size - 1 - i;
+            i %= 2 * size;
+            if (i < 0) i += 2 * size;
+            return i < size ? i : 2 * size - 1 - i;
+    }
+}
+
+/**
+ * Phase split of the x axis of a strided or dilated plan. With g the gcd of
+ * stride s and dilation d, outputs o = p + out_phases * m (p < out_phases =
+ * d / g) and taps k = r + in_phases * t (r < in_phases = s / g) read input
+ * (o0 + p) * s - pad + r * d + (m + t) * step, step = d * s / g, relative to
+ * the first output o0. Every (p, r) pair is a dense correlation of a
+ * de-interleaved input run with the taps of phase r, which W_phase stores
+ * contiguously per kernel row, phase after phase.
+ */
+static inline void tc_phase_split(const tc_plan *plan, int *in_phases, int *out_phases, int *step) {
+    int s = plan->stride[0], d = plan->dilation[0], g = s, b = d;
+    while (b) {
+        int t = g % b;
+        g = b;
+        b = t;
+    }
+    *in_phases = s / g;
+    *out_phases = d / g;
+    *step = d * (s / g);
+}
+
+/**
+ * Output range [lo, hi) per axis whose whole kernel footprint lies inside the
+ * input, i.e. outputs o with 0 <= o - pad and o - pad + size_B <= size_A.
+ */
+static inline void tc_interior_range(const tc_plan *plan, int lo[3], int hi[3]) {
+    for (int axis = 0; axis < 3; axis++) {
+        int size_C = plan->size_C[axis];
+        lo[axis] = plan->pad[axis] < size_C ? plan->pad[axis] : size_C;
+        hi[axis] = plan->pad[axis] + plan->size_A[axis] - plan->size_B[axis] + 1;
+        if (hi[axis] > size_C) hi[axis] = size_C;
+        if (hi[axis] < lo[axis]) hi[axis] = lo[axis];
+    }
+}
+
+/*
+ * Boundary and phase index math of the direct engines. It does not depend on
+ * the element type, so the int engine (direct.c) and the float / double one
+ * (real_engine.h) share it, together with the sample loops of halo_engine.h.
+ */
+
+// Outputs per chunk of a halo span or of a phase path fill
+#define TC_HALO_CHUNK 512
+
+// Output rows per fill of the phase path's split scratch
+#define TC_PHASE_ROWS 16
+
+/**
+ * Maps input index i of axis to the row or sample the plan reads there.
+ *
+ * @return The index, or -1 for a zero outside A
+ */
+static inline int tc_source_index(const tc_plan *plan, int axis, int i) {
+    if (i >= 0 && i < plan->size_A[axis]) return i;
+    return plan->boundary == TC_BOUNDARY_ZERO ? -1 : tc_extend_index(i, plan->size_A[axis], plan->boundary);
+}
+
+/**
+ * Picks the outputs of a boundary row [x0, x1) that the row kernels compute
+ * through a halo span: all of them for kernels narrower than TC_HALO_CHUNK / 2,
+ * else those inside along x, whose input runs need no gather. The rest of the
+ * row, [x0, sx0) and [sx1, x1), is left to the caller.
+ *
+ * @return 1 if [*sx0, *sx1) is not empty, 0 if every output takes the
+ *         clamped tap-by-tap path
+ */
+static inline int tc_halo_split(const tc_plan *plan, int x0, int x1, int *sx0, int *sx1) {
+    if (plan->size_B[0] <= TC_HALO_CHUNK / 2) {
+        *sx0 = x0;
+        *sx1 = x1;
+        return 1;
+    }
+    int lo[3], hi[3];
+    tc_interior_range(plan, lo, hi);
+    *sx0 = x0 > lo[0] ? x0 : lo[0];
+    *sx1 = x1 < hi[0] ? x1 : hi[0];
+    return *sx0 < *sx1;
+}
+
+/**
+ * Input samples along x read by n consecutive outputs of a strided or
+ * dilated plan.
+ */
+static inline long tc_phase_span(const tc_plan *plan, int n) {
+    return (long)(n - 1) * plan->stride[0] + (long)(plan->size_B[0] - 1) * plan->dilation[0] + 1;
+}
+
+/**
+ * Input rows read by rows consecutive output rows of a strided or dilated plan.
+ */
+static inline int tc_phase_rows(const tc_plan *plan, int rows) {
+    return (rows - 1) * plan->stride[1] + plan->dilation[1] * (plan->size_B[1] - 1) + 1;
+}
+
+/**
+ * Scratch layout of the phase path for a box of width x height outputs: each
+ * fill splits rows input rows (rows_y per slice, rows_z slices) of span
+ * samples into step phases of len samples, for chunk outputs of up to
+ * TC_PHASE_ROWS output rows. The scratch holds the split rows, then one
+ * gathered row of span samples, then out_phases runs of m_max outputs.
+ */
+typedef struct {
+    int in_phases, out_phases, step;   // As set by tc_phase_split
+    int chunk, m_max;                  // Outputs per fill row, and per output phase
+    long span, len;                    // Input samples per fill row, and per phase
+    int rows_y, rows_z;
+    long rows;
+} tc_phase_layout;
+
+static inline void tc_phase_layout_init(const tc_plan *plan, int width, int height, tc_phase_layout *layout) {
+    tc_phase_split(plan, &layout->in_phases, &layout->out_phases, &layout->step);
+    layout->chunk = width < TC_HALO_CHUNK ? width : TC_HALO_CHUNK;
+    layout->m_max = (layout->chunk + layout->out_phases - 1) / layout->out_phases;
+    layout->span = tc_phase_span(plan, layout->chunk);
+    layout->len = (layout->span + layout->step - 1) / layout->step;
+    layout->rows_y = tc_phase_rows(plan, height < TC_PHASE_ROWS ? height : TC_PHASE_ROWS);
+    layout->rows_z = plan->dilation[2] * (plan->size_B[2] - 1) + 1;
+    layout->rows = (long)layout->rows_y * layout->rows_z;
+}
+
+// Elements of phase path scratch for layout
+static inline long tc_phase_scratch(const tc_phase_layout *layout) {
+    return layout->rows * layout->step * layout->len + layout->span + (long)layout->out_phases * layout->m_max;
+}
+
+/**
+ * Index into the fill's split rows of kernel row ky of slice kz for output
+ * row dy of the fill, which holds ny input rows per slice.
+ */
+static inline long tc_phase_fill_row(const tc_plan *plan, int ny, int dy, int ky, int kz) {
+    return (long)kz * plan->dilation[2] * ny + (long)dy * plan->stride[1] + (long)ky * plan->dilation[1];
+}
+
+/**
+ * Offset in a split row of the run read by taps of input phase r for the
+ * outputs of output phase p; the phase has tc_phase_taps taps.
+ */
+static inline long tc_phase_run(const tc_plan *plan, const tc_phase_layout *layout, int p, int r) {
+    long start = (long)p * plan->stride[0] + (long)r * plan->dilation[0];
+    return start % layout->step * layout->len + start / layout->step;
+}
+
+static inline int tc_phase_taps(const tc_plan *plan, const tc_phase_layout *layout, int r) {
+    return (plan->size_B[0] - r + layout->in_phases - 1) / layout->in_phases;
+}
+
+// Float and double engines (real.c, generated from real_engine.h), with the
+// same blocking and strides as the int ones
+void tc_direct_1d_f(const tc_plan *plan, const float *A, float *C, int size_C);
+void tc_direct_2d_f(const tc_plan *plan, const float *A, long pitch_A, float *C, long pitch_C);
+void tc_direct_3d_f(const tc_plan *plan, const float *A, long row_A, long slice_A,
+                    float *C, long row_C, long slice_C);
+void tc_direct_1d_d(const tc_plan *plan, const double *A, double *C, int size_C);
+void tc_direct_2d_d(const tc_plan *plan, const double *A, long pitch_A, double *C, long pitch_C);
+void tc_direct_3d_d(const tc_plan *plan, const double *A, long row_A, long slice_A,
+                    double *C, long row_C, long slice_C);
+void tc_direct_block_f(const tc_plan *plan, const float *A, long row_A, long slice_A,
+                       float *C, long row_C, long slice_C, int x0, int y0, int z0);
+void tc_direct_block_d(const tc_plan *plan, const double *A, long row_A, long slice_A,
+                       double *C, long row_C, long slice_C, int x0, int y0, int z0);
+
+/**
+ * Decomposes the kernel of a float or double 2D plan for the low-rank engine
+ * and, when that saves work, switches the plan to it (lowrank.c).
+ *
+ * @return 0, or -1 if memory allocation failed
+ */
+int tc_lowrank_plan(tc_plan *plan, double tolerance);
+
+/**
+ * Switches a 2D plan that requested TC_ENGINE_WINOGRAD to it when the kernel
+ * is square 3 x 3 or 5 x 5 and, for int plans, the declared input range keeps
+ * the scaled transforms inside the int range (winograd.c).
+ *
+ * @return 0, or -1 if memory allocation failed
+ */
+int tc_winograd_plan(tc_plan *plan, const tc_options *opts);
+
+// Winograd engine on the whole m x m tiles of a height x width output tile at
+// (i_tile, j_tile); the remaining rows and columns are left to the caller.
+// Returns 0, or -1 if the scratch rows could not be allocated.
+int tc_winograd_tile_2d(const tc_plan *plan, const int *A, long pitch_A, int *C, long pitch_C,
+                        int i_tile, int j_tile, int height, int width);
+int tc_winograd_tile_2d_f(const tc_plan *plan, const float *A, long pitch_A, float *C, long pitch_C,
+                          int i_tile, int j_tile, int height, int width);
+int tc_winograd_tile_2d_d(const tc_plan *plan, const double *A, long pitch_A, double *C, long pitch_C,
+                          int i_tile, int j_tile, int height, int width);
+void tc_winograd_select_kernels(const char *isa);
+
+/**
+ * Packs kernels x K kernel values of dtype (kernel q at W + q * K) for the
+ * GEMM micro-kernel into a new allocation at *packed (gemm.c).
+ *
+ * @return 0, or -1 if memory allocation failed
+ */
+int tc_gemm_pack(const void *W, int kernels, long K, tc_dtype dtype, void **packed);
+
+/**
+ * Switches a 2D plan that requested TC_ENGINE_GEMM to it (int plans need the
+ * 32-bit accumulator).
+ *
+ * @return 0, or -1 if memory allocation failed
+ */
+int tc_gemm_plan(tc_plan *plan, const tc_options *opts);
+
+// GEMM engine on a height x width output tile at (i_tile, j_tile)
+void tc_gemm_tile_2d(const tc_plan *plan, const int *A, long pitch_A, int *C, long pitch_C,
+                     int i_tile, int j_tile, int height, int width);
+void tc_gemm_tile_2d_f(const tc_plan *plan, const float *A, long pitch_A, float *C, long pitch_C,
+                       int i_tile, int j_tile, int height, int width);
+void tc_gemm_tile_2d_d(const tc_plan *plan, const double *A, long pitch_A, double *C, long pitch_C,
+                       int i_tile, int j_tile, int height, int width);
+void tc_gemm_select_kernels(const char *isa);
+
+/**
+ * Runs kernels 2D kernels of the same size_B, packed by tc_gemm_pack, as one
+ * GEMM over output rows [y0, y1), columns [x0, x1): every packed input panel
+ * is multiplied with all of them. Kernel q writes to C[q]; all outputs have
+ * rows pitch_C elements apart.
+ */
+void tc_gemm_block_2d(tc_dtype dtype, const void *Wp, int kernels, const int size_B[3],
+                      const void *A, long pitch_A, void *const *C, long pitch_C, int y0, int y1, int x0, int x1);
+
+// Points the float and double row kernels at the ISA picked for the int ones
+// ("scalar", "avx2" or "avx512"); called by the load-time selection in row_kernels.c
+void tc_real_select_kernels(const char *isa);
+
+/**
+ * Plan constructor shared by all element types (plan.c). Shapes are x, y, z
+ * extents and B holds size_B elements of dtype.
+ */
+tc_plan *tc_plan_create_typed(tc_op op, int dims, const int size_A[3],
+                              const void *B, const int size_B[3], tc_dtype dtype,
+                              const tc_options *opts);
+
+/**
+ * Filter bank constructor shared by all element types (bank.c). size_B[axis]
+ * holds the extent of every kernel along axis, or is NULL for extent 1.
+ */
+tc_bank *tc_bank_create_typed(tc_op op, int dims, const int size_A[3], int count,
+                              const void *const *B, const int *const size_B[3], tc_dtype dtype,
+                              const tc_options *opts);
+
+// Runs a bank of any element type; C[k] receives the output of kernel k
+void tc_bank_run(const tc_bank *bank, const void *A, void *const *C);
+
+/**
+ * Multi-channel layer constructor shared by all element types (layer.c).
+ * Shapes are x, y extents; the kernels are packed by the typed constructors.
+ */
+tc_layer *tc_layer_create_typed(int channels_in, const int size_A[2], int channels_out, const int size_B[2],
+                                tc_dtype dtype, const tc_options *opts);
+
+// Runs a layer of any element type on batch images in the blocked layout
+void tc_layer_run(const tc_layer *layer, int batch, const void *A, void *C);
+
+// Points the layer kernels of every element type at the ISA of the row kernels
+void tc_layer_select_kernels(const char *isa);
+
+// FFT engine (fft_conv.c). tc_fft_plan_1d picks direct or FFT for a 1D plan
+// whose engine is TC_ENGINE_AUTO or TC_ENGINE_FFT; it returns -1 on allocation failure.
+int tc_fft_plan_1d(tc_plan *plan);
+void tc_fft_execute_1d(const tc_plan *plan, const int *A, int *C, long long *C64);
+void tc_fft_plan_free(tc_plan *plan);
+
+// Monotonic wall-clock time in seconds (timer.c)
+double tc_now(void);
+
+// 64-byte aligned allocation, released with free() (matrix.c)
+void *tc_alloc_aligned(size_t bytes);
+
+#endif
@@ -0,0 +1,9 @@
+#include <time.h>
+
+#include "tileconv_internal.h"
+
+double tc_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,943 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tileconv_internal.h"
+
+// Search limits: default time budget and the configurations one search may time
+#define TUNE_DEFAULT_BUDGET 10.0
+#define TUNE_MAX_CONFIGS 512
+#define TUNE_MAX_PASSES 3
+
+// A configuration is timed at least TUNE_MIN_REPS times and for at least
+// TUNE_MIN_SECONDS (capped at TUNE_MAX_REPS runs); its time is the minimum run
+#define TUNE_MIN_REPS 3
+#define TUNE_MAX_REPS 50
+#define TUNE_MIN_SECONDS 0.02
+
+// 3D search: random samples ranked by successive halving on a proxy problem
+// whose output extent is halved per axis (but kept at TUNE_PROXY_MIN_EXTENT),
+// using TUNE_PROXY_SHARE of the budget; TUNE_SURVIVORS go on to the real size
+#define TUNE_SAMPLES 48
+#define TUNE_SURVIVORS 4
+#define TUNE_PROXY_SHARE 0.5
+#define TUNE_PROXY_MIN_EXTENT 16
+#define TUNE_MAX_VALUES 72
+
+// Runs of the winner behind its confidence interval
+#define TUNE_CI_MIN_RUNS 5
+#define TUNE_CI_MAX_RUNS 30
+
+#define TUNE_DB_ENV "TILECONV_TUNING_DB"
+#define TUNE_DB_DEFAULT_NAME ".tileconv_tuning"
+#define TUNE_PATH_MAX 4096
+#define TUNE_LINE_MAX 1024
+
+/**
+ * One database entry. Only entries recorded on this CPU model and row-kernel
+ * ISA are loaded, so those two fields are not stored. Everything up to tile_A
+ * is the key: the output mode, boundary, stride, dilation and accumulator
+ * change the work the tiles are tuned for, and the requested engine limits
+ * what the search tried (a TC_ENGINE_DIRECT tuning never times FFT).
+ */
+typedef struct {
+    tc_op op;
+    int dims;
+    int size_A[3];
+    int size_B[3];
+    int threads;
+    tc_output output;
+    tc_boundary boundary;
+    int stride[3];      // 1 for unit stride, never 0
+    int dilation[3];
+    tc_accum accum;
+    int requested;      // Engine of the tuned options, or -1 for lines that predate it
+    int tile_A[3];
+    int tile_B[3];
+    tc_engine engine;
+    double seconds;
+} tune_entry;
+
+/**
+ * Process-wide view of the database, loaded lazily on the first lookup and
+ * kept in sync with everything this process appends.
+ */
+static struct {
+    pthread_mutex_t lock;
+    int path_set;               // tc_tune_set_db_path was called
+    char path[TUNE_PATH_MAX];   // Empty when the database is disabled
+    int loaded;
+    tune_entry *entries;
+    int count;
+    int capacity;
+} db = {PTHREAD_MUTEX_INITIALIZER, 0, "", 0, NULL, 0, 0};
+
+static pthread_once_t cpu_once = PTHREAD_ONCE_INIT;
+static char cpu_model[256] = "unknown";
+
+static void read_cpu_model(void) {
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (!f) return;
+    char line[TUNE_LINE_MAX];
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "model name", 10) != 0) continue;
+        char *value = strchr(line, ':');
+        if (!value) continue;
+        value++;
+        while (*value == ' ' || *value == '\t') value++;
+        value[strcspn(value, "\t\n")] = '\0';
+        if (*value) snprintf(cpu_model, sizeof(cpu_model), "%s", value);
+        break;
+    }
+    fclose(f);
+}
+
+const char *tc_cpu_model(void) {
+    pthread_once(&cpu_once, read_cpu_model);
+    return cpu_model;
+}
+
+static const char *op_name(tc_op op) {
+    return op == TC_CONVOLUTION ? "conv" : "xcorr";
+}
+
+static const char *engine_name(tc_engine engine) {
+    return engine == TC_ENGINE_FFT ? "fft" : "direct";
+}
+
+static const char *const output_names[] = {"valid", "same", "full"};
+static const char *const boundary_names[] = {"zero", "reflect", "replicate", "wrap"};
+static const char *const accum_names[] = {"auto", "int32", "int64", "sat32"};
+static const char *const requested_names[] = {"auto", "direct", "fft", "separable", "lowrank", "winograd", "gemm"};
+
+/**
+ * Finds name in a table of count names.
+ *
+ * @return Its index, or -1 if it is not there
+ */
+static int name_index(const char *const *names, int count, const char *name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(names[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+/**
+ * Threads a plan created with opts would run on; 1D plans are always single-threaded.
+ */
+static int effective_threads(int dims, const tc_options *opts) {
+    if (dims == 1 || !opts) return 1;
+    if (opts->pool) return tc_pool_size(opts->pool);
+    return opts->threads > 1 ? opts->threads : 1;
+}
+
+/**
+ * Fills the key fields of an entry for a plan created with opts (NULL for
+ * the defaults).
+ */
+static void make_key(tune_entry *key, tc_op op, int dims, const int size_A[3], const int size_B[3],
+                     const tc_options *opts) {
+    tc_options defaults;
+    if (!opts) {
+        tc_options_init(&defaults);
+        opts = &defaults;
+    }
+    memset(key, 0, sizeof(*key));
+    key->op = op;
+    key->dims = dims;
+    key->threads = effective_threads(dims, opts);
+    key->output = opts->output;
+    key->boundary = opts->boundary;
+    key->accum = opts->accum;
+    key->requested = opts->engine;
+    for (int axis = 0; axis < 3; axis++) {
+        key->size_A[axis] = size_A[axis];
+        key->size_B[axis] = size_B[axis];
+        key->stride[axis] = opts->stride[axis] > 1 ? opts->stride[axis] : 1;
+        key->dilation[axis] = opts->dilation[axis] > 1 ? opts->dilation[axis] : 1;
+    }
+}
+
+/**
+ * Resolves the database path into db.path. Must be called with db.lock held.
+ */
+static void resolve_path(void) {
+    if (db.path_set) return;
+    const char *env = getenv(TUNE_DB_ENV);
+    const char *home = getenv("HOME");
+    if (env) {
+        snprintf(db.path, sizeof(db.path), "%s", env);
+    } else if (home && *home) {
+        snprintf(db.path, sizeof(db.path), "%s/%s", home, TUNE_DB_DEFAULT_NAME);
+    } else {
+        db.path[0] = '\0';
+    }
+    db.path_set = 1;
+}
+
+static int add_entry(const tune_entry *entry) {
+    if (db.count == db.capacity) {
+        int capacity = db.capacity ? db.capacity * 2 : 64;
+        tune_entry *entries = (tune_entry *)realloc(db.entries, (size_t)capacity * sizeof(tune_entry));
+        if (!entries) return -1;
+        db.entries = entries;
+        db.capacity = capacity;
+    }
+    db.entries[db.count++] = *entry;
+    return 0;
+}
+
+static int parse_triple(const char *s, int v[3]) {
+    return sscanf(s, "%dx%dx%d", &v[0], &v[1], &v[2]) == 3 ? 0 : -1;
+}
+
+/**
+ * Parses one database line. Lines from other CPUs or ISAs, comments and
+ * malformed lines are skipped. Lines without the output, boundary, stride,
+ * dilation and accumulator fields were written before those options existed
+ * and stand for the defaults. Lines without the requested engine match any
+ * request, but their engine choice is not applied (see tuned_engine).
+ *
+ * @return 0 if the line produced an entry for this machine, -1 otherwise
+ */
+static int parse_line(char *line, tune_entry *entry) {
+    if (line[0] == '#' || line[0] == '\n') return -1;
+    line[strcspn(line, "\n")] = '\0';
+
+    char *field[17] = {NULL};
+    int fields = 0;
+    char *p = line;
+    while (fields < 17) {
+        field[fields++] = p;
+        p = strchr(p, '\t');
+        if (!p) break;
+        *p++ = '\0';
+    }
+    if ((fields != 11 && fields != 16 && fields != 17) || p) return -1;
+
+    if (strcmp(field[0], tc_cpu_model()) != 0 || strcmp(field[1], tc_isa()) != 0) return -1;
+    if (strcmp(field[2], "conv") == 0) {
+        entry->op = TC_CONVOLUTION;
+    } else if (strcmp(field[2], "xcorr") == 0) {
+        entry->op = TC_CROSS_CORRELATION;
+    } else {
+        return -1;
+    }
+    entry->dims = atoi(field[3]);
+    entry->threads = atoi(field[6]);
+    entry->engine = strcmp(field[9], "fft") == 0 ? TC_ENGINE_FFT : TC_ENGINE_DIRECT;
+    entry->seconds = atof(field[10]);
+    if (parse_triple(field[4], entry->size_A) || parse_triple(field[5], entry->size_B) ||
+        parse_triple(field[7], entry->tile_A) || parse_triple(field[8], entry->tile_B)) {
+        return -1;
+    }
+    if (entry->dims < 1 || entry->dims > 3) return -1;
+
+    entry->output = TC_OUTPUT_VALID;
+    entry->boundary = TC_BOUNDARY_ZERO;
+    entry->accum = TC_ACCUM_AUTO;
+    entry->requested = -1;
+    for (int axis = 0; axis < 3; axis++) entry->stride[axis] = entry->dilation[axis] = 1;
+    if (fields >= 16) {
+        int output = name_index(output_names, 3, field[11]);
+        int boundary = name_index(boundary_names, 4, field[12]);
+        int accum = name_index(accum_names, 4, field[15]);
+        if (output < 0 || boundary < 0 || accum < 0) return -1;
+        if (parse_triple(field[13], entry->stride) || parse_triple(field[14], entry->dilation)) return -1;
+        entry->output = (tc_output)output;
+        entry->boundary = (tc_boundary)boundary;
+        entry->accum = (tc_accum)accum;
+    }
+    if (fields == 17) {
+        entry->requested = name_index(requested_names, 7, field[16]);
+        if (entry->requested < 0) return -1;
+    }
+    return 0;
+}
+
+/**
+ * Loads the database file once. Must be called with db.lock held.
+ */
+static void load(void) {
+    if (db.loaded) return;
+    db.loaded = 1;
+    resolve_path();
+    if (!db.path[0]) return;
+
+    FILE *f = fopen(db.path, "r");
+    if (!f) return;
+    char line[TUNE_LINE_MAX];
+    tune_entry entry;
+    while (fgets(line, sizeof(line), f)) {
+        if (parse_line(line, &entry) == 0 && add_entry(&entry) != 0) break;
+    }
+    fclose(f);
+}
+
+static int same_key(const tune_entry *e, const tune_entry *key) {
+    if (e->op != key->op || e->dims != key->dims || e->threads != key->threads) return 0;
+    if (e->output != key->output || e->boundary != key->boundary || e->accum != key->accum) return 0;
+    if (e->requested >= 0 && e->requested != key->requested) return 0;
+    for (int axis = 0; axis < 3; axis++) {
+        if (e->size_A[axis] != key->size_A[axis] || e->size_B[axis] != key->size_B[axis]) return 0;
+        if (e->stride[axis] != key->stride[axis] || e->dilation[axis] != key->dilation[axis]) return 0;
+    }
+    return 1;
+}
+
+/**
+ * Engine a hit on entry gives a plan requesting engine: the tuned choice
+ * for 1D AUTO plans whose entry was also tuned with AUTO, else engine itself.
+ */
+static tc_engine tuned_engine(const tune_entry *entry, int dims, tc_engine engine) {
+    if (engine == TC_ENGINE_AUTO && dims == 1 && entry->requested == TC_ENGINE_AUTO) return entry->engine;
+    return engine;
+}
+
+/**
+ * Finds the newest entry for a key and copies it to out.
+ *
+ * @return 1 if found, 0 otherwise
+ */
+static int find(const tune_entry *key, tune_entry *out) {
+    int found = 0;
+    pthread_mutex_lock(&db.lock);
+    load();
+    for (int i = db.count - 1; i >= 0; i--) {
+        if (same_key(&db.entries[i], key)) {
+            *out = db.entries[i];
+            found = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&db.lock);
+    return found;
+}
+
+/**
+ * Appends an entry to the database file and the in-memory view.
+ *
+ * @return 0 on success, -1 if the database is disabled or cannot be written
+ */
+static int save(const tune_entry *e) {
+    int status = -1;
+    pthread_mutex_lock(&db.lock);
+    load();
+    if (db.path[0]) {
+        FILE *f = fopen(db.path, "a");
+        if (f) {
+            fseek(f, 0, SEEK_END);
+            if (ftell(f) == 0) {
+                fprintf(f, "# tileconv tuning database: cpu isa op dims size_A size_B "
+                           "threads tile_A tile_B engine seconds output boundary stride dilation accum requested\n");
+            }
+            fprintf(f, "%s\t%s\t%s\t%d\t%dx%dx%d\t%dx%dx%d\t%d\t%dx%dx%d\t%dx%dx%d\t%s\t%.9f"
+                       "\t%s\t%s\t%dx%dx%d\t%dx%dx%d\t%s\t%s\n",
+                    tc_cpu_model(), tc_isa(), op_name(e->op), e->dims,
+                    e->size_A[0], e->size_A[1], e->size_A[2],
+                    e->size_B[0], e->size_B[1], e->size_B[2], e->threads,
+                    e->tile_A[0], e->tile_A[1], e->tile_A[2],
+                    e->tile_B[0], e->tile_B[1], e->tile_B[2],
+                    engine_name(e->engine), e->seconds,
+                    output_names[e->output], boundary_names[e->boundary],
+                    e->stride[0], e->stride[1], e->stride[2],
+                    e->dilation[0], e->dilation[1], e->dilation[2], accum_names[e->accum],
+                    requested_names[e->requested]);
+            if (fclose(f) == 0) status = 0;
+        }
+        add_entry(e);
+    }
+    pthread_mutex_unlock(&db.lock);
+    return status;
+}
+
+void tc_tune_set_db_path(const char *path) {
+    pthread_mutex_lock(&db.lock);
+    if (path) {
+        snprintf(db.path, sizeof(db.path), "%s", path);
+        db.path_set = 1;
+    } else {
+        db.path_set = 0;
+    }
+    // The next lookup reads the new file
+    db.loaded = 0;
+    db.count = 0;
+    pthread_mutex_unlock(&db.lock);
+}
+
+const char *tc_tune_db_path(void) {
+    pthread_mutex_lock(&db.lock);
+    resolve_path();
+    const char *path = db.path[0] ? db.path : NULL;
+    pthread_mutex_unlock(&db.lock);
+    return path;
+}
+
+int tc_tune_lookup(tc_op op, int dims, const int size_A[3], const int size_B[3],
+                   tc_options *opts) {
+    tune_entry key, entry;
+    make_key(&key, op, dims, size_A, size_B, opts);
+    if (!find(&key, &entry)) return 0;
+
+    for (int axis = 0; axis < 3; axis++) {
+        opts->tile_A[axis] = entry.tile_A[axis];
+        opts->tile_B[axis] = entry.tile_B[axis];
+    }
+    opts->engine = tuned_engine(&entry, dims, opts->engine);
+    return 1;
+}
+
+/**
+ * One search problem: a shape with random operands and every configuration
+ * timed on it so far, so no configuration is timed twice. A configuration is
+ * tile_A then tile_B per axis.
+ */
+typedef struct {
+    tc_op op;
+    int dims;
+    int size_A[3];
+    int size_B[3];
+    int size_C[3];      // Output extents of the base options (mode, stride, dilation)
+    int *A;
+    int *B;
+    int *C;
+    int configs[TUNE_MAX_CONFIGS][6];
+    double times[TUNE_MAX_CONFIGS];     // Fastest run seen so far
+    int reps[TUNE_MAX_CONFIGS];         // Timed runs behind times[i]
+    int evaluated;
+} tuner;
+
+static unsigned int next_random(unsigned int *seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return *seed >> 16;
+}
+
+static void tuner_destroy(tuner *t) {
+    if (!t) return;
+    free(t->A);
+    free(t->B);
+    free(t->C);
+    free(t);
+}
+
+static tc_plan *create_plan(const tuner *t, const tc_options *opts);
+
+/**
+ * Allocates a problem of the given shape. Timing does not depend on the
+ * values, so they come from a fixed LCG that leaves the caller's rand() state
+ * alone. C is sized from a plan with the base options, so 'same' and 'full'
+ * output and strides get the extents they really write.
+ *
+ * @return The problem, or NULL if the base options reject the shape or memory
+ *         allocation failed
+ */
+static tuner *tuner_create(tc_op op, int dims, const int size_A[3], const int size_B[3],
+                           const tc_options *base) {
+    tuner *t = (tuner *)calloc(1, sizeof(tuner));
+    if (!t) return NULL;
+    t->op = op;
+    t->dims = dims;
+    long count_A = 1, count_B = 1;
+    for (int axis = 0; axis < 3; axis++) {
+        t->size_A[axis] = size_A[axis];
+        t->size_B[axis] = size_B[axis];
+        count_A *= size_A[axis];
+        count_B *= size_B[axis];
+    }
+    t->A = (int *)tc_alloc_aligned((size_t)count_A * sizeof(int));
+    t->B = (int *)malloc((size_t)count_B * sizeof(int));
+    if (!t->A || !t->B) {
+        tuner_destroy(t);
+        return NULL;
+    }
+
+    unsigned int seed = 12345;
+    for (long i = 0; i < count_A; i++) t->A[i] = (int)(next_random(&seed) % 100);
+    for (long i = 0; i < count_B; i++) t->B[i] = (int)(next_random(&seed) % 100);
+
+    tc_plan *probe = create_plan(t, base);
+    if (!probe) {
+        tuner_destroy(t);
+        return NULL;
+    }
+    for (int axis = 0; axis < 3; axis++) t->size_C[axis] = tc_plan_output_size(probe, axis);
+    t->C = (int *)tc_alloc_aligned((size_t)tc_plan_output_count(probe) * sizeof(int));
+    tc_plan_destroy(probe);
+    if (!t->C) {
+        tuner_destroy(t);
+        return NULL;
+    }
+    return t;
+}
+
+static tc_plan *create_plan(const tuner *t, const tc_options *opts) {
+    switch (t->dims) {
+        case 1:
+            return tc_plan_create_1d(t->op, t->size_A[0], t->B, t->size_B[0], opts);
+        case 2:
+            return tc_plan_create_2d(t->op, t->size_A[1], t->size_A[0], t->B,
+                                     t->size_B[1], t->size_B[0], opts);
+        default:
+            return tc_plan_create_3d(t->op, t->size_A[0], t->size_A[1], t->size_A[2], t->B,
+                                     t->size_B[0], t->size_B[1], t->size_B[2], opts);
+    }
+}
+
+/**
+ * Creates a direct-engine plan with the tiles of config.
+ */
+static tc_plan *create_config_plan(const tuner *t, const tc_options *base, const int config[6]) {
+    tc_options opts = *base;
+    opts.engine = TC_ENGINE_DIRECT;
+    for (int axis = 0; axis < 3; axis++) {
+        opts.tile_A[axis] = config[axis];
+        opts.tile_B[axis] = config[3 + axis];
+    }
+    return create_plan(t, &opts);
+}
+
+/**
+ * Times one plan: a warm-up run, then at least min_reps runs and at least
+ * TUNE_MIN_SECONDS (up to TUNE_MAX_REPS runs unless min_reps asks for more).
+ *
+ * @return The fastest run in seconds; *reps receives the number of timed runs
+ */
+static double time_plan(const tuner *t, const tc_plan *plan, int min_reps, int *reps) {
+    tc_execute(plan, t->A, t->C);
+
+    int max_reps = min_reps > TUNE_MAX_REPS ? min_reps : TUNE_MAX_REPS;
+    double best = 0.0;
+    double start = tc_now();
+    int done = 0;
+    while (done < max_reps && (done < min_reps || tc_now() - start < TUNE_MIN_SECONDS)) {
+        double t0 = tc_now();
+        tc_execute(plan, t->A, t->C);
+        double elapsed = tc_now() - t0;
+        if (done == 0 || elapsed < best) best = elapsed;
+        done++;
+    }
+    if (reps) *reps = done;
+    return best;
+}
+
+/**
+ * Times the direct engine with the tiles of config using at least min_reps
+ * runs in total. A configuration timed before is only run again when it needs
+ * more runs, and its time stays the fastest run seen.
+ *
+ * @return Seconds per execution, or -1 if the plan could not be created
+ */
+static double evaluate(tuner *t, const tc_options *base, const int config[6], int min_reps) {
+    int slot = -1;
+    for (int i = 0; i < t->evaluated; i++) {
+        if (memcmp(t->configs[i], config, sizeof(t->configs[i])) == 0) {
+            if (t->reps[i] >= min_reps) return t->times[i];
+            slot = i;
+            break;
+        }
+    }
+
+    tc_plan *plan = create_config_plan(t, base, config);
+    if (!plan) return -1.0;
+    int reps;
+    double seconds = time_plan(t, plan, slot >= 0 ? min_reps - t->reps[slot] : min_reps, &reps);
+    tc_plan_destroy(plan);
+
+    if (slot < 0 && t->evaluated < TUNE_MAX_CONFIGS) {
+        slot = t->evaluated++;
+        memcpy(t->configs[slot], config, sizeof(t->configs[0]));
+        t->times[slot] = seconds;
+        t->reps[slot] = 0;
+    }
+    if (slot >= 0) {
+        if (seconds < t->times[slot]) t->times[slot] = seconds;
+        t->reps[slot] += reps;
+        seconds = t->times[slot];
+    }
+    return seconds;
+}
+
+/**
+ * Power-of-two candidates of one tile parameter, from lo up to the extent,
+ * plus the extent itself.
+ *
+ * @return The number of candidates written to values
+ */
+static int candidates(int lo, int extent, int *values) {
+    int count = 0;
+    for (int v = lo; v < extent; v *= 2) {
+        values[count++] = v;
+    }
+    values[count++] = extent;
+    return count;
+}
+
+static int compare_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Dense candidates of one 3D tile parameter: 1, 2, 3, 4, 6, 8, 12, ... below
+ * the extent, the extent split into two, three and four even tiles, and the
+ * extent itself, so tiles that divide the volume evenly are not missed.
+ *
+ * @return The number of distinct candidates written to values (at most TUNE_MAX_VALUES)
+ */
+static int dense_candidates(int extent, int *values) {
+    int count = 0;
+    for (long v = 1; v < extent && count < TUNE_MAX_VALUES - 4; v *= 2) {
+        values[count++] = (int)v;
+        if (v >= 2 && v + v / 2 < extent) values[count++] = (int)(v + v / 2);
+    }
+    for (int parts = 2; parts <= 4; parts++) {
+        values[count++] = (extent + parts - 1) / parts;
+    }
+    values[count++] = extent;
+
+    qsort(values, count, sizeof(int), compare_int);
+    int unique = 0;
+    for (int i = 0; i < count; i++) {
+        if (unique == 0 || values[i] != values[unique - 1]) values[unique++] = values[i];
+    }
+    return unique;
+}
+
+/**
+ * Neighbours of a tile value for local refinement: +-1, +-25% and x2 / /2,
+ * clamped to [1, extent] and excluding the value itself.
+ *
+ * @return The number of distinct neighbours written to out
+ */
+static int neighbours(int value, int extent, int *out) {
+    int raw[6] = {value - 1, value + 1, value * 3 / 4, (value * 5 + 3) / 4, value / 2, value * 2};
+    int count = 0;
+    for (int i = 0; i < 6; i++) {
+        int v = raw[i] < 1 ? 1 : (raw[i] > extent ? extent : raw[i]);
+        int seen = (v == value);
+        for (int j = 0; j < count; j++) seen |= (out[j] == v);
+        if (!seen) out[count++] = v;
+    }
+    return count;
+}
+
+/**
+ * Coordinate descent for 1D and 2D: starting from config, tries every
+ * power-of-two value of one parameter at a time until a whole pass changes
+ * nothing or the deadline passes. The 2D engine applies whole kernel rows,
+ * so its tile_B is not searched.
+ *
+ * @return The best time found, or -1 if no plan could be created
+ */
+static double search_descent(tuner *t, const tc_options *base, double deadline, int config[6]) {
+    static const int tile_A_lo[3] = {16, 1, 1};
+    int values[6][32];
+    int counts[6] = {0};
+    for (int axis = 0; axis < t->dims; axis++) {
+        int size_C = t->size_C[axis];
+        counts[axis] = candidates(tile_A_lo[axis], size_C, values[axis]);
+        if (t->dims != 2) counts[3 + axis] = candidates(16, t->size_B[axis], values[3 + axis]);
+    }
+
+    double best = evaluate(t, base, config, TUNE_MIN_REPS);
+    for (int pass = 0; pass < TUNE_MAX_PASSES && best >= 0; pass++) {
+        int improved = 0;
+        for (int p = 0; p < 6; p++) {
+            for (int c = 0; c < counts[p] && tc_now() < deadline; c++) {
+                int trial[6];
+                memcpy(trial, config, sizeof(trial));
+                trial[p] = values[p][c];
+                double seconds = evaluate(t, base, trial, TUNE_MIN_REPS);
+                if (seconds >= 0 && seconds < best) {
+                    best = seconds;
+                    memcpy(config, trial, sizeof(trial));
+                    improved = 1;
+                }
+            }
+        }
+        if (!improved || tc_now() >= deadline) break;
+    }
+    return best;
+}
+
+typedef struct {
+    int config[6];
+    double seconds;     // Fastest proxy run; a huge value until timed
+} tune_candidate;
+
+static int compare_candidate(const void *a, const void *b) {
+    double x = ((const tune_candidate *)a)->seconds, y = ((const tune_candidate *)b)->seconds;
+    return (x > y) - (x < y);
+}
+
+/**
+ * 3D search. tile_A and tile_B are sampled independently from dense candidate
+ * sets and pruned by successive halving on proxy, a shrunken copy of the
+ * problem: every round times the survivors with twice as many runs and keeps
+ * the faster half. The last TUNE_SURVIVORS are timed on the real problem and
+ * the best one is refined by hill climbing over the neighbours of each
+ * parameter, which reaches tiles between the sampled values.
+ *
+ * @return The best time on the real problem, or -1 if no plan could be created
+ */
+static double search_3d(tuner *t, tuner *proxy, const tc_options *base, double budget,
+                        double deadline, int config[6]) {
+    int values[6][TUNE_MAX_VALUES];
+    int counts[6];
+    int extent[6];
+    for (int axis = 0; axis < 3; axis++) {
+        extent[axis] = t->size_C[axis];
+        extent[3 + axis] = t->size_B[axis];
+    }
+    for (int p = 0; p < 6; p++) {
+        counts[p] = dense_candidates(extent[p], values[p]);
+    }
+
+    // The library defaults always take part, then random distinct samples
+    tune_candidate pool[TUNE_SAMPLES];
+    int n = 0;
+    memcpy(pool[n++].config, config, sizeof(pool[0].config));
+    unsigned int seed = 54321;
+    for (int attempt = 0; attempt < TUNE_SAMPLES * 8 && n < TUNE_SAMPLES; attempt++) {
+        int trial[6];
+        for (int p = 0; p < 6; p++) trial[p] = values[p][next_random(&seed) % counts[p]];
+        int seen = 0;
+        for (int i = 0; i < n && !seen; i++) seen = memcmp(pool[i].config, trial, sizeof(trial)) == 0;
+        if (!seen) memcpy(pool[n++].config, trial, sizeof(trial));
+    }
+    for (int i = 0; i < n; i++) pool[i].seconds = 1e30;
+
+    // Successive halving on the proxy within its share of the budget. The
+    // current leader is always timed, so a round cut short still ranks it.
+    double proxy_deadline = tc_now() + budget * TUNE_PROXY_SHARE;
+    if (proxy_deadline > deadline) proxy_deadline = deadline;
+    int alive = n;
+    for (int reps = 1; alive > TUNE_SURVIVORS; reps *= 2) {
+        for (int i = 0; i < alive; i++) {
+            if (i > 0 && tc_now() >= proxy_deadline) break;
+            double seconds = evaluate(proxy, base, pool[i].config, reps);
+            if (seconds >= 0) pool[i].seconds = seconds;
+        }
+        qsort(pool, alive, sizeof(pool[0]), compare_candidate);
+        if (tc_now() >= proxy_deadline) break;
+        alive = (alive + 1) / 2;
+    }
+    if (alive > TUNE_SURVIVORS) alive = TUNE_SURVIVORS;
+
+    // Survivors on the real problem
+    double best = -1.0;
+    for (int i = 0; i < alive; i++) {
+        if (i > 0 && tc_now() >= deadline) break;
+        double seconds = evaluate(t, base, pool[i].config, TUNE_MIN_REPS);
+        if (seconds >= 0 && (best < 0 || seconds < best)) {
+            best = seconds;
+            memcpy(config, pool[i].config, sizeof(pool[0].config));
+        }
+    }
+
+    // Hill climbing on the real problem
+    for (int pass = 0; pass < TUNE_MAX_PASSES && best >= 0; pass++) {
+        int improved = 0;
+        for (int p = 0; p < 6; p++) {
+            int near[6];
+            int count = neighbours(config[p], extent[p], near);
+            for (int c = 0; c < count && tc_now() < deadline; c++) {
+                int trial[6];
+                memcpy(trial, config, sizeof(trial));
+                trial[p] = near[c];
+                double seconds = evaluate(t, base, trial, TUNE_MIN_REPS);
+                if (seconds >= 0 && seconds < best) {
+                    best = seconds;
+                    memcpy(config, trial, sizeof(trial));
+                    improved = 1;
+                }
+            }
+        }
+        if (!improved || tc_now() >= deadline) break;
+    }
+    return best;
+}
+
+/**
+ * Two-sided 95% Student t quantile for df degrees of freedom.
+ */
+static double t_quantile_95(int df) {
+    static const double table[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (df < 1) return table[0];
+    return df <= 30 ? table[df - 1] : 1.96;
+}
+
+/**
+ * Times the winning plan again in independent runs and stores their mean and
+ * the 95% confidence interval of the mean in result. The number of runs fits
+ * in a tenth of the budget, between TUNE_CI_MIN_RUNS and TUNE_CI_MAX_RUNS.
+ */
+static void measure_interval(const tuner *t, const tc_plan *plan, double single, double budget,
+                             tc_tune_result *result) {
+    int runs = single > 0 ? (int)(budget * 0.1 / single) : TUNE_CI_MAX_RUNS;
+    if (runs < TUNE_CI_MIN_RUNS) runs = TUNE_CI_MIN_RUNS;
+    if (runs > TUNE_CI_MAX_RUNS) runs = TUNE_CI_MAX_RUNS;
+
+    double sum = 0.0, sum_sq = 0.0;
+    tc_execute(plan, t->A, t->C);
+    for (int i = 0; i < runs; i++) {
+        double t0 = tc_now();
+        tc_execute(plan, t->A, t->C);
+        double elapsed = tc_now() - t0;
+        sum += elapsed;
+        sum_sq += elapsed * elapsed;
+    }
+    double mean = sum / runs;
+    double variance = (sum_sq - runs * mean * mean) / (runs - 1);
+    double half = t_quantile_95(runs - 1) * sqrt(variance > 0 ? variance : 0.0) / sqrt((double)runs);
+    result->mean_seconds = mean;
+    result->ci_low = mean - half;
+    result->ci_high = mean + half;
+    result->ci_runs = runs;
+}
+
+int tc_tune(tc_op op, int dims, const int size_A[3], const int size_B[3],
+            const tc_options *base, double budget_seconds, int force,
+            tc_tune_result *result) {
+    if (dims < 1 || dims > 3) return -1;
+    for (int axis = 0; axis < 3; axis++) {
+        if (size_A[axis] < 1 || size_B[axis] < 1) return -1;
+        if (axis >= dims && (size_A[axis] != 1 || size_B[axis] != 1)) return -1;
+    }
+
+    tc_options defaults;
+    if (!base) {
+        tc_options_init(&defaults);
+        base = &defaults;
+    }
+    int threads = effective_threads(dims, base);
+
+    memset(result, 0, sizeof(*result));
+    result->options = *base;
+
+    tune_entry key, entry;
+    make_key(&key, op, dims, size_A, size_B, base);
+    if (!force && find(&key, &entry)) {
+        for (int axis = 0; axis < 3; axis++) {
+            result->options.tile_A[axis] = entry.tile_A[axis];
+            result->options.tile_B[axis] = entry.tile_B[axis];
+        }
+        result->options.engine = tuned_engine(&entry, dims, base->engine);
+        result->seconds = entry.seconds;
+        result->cached = 1;
+        return 0;
+    }
+
+    tuner *t = tuner_create(op, dims, size_A, size_B, base);
+    if (!t) return -1;
+
+    // 3D searches rank their samples on a proxy with about half the output
+    // extent per axis (an eighth of the work); small volumes are their own
+    // proxy. Dropping d outputs drops d * stride inputs in every output mode.
+    int proxy_A[3];
+    int shrunk = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        int size_C = t->size_C[axis];
+        int proxy_C = size_C / 2 > TUNE_PROXY_MIN_EXTENT ? size_C / 2 : TUNE_PROXY_MIN_EXTENT;
+        int stride = base->stride[axis] > 1 ? base->stride[axis] : 1;
+        proxy_A[axis] = size_A[axis];
+        if (dims == 3 && proxy_C < size_C && size_A[axis] - (long)(size_C - proxy_C) * stride >= size_B[axis]) {
+            proxy_A[axis] = size_A[axis] - (size_C - proxy_C) * stride;
+        }
+        shrunk |= proxy_A[axis] != size_A[axis];
+    }
+    tuner *proxy = shrunk ? tuner_create(op, dims, proxy_A, size_B, base) : t;
+    if (!proxy) proxy = t;
+
+    // Threaded candidates share one pool instead of starting threads per plan
+    tc_options shared = *base;
+    tc_pool *pool = NULL;
+    if (dims > 1 && !base->pool && threads > 1) {
+        pool = tc_pool_create(threads);
+        shared.pool = pool;
+    }
+    base = &shared;
+
+    if (budget_seconds <= 0) budget_seconds = TUNE_DEFAULT_BUDGET;
+    double deadline = tc_now() + budget_seconds;
+
+    // Start from the tiles the library would pick (defaults, or an earlier tuning)
+    int config[6];
+    for (int axis = 0; axis < 3; axis++) {
+        config[axis] = t->size_C[axis];
+        config[3 + axis] = size_B[axis];
+    }
+    tc_plan *start = create_plan(t, base);
+    if (start) {
+        for (int axis = 0; axis < dims; axis++) {
+            config[axis] = start->tile_A[axis];
+            config[3 + axis] = start->tile_B[axis];
+        }
+        tc_plan_destroy(start);
+    }
+
+    double best;
+    if (dims == 3) {
+        best = search_3d(t, proxy, base, budget_seconds, deadline, config);
+    } else {
+        best = search_descent(t, base, deadline, config);
+    }
+
+    int status = best >= 0 ? 0 : -1;
+    tune_entry winner = key;
+    winner.engine = TC_ENGINE_DIRECT;
+    for (int axis = 0; axis < 3; axis++) {
+        winner.tile_A[axis] = config[axis];
+        winner.tile_B[axis] = config[3 + axis];
+    }
+    winner.seconds = best;
+
+    // 1D plans may also run on the FFT engine; it keeps the tuned tiles for the
+    // cases its exactness guard hands back to direct
+    int fft_timed = 0;
+    tc_plan *fft_plan = NULL;
+    if (status == 0 && dims == 1 && base->engine != TC_ENGINE_DIRECT) {
+        tc_options opts = *base;
+        opts.engine = TC_ENGINE_FFT;
+        opts.tile_A[0] = config[0];
+        opts.tile_B[0] = config[3];
+        fft_plan = create_plan(t, &opts);
+        if (fft_plan && tc_plan_engine(fft_plan) == TC_ENGINE_FFT) {
+            double seconds = time_plan(t, fft_plan, TUNE_MIN_REPS, NULL);
+            fft_timed = 1;
+            if (seconds < best) {
+                winner.engine = TC_ENGINE_FFT;
+                winner.seconds = seconds;
+            }
+        }
+    }
+
+    if (status == 0) {
+        for (int axis = 0; axis < 3; axis++) {
+            result->options.tile_A[axis] = winner.tile_A[axis];
+            result->options.tile_B[axis] = winner.tile_B[axis];
+        }
+        if (base->engine == TC_ENGINE_AUTO && dims == 1) result->options.engine = winner.engine;
+        result->seconds = winner.seconds;
+        result->evaluated = t->evaluated + fft_timed;
+        result->proxy_evaluated = proxy != t ? proxy->evaluated : 0;
+
+        tc_plan *plan = winner.engine == TC_ENGINE_FFT ? fft_plan : create_config_plan(t, base, config);
+        if (plan) measure_interval(t, plan, winner.seconds, budget_seconds, result);
+        if (plan != fft_plan) tc_plan_destroy(plan);
+
+        result->saved = save(&winner) == 0;
+    }
+
+    tc_plan_destroy(fft_plan);
+    tc_pool_destroy(pool);
+    if (proxy != t) tuner_destroy(proxy);
+    tuner_destroy(t);
+    return status;
+}
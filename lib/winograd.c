@@ -0,0 +1,267 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TC_X86 1
+#endif
+
+#include "tileconv_internal.h"
+
+/*
+ * Winograd minimal filtering F(m x m, r x r) for square 3 x 3 and 5 x 5
+ * kernels: F(2 x 2, 3 x 3) on 4 x 4 input tiles, and F(4 x 4, 3 x 3) and
+ * F(2 x 2, 5 x 5) on 6 x 6 tiles. An m x m output tile is
+ *
+ *   Y = A^T [U . (B^T d B)] A,  U = G g G^T
+ *
+ * for the n x n input tile d, the oriented kernel g and the elementwise
+ * product '.', which costs n^2 multiplies instead of m^2 r^2. The 4-point
+ * transforms interpolate at {0, 1, -1, inf} and the 6-point ones at
+ * {0, 1, -1, 2, -2, inf}; B^T and A^T have small integer entries and only G
+ * has fractions. U is computed once per plan.
+ *
+ * Int plans scale G by the common denominator s of its rows (2 and 24) and
+ * divide the outputs by s^2 exactly, which needs every intermediate to fit in
+ * an int: the plan only switches to Winograd when the declared input range
+ * proves that.
+ */
+
+// Interpolation points of the n-point transforms and the denominators of
+// their rows of G (row k of G is point^j / norm for j < r; norm 0 marks the
+// point at infinity, whose row is e_{r-1})
+static const int points_4[4] = {0, 1, -1, 0}, norms_4[4] = {1, 2, 2, 0};
+static const int points_6[6] = {0, 1, -1, 2, -2, 0}, norms_6[6] = {4, -6, -6, 24, 24, 0};
+
+// B^T and A^T, as written out in WG_BT and WG_AT below; used for the int bound
+static const int BT_4[4][4] = {
+    {1, 0, -1, 0}, {0, 1, 1, 0}, {0, -1, 1, 0}, {0, 1, 0, -1}
+};
+static const int BT_6[6][6] = {
+    {4, 0, -5, 0, 1, 0}, {0, -4, -4, 1, 1, 0}, {0, 4, -4, -1, 1, 0},
+    {0, -2, -1, 2, 1, 0}, {0, 2, -1, -2, 1, 0}, {0, 4, 0, -5, 0, 1}
+};
+static const int AT_4_2[2][4] = {{1, 1, 1, 0}, {0, 1, -1, -1}};
+static const int AT_6_4[4][6] = {
+    {1, 1, 1, 1, 1, 0}, {0, 1, -1, 2, -2, 0}, {0, 1, 1, 4, 4, 0}, {0, 1, -1, 8, -8, 1}
+};
+static const int AT_6_2[2][6] = {{1, 1, 1, 1, 1, 0}, {0, 1, -1, 2, -2, 1}};
+
+// Input transform v = B^T d of n points
+#define WG_BT(n, d, v) do { \
+    if ((n) == 4) { \
+        v[0] = d[0] - d[2]; \
+        v[1] = d[1] + d[2]; \
+        v[2] = d[2] - d[1]; \
+        v[3] = d[1] - d[3]; \
+    } else { \
+        v[0] = 4 * d[0] - 5 * d[2] + d[4]; \
+        v[1] = d[3] + d[4] - 4 * (d[1] + d[2]); \
+        v[2] = d[4] - d[3] + 4 * (d[1] - d[2]); \
+        v[3] = d[4] - d[2] + 2 * (d[3] - d[1]); \
+        v[4] = d[4] - d[2] - 2 * (d[3] - d[1]); \
+        v[5] = 4 * d[1] - 5 * d[3] + d[5]; \
+    } \
+} while (0)
+
+// Output transform y = A^T x of n points to m outputs
+#define WG_AT(n, m, x, y) do { \
+    if ((n) == 4) { \
+        y[0] = x[0] + x[1] + x[2]; \
+        y[1] = x[1] - x[2] - x[3]; \
+    } else { \
+        WT sum_12 = x[1] + x[2], diff_12 = x[1] - x[2]; \
+        WT sum_34 = x[3] + x[4], diff_34 = x[3] - x[4]; \
+        y[0] = x[0] + sum_12 + sum_34; \
+        if ((m) == 4) { \
+            y[1] = diff_12 + 2 * diff_34; \
+            y[2] = sum_12 + 4 * sum_34; \
+            y[3] = diff_12 + 8 * diff_34 + x[5]; \
+        } else { \
+            y[1] = diff_12 + 2 * diff_34 + x[5]; \
+        } \
+    } \
+} while (0)
+
+/**
+ * Variant of a Winograd plan: 0 for F(2, 3), 1 for F(4, 3), 2 for F(2, 5).
+ */
+static inline int winograd_variant(const tc_plan *plan) {
+    return plan->winograd_m == 4 ? 1 : plan->size_B[0] == 5 ? 2 : 0;
+}
+
+// Exact division of an int tile output by s^2 = 4 (4 points) or 576 = 2^6 * 9
+// (6 points): the sum is a multiple of s^2, so an arithmetic shift removes the
+// power of two and 954437177, the inverse of 9 modulo 2^32, the odd part
+#define WT int
+#define WS(name) name
+#define WG_FINISH(z, n) ((n) == 4 ? (z) >> 2 : (int)((unsigned)((z) >> 6) * 954437177u))
+#include "winograd_engine.h"
+#undef WT
+#undef WS
+#undef WG_FINISH
+
+#define WT float
+#define WS(name) name##_f
+#define WG_FINISH(z, n) (z)
+#include "winograd_engine.h"
+#undef WT
+#undef WS
+
+#define WT double
+#define WS(name) name##_d
+#include "winograd_engine.h"
+#undef WT
+#undef WS
+#undef WG_FINISH
+
+void tc_winograd_select_kernels(const char *isa) {
+    winograd_select(isa);
+    winograd_select_f(isa);
+    winograd_select_d(isa);
+}
+
+/**
+ * Fills the scaled transform G' = s G (n x r, integer) and returns s.
+ */
+static int scaled_G(int n, int r, long long *G) {
+    const int *points = n == 4 ? points_4 : points_6;
+    const int *norms = n == 4 ? norms_4 : norms_6;
+    int s = n == 4 ? 2 : 24;
+    for (int k = 0; k < n; k++) {
+        long long power = s / (norms[k] ? norms[k] : 1);
+        for (int j = 0; j < r; j++) {
+            G[k * r + j] = norms[k] ? power : (j == r - 1 ? s : 0);
+            power *= points[k];
+        }
+    }
+    return s;
+}
+
+/**
+ * |A^T[b][q]| of the n-point, m-output transform.
+ */
+static int abs_AT(int n, int m, int b, int q) {
+    return abs(n == 4 ? AT_4_2[b][q] : m == 4 ? AT_6_4[b][q] : AT_6_2[b][q]);
+}
+
+/**
+ * Checks that every intermediate of the int strips stays inside the int range
+ * for inputs of magnitude at most max_A. Each stage is bounded by the sum of
+ * the absolute values it adds up, which also bounds its partial sums.
+ */
+static int int_transforms_fit(int n, int m, const __int128 *U, __int128 max_A) {
+    __int128 row_B[6], Z[6][4];
+    for (int p = 0; p < n; p++) {
+        row_B[p] = 0;
+        for (int i = 0; i < n; i++) row_B[p] += abs(n == 4 ? BT_4[p][i] : BT_6[p][i]);
+    }
+    for (int p = 0; p < n; p++) {
+        for (int b = 0; b < m; b++) {
+            Z[p][b] = 0;
+            for (int q = 0; q < n; q++) {
+                __int128 V = row_B[p] * row_B[q] * max_A;
+                __int128 product = (U[p * n + q] < 0 ? -U[p * n + q] : U[p * n + q]) * V;
+                if (V > INT_MAX || product > INT_MAX) return 0;
+                Z[p][b] += abs_AT(n, m, b, q) * product;
+            }
+            if (Z[p][b] > INT_MAX) return 0;
+        }
+    }
+    for (int i = 0; i < m; i++) {
+        for (int b = 0; b < m; b++) {
+            __int128 Y = 0;
+            for (int p = 0; p < n; p++) Y += abs_AT(n, m, i, p) * Z[p][b];
+            if (Y > INT_MAX) return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Computes the transformed kernel of F(m x m, r x r) into plan->W_winograd.
+ *
+ * @return 1 if the plan can run this variant, 0 if an int plan could
+ *         overflow, -1 if memory allocation failed
+ */
+static int transform_kernel(tc_plan *plan, int m, int declared, __int128 max_A) {
+    int r = plan->size_B[0], n = m + r - 1;
+    long long G[6 * 5];
+    int s = scaled_G(n, r, G);
+
+    size_t element = plan->dtype == TC_FLOAT ? sizeof(float) : plan->dtype == TC_DOUBLE ? sizeof(double) : sizeof(int);
+    void *W = malloc((size_t)n * n * element);
+    if (!W) return -1;
+
+    if (plan->dtype == TC_INT) {
+        // U' = G' g G'^T = s^2 U, exact in 128 bits
+        __int128 U[36];
+        for (int p = 0; p < n; p++) {
+            for (int q = 0; q < n; q++) {
+                __int128 sum = 0;
+                for (int i = 0; i < r; i++) {
+                    for (int j = 0; j < r; j++) sum += (__int128)G[p * r + i] * G[q * r + j] * plan->W[i * r + j];
+                }
+                U[p * n + q] = sum;
+            }
+        }
+        if (!declared || !int_transforms_fit(n, m, U, max_A)) {
+            free(W);
+            return 0;
+        }
+        for (int k = 0; k < n * n; k++) ((int *)W)[k] = (int)U[k];
+    } else {
+        // Real plans apply U = G g G^T itself, summed in double from G' / s
+        for (int p = 0; p < n; p++) {
+            for (int q = 0; q < n; q++) {
+                double sum = 0.0;
+                for (int i = 0; i < r; i++) {
+                    for (int j = 0; j < r; j++) {
+                        double w = plan->dtype == TC_FLOAT ? ((const float *)plan->W_real)[i * r + j]
+                                 : ((const double *)plan->W_real)[i * r + j];
+                        sum += (double)G[p * r + i] * G[q * r + j] * w;
+                    }
+                }
+                sum /= (double)s * s;
+                if (plan->dtype == TC_FLOAT) {
+                    ((float *)W)[p * n + q] = (float)sum;
+                } else {
+                    ((double *)W)[p * n + q] = sum;
+                }
+            }
+        }
+    }
+
+    free(plan->W_winograd);
+    plan->W_winograd = W;
+    plan->winograd_m = m;
+    return 1;
+}
+
+int tc_winograd_plan(tc_plan *plan, const tc_options *opts) {
+    int r = plan->size_B[0];
+    if (opts->engine != TC_ENGINE_WINOGRAD) return 0;
+    if (plan->dims != 2 || plan->size_B[1] != r || (r != 3 && r != 5)) return 0;
+    if (plan->dtype == TC_INT && plan->accum != TC_ACCUM_INT32) return 0;
+
+    int declared = opts->input_min != 0 || opts->input_max != 0;
+    __int128 max_A = opts->input_max;
+    if (-(__int128)opts->input_min > max_A) max_A = -(__int128)opts->input_min;
+
+    // F(4, 3) first for 3 x 3 kernels (fewer multiplies per output), unless a tile was requested
+    int candidates[2] = {r == 3 ? 4 : 2, 2}, count = r == 3 ? 2 : 1;
+    if (opts->winograd_tile) {
+        candidates[0] = opts->winograd_tile;
+        count = 1;
+    }
+    for (int c = 0; c < count; c++) {
+        if (candidates[c] == 4 && r == 5) continue;
+        int status = transform_kernel(plan, candidates[c], declared, max_A);
+        if (status < 0) return -1;
+        if (status > 0) {
+            plan->engine = TC_ENGINE_WINOGRAD;
+            return 0;
+        }
+    }
+    return 0;
+}
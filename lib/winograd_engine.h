@@ -0,0 +1,158 @@
+/*
+ * Type-generic Winograd engine. Like real_engine.h there is deliberately no
+ * include guard: winograd.c includes this file once per element type after
+ * defining
+ *
+ *   WT              the element type (int, float or double)
+ *   WS(name)        name with the type suffix (none, _f or _d)
+ *   WG_FINISH(z, n) the output of a scaled sum z for a tile of n points:
+ *                   the exact division by the kernel scale for int, z otherwise
+ *
+ * so the strips, their per-ISA builds and the tile entry point of all three
+ * types come from this one source.
+ */
+
+/**
+ * Runs whole strips of F(m x m, r x r) on rows x (tiles * m) outputs, m rows
+ * at a time. Every pass is a unit-stride loop over columns or tiles:
+ *
+ *   1. the vertical input transform of the strip's n = m + r - 1 input rows
+ *      into T (n rows of cols_in = tiles * m + r - 1 columns);
+ *   2. a split of each row of T by x phase, P[(p * m + s) * lanes + t] =
+ *      T[p][t * m + s], so the n columns of every tile are contiguous in t;
+ *   3. per transformed row p, the horizontal input transform, the product
+ *      with row p of the transformed kernel U and the horizontal output
+ *      transform, into Z[(p * m + b) * tiles + t];
+ *   4. the vertical output transform into T, then interleaved back into C.
+ *
+ * n and m are compile-time constants at every call, so the transforms unroll
+ * and the loops vectorize for the ISA of the caller. S holds
+ * n * (cols_in + m * (lanes + tiles)) elements, lanes = tiles + (n - 1) / m.
+ */
+static inline __attribute__((always_inline))
+void WS(winograd_strips)(const WT *A, long pitch_A, WT *C, long pitch_C, int rows, int tiles,
+                         const WT *U, WT *S, const int n, const int m) {
+    int lanes = tiles + (n - 1) / m;
+    int cols_in = tiles * m + n - m;
+    int full = cols_in / m;             // Phase groups with all m columns inside the input
+    int extra = cols_in % m;            // Columns of the last, partial group
+    WT *T = S, *P = T + (long)n * cols_in, *Z = P + (long)n * m * lanes;
+
+    for (int y = 0; y < rows; y += m) {
+        const WT *a = A + y * pitch_A;
+
+#pragma GCC ivdep
+        for (int x = 0; x < cols_in; x++) {
+            WT d[6], v[6];
+            for (int i = 0; i < n; i++) d[i] = a[i * pitch_A + x];
+            WG_BT(n, d, v);
+            for (int p = 0; p < n; p++) T[p * cols_in + x] = v[p];
+        }
+
+        for (int p = 0; p < n; p++) {
+            const WT *T_p = T + p * cols_in;
+            WT *P_p = P + p * m * lanes;
+#pragma GCC ivdep
+            for (int t = 0; t < full; t++) {
+                for (int s = 0; s < m; s++) P_p[s * lanes + t] = T_p[t * m + s];
+            }
+            for (int s = 0; s < extra; s++) P_p[s * lanes + full] = T_p[full * m + s];
+        }
+
+        for (int p = 0; p < n; p++) {
+            const WT *P_p = P + p * m * lanes;
+            WT *Z_p = Z + p * m * tiles;
+            WT U_p[6];
+            for (int q = 0; q < n; q++) U_p[q] = U[p * n + q];
+#pragma GCC ivdep
+            for (int t = 0; t < tiles; t++) {
+                WT d[6], v[6], z[4];
+                for (int k = 0; k < n; k++) d[k] = P_p[(k % m) * lanes + k / m + t];
+                WG_BT(n, d, v);
+                for (int q = 0; q < n; q++) v[q] *= U_p[q];
+                WG_AT(n, m, v, z);
+                for (int b = 0; b < m; b++) Z_p[b * tiles + t] = z[b];
+            }
+        }
+
+        for (int b = 0; b < m; b++) {
+#pragma GCC ivdep
+            for (int t = 0; t < tiles; t++) {
+                WT d[6], z[4];
+                for (int p = 0; p < n; p++) d[p] = Z[(p * m + b) * tiles + t];
+                WG_AT(n, m, d, z);
+                for (int i = 0; i < m; i++) T[(i * m + b) * tiles + t] = z[i];
+            }
+        }
+        for (int i = 0; i < m; i++) {
+            WT *c = C + (y + i) * pitch_C;
+            const WT *T_i = T + i * m * tiles;
+#pragma GCC ivdep
+            for (int t = 0; t < tiles; t++) {
+                for (int b = 0; b < m; b++) c[t * m + b] = WG_FINISH(T_i[b * tiles + t], n);
+            }
+        }
+    }
+}
+
+typedef void (*WS(winograd_strips_fn))(const WT *A, long pitch_A, WT *C, long pitch_C, int rows, int tiles,
+                                       const WT *U, WT *S);
+
+// One build of the strips per variant (n, m) and ISA
+#define WG_BUILD(isa, target, n, m) \
+    target static void WS(winograd_strips_##n##_##m##_##isa)(const WT *A, long pitch_A, WT *C, long pitch_C, \
+                                                              int rows, int tiles, const WT *U, WT *S) { \
+        WS(winograd_strips)(A, pitch_A, C, pitch_C, rows, tiles, U, S, n, m); \
+    }
+#define WG_BUILD_ISA(isa, target) \
+    WG_BUILD(isa, target, 4, 2) \
+    WG_BUILD(isa, target, 6, 4) \
+    WG_BUILD(isa, target, 6, 2)
+
+WG_BUILD_ISA(scalar, )
+#ifdef TC_X86
+WG_BUILD_ISA(avx2, __attribute__((target("avx2,fma"))))
+WG_BUILD_ISA(avx512, __attribute__((target("avx512f"))))
+#endif
+
+#undef WG_BUILD_ISA
+#undef WG_BUILD
+
+// Indexed by variant: F(2, 3), F(4, 3), F(2, 5)
+static WS(winograd_strips_fn) WS(winograd_strips_variant)[3] = {
+    WS(winograd_strips_4_2_scalar), WS(winograd_strips_6_4_scalar), WS(winograd_strips_6_2_scalar)
+};
+
+static void WS(winograd_select)(const char *isa) {
+    WS(winograd_strips_variant)[0] = WS(winograd_strips_4_2_scalar);
+    WS(winograd_strips_variant)[1] = WS(winograd_strips_6_4_scalar);
+    WS(winograd_strips_variant)[2] = WS(winograd_strips_6_2_scalar);
+#ifdef TC_X86
+    if (strcmp(isa, "avx512") == 0) {
+        WS(winograd_strips_variant)[0] = WS(winograd_strips_4_2_avx512);
+        WS(winograd_strips_variant)[1] = WS(winograd_strips_6_4_avx512);
+        WS(winograd_strips_variant)[2] = WS(winograd_strips_6_2_avx512);
+    } else if (strcmp(isa, "avx2") == 0) {
+        WS(winograd_strips_variant)[0] = WS(winograd_strips_4_2_avx2);
+        WS(winograd_strips_variant)[1] = WS(winograd_strips_6_4_avx2);
+        WS(winograd_strips_variant)[2] = WS(winograd_strips_6_2_avx2);
+    }
+#endif
+}
+
+int WS(tc_winograd_tile_2d)(const tc_plan *plan, const WT *A, long pitch_A, WT *C, long pitch_C,
+                            int i_tile, int j_tile, int height, int width) {
+    int m = plan->winograd_m, n = m + plan->size_B[0] - 1;
+    int rows = height - height % m, tiles = width / m;
+    if (rows == 0 || tiles == 0) return 0;
+
+    int lanes = tiles + (n - 1) / m, cols_in = tiles * m + n - m;
+    WT *S = (WT *)malloc((size_t)n * (cols_in + m * (lanes + tiles)) * sizeof(WT));
+    if (!S) return -1;
+
+    WS(winograd_strips_variant)[winograd_variant(plan)](A + i_tile * pitch_A + j_tile, pitch_A,
+                                                         C + i_tile * pitch_C + j_tile, pitch_C, rows, tiles,
+                                                         (const WT *)plan->W_winograd, S);
+    free(S);
+    return 0;
+}
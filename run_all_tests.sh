@@ -12,6 +12,10 @@ CROSS_CORR_DIR="cross_correlation"
 CONV_1D_DIR="1d_convolution"
 CONV_2D_DIR="2d_convolution"
 CONV_3D_DIR="3d_convolution"
+CROSS_CORR_2D_DIR="2d_cross_correlation"
+CROSS_CORR_3D_DIR="3d_cross_correlation"
+LIB_DIR="lib"
+TILECONV_LIB="$BIN_DIR/libtileconv.a -lm -pthread"
 
 # Create the bin directory if it doesn't exist
 mkdir -p $BIN_DIR
@@ -46,29 +50,47 @@ compile_templates() {
 compile_complete_implementations() {
     echo "===== Compiling complete implementations ====="
 
+    # The comparison programs link against the plan-based library
+    echo "Building the tileconv library..."
+    make -s library
+
     # Cross-Correlation
     echo "Compiling Cross-Correlation implementations..."
     gcc -o $BIN_DIR/naive_cross_correlation $CROSS_CORR_DIR/naive/cross_correlation.c
     gcc -o $BIN_DIR/tiled_cross_correlation $CROSS_CORR_DIR/tiled/tiled_cross_correlation.c
-    gcc -o $BIN_DIR/cross_correlation_comparison $CROSS_CORR_DIR/cross_correlation_comparison.c
+    gcc -O3 -I$LIB_DIR -o $BIN_DIR/cross_correlation_comparison $CROSS_CORR_DIR/cross_correlation_comparison.c $TILECONV_LIB
 
     # 1D Convolution
     echo "Compiling 1D Convolution implementations..."
     gcc -o $BIN_DIR/naive_convolution $CONV_1D_DIR/naive/convolution.c
     gcc -o $BIN_DIR/tiled_convolution $CONV_1D_DIR/tiled/tiled_convolution.c
-    gcc -o $BIN_DIR/convolution_comparison $CONV_1D_DIR/convolution_comparison.c
+    gcc -O3 -I$LIB_DIR -o $BIN_DIR/convolution_comparison $CONV_1D_DIR/convolution_comparison.c $TILECONV_LIB
 
     # 2D Convolution
     echo "Compiling 2D Convolution implementations..."
     gcc -o $BIN_DIR/convolution_2d $CONV_2D_DIR/naive/convolution_2d.c
     gcc -o $BIN_DIR/tiled_convolution_2d $CONV_2D_DIR/tiled/tiled_convolution_2d.c
-    gcc -o $BIN_DIR/convolution_2d_comparison $CONV_2D_DIR/convolution_2d_comparison.c
+    gcc -O3 -I$LIB_DIR -o $BIN_DIR/convolution_2d_comparison $CONV_2D_DIR/convolution_2d_comparison.c $TILECONV_LIB
     
     # 3D Convolution (when complete implementations are available)
     echo "Compiling 3D Convolution implementations..."
     gcc -o $BIN_DIR/convolution_3d $CONV_3D_DIR/naive/convolution_3d.c
     gcc -o $BIN_DIR/tiled_convolution_3d $CONV_3D_DIR/tiled/tiled_convolution_3d.c
-    gcc -o $BIN_DIR/convolution_3d_comparison $CONV_3D_DIR/convolution_3d_comparison.c
+    gcc -O3 -I$LIB_DIR -o $BIN_DIR/convolution_3d_comparison $CONV_3D_DIR/convolution_3d_comparison.c $TILECONV_LIB
+
+    # 2D and 3D Cross-Correlation
+    echo "Compiling 2D and 3D Cross-Correlation implementations..."
+    gcc -o $BIN_DIR/cross_correlation_2d $CROSS_CORR_2D_DIR/naive/cross_correlation_2d.c
+    gcc -O3 -I$LIB_DIR -o $BIN_DIR/tiled_cross_correlation_2d $CROSS_CORR_2D_DIR/tiled/tiled_cross_correlation_2d.c $TILECONV_LIB
+    gcc -O3 -I$LIB_DIR -o $BIN_DIR/cross_correlation_2d_comparison $CROSS_CORR_2D_DIR/cross_correlation_2d_comparison.c $TILECONV_LIB
+    gcc -o $BIN_DIR/cross_correlation_3d $CROSS_CORR_3D_DIR/naive/cross_correlation_3d.c
+    gcc -O3 -I$LIB_DIR -o $BIN_DIR/tiled_cross_correlation_3d $CROSS_CORR_3D_DIR/tiled/tiled_cross_correlation_3d.c $TILECONV_LIB
+    gcc -O3 -I$LIB_DIR -o $BIN_DIR/cross_correlation_3d_comparison $CROSS_CORR_3D_DIR/cross_correlation_3d_comparison.c $TILECONV_LIB
+
+    # Benchmark harness
+    echo "Compiling benchmark harness and autotuner..."
+    gcc -O3 -I$LIB_DIR -o $BIN_DIR/bench bench/bench.c $TILECONV_LIB
+    gcc -O3 -I$LIB_DIR -o $BIN_DIR/tune bench/tune.c $TILECONV_LIB
 
     echo "===== Complete implementations compilation complete ====="
     echo ""
@@ -130,12 +152,14 @@ run_2d_convolution_default() {
 5
 32
 32
+$(nproc)
 EOF
     echo "Running 2D Convolution Comparison with default values:"
     echo "  - Matrix A size: 500x500"
     echo "  - Kernel B size: 5x5"
     echo "  - Tile height: 32"
     echo "  - Tile width: 32"
+    echo "  - Threads: 1 to $(nproc)"
     echo ""
     $BIN_DIR/convolution_2d_comparison < temp_input.txt
     rm temp_input.txt
@@ -151,13 +175,14 @@ run_3d_convolution_default() {
 4
 4
 4
+0
 4
 4
 4
 2
 2
 2
-0
+$(nproc)
 EOF
     echo "Running 3D Convolution Comparison with default values:"
     echo "  - Input A dimensions: 20x20x20"
@@ -165,6 +190,7 @@ EOF
     echo "  - Tile A dimensions: 4x4x4"
     echo "  - Tile B dimensions: 2x2x2"
     echo "  - No tile optimization"
+    echo "  - Threads: $(nproc)"
     echo ""
     $BIN_DIR/convolution_3d_comparison < temp_input.txt
     rm temp_input.txt
@@ -173,60 +199,25 @@ EOF
 # Function to optimize tile size for cross-correlation
 optimize_cross_correlation_tiles() {
     echo "===== Optimizing Tile Sizes for Cross-Correlation ====="
-    echo "Testing various tile sizes to find the optimal configuration..."
+    echo "Searching tile sizes with the in-process autotuner..."
     
     # Define input sizes
     size_A=50000
     size_B=2000
     
-    # Define tile sizes to test
-    tile_sizes=(16 32 64 128 256)
-    
-    best_time=999999
-    best_tile_A=0
-    best_tile_B=0
-    
-    for tile_A in "${tile_sizes[@]}"; do
-        for tile_B in "${tile_sizes[@]}"; do
-            # Skip if tile_B is larger than size_B
-            if [ $tile_B -gt $size_B ]; then
-                continue
-            fi
-            
-            # Create input for this configuration
-            cat > temp_input.txt << EOF
-$size_A
-$size_B
-$tile_A
-$tile_B
-EOF
-            
-            echo -n "Testing tile_A=$tile_A, tile_B=$tile_B... "
-            
-            # Capture the output to extract timing information
-            output=$($BIN_DIR/cross_correlation_comparison < temp_input.txt)
-            
-            # Extract the time for tiled implementation
-            tiled_time=$(echo "$output" | grep "Tiled implementation" | awk '{print $3}')
-            
-            echo "Time: $tiled_time seconds"
-            
-            # Compare and update best time
-            if (( $(echo "$tiled_time < $best_time" | bc -l) )); then
-                best_time=$tiled_time
-                best_tile_A=$tile_A
-                best_tile_B=$tile_B
-            fi
-        done
-    done
-    
-    rm -f temp_input.txt
+    # Tune in-process, once; --quiet prints only the winning tiles. The winner
+    # is stored in the tuning database, so later runs (and library plans of
+    # this shape) reuse it without searching again.
+    read best_tile_A best_tile_B < <($BIN_DIR/tune --quiet xcorr $size_A $size_B)
+    if [ -z "$best_tile_A" ]; then
+        echo "Tile search failed"
+        return
+    fi
     
     echo "===== Optimization Results ====="
     echo "Optimal tile sizes for Cross-Correlation:"
     echo "  - Tile A size: $best_tile_A"
     echo "  - Tile B size: $best_tile_B"
-    echo "  - Execution time: $best_time seconds"
     
     # Run one more time with the optimal configuration
     cat > temp_input.txt << EOF
@@ -244,60 +235,25 @@ EOF
 # Function to optimize tile size for 1D convolution
 optimize_1d_convolution_tiles() {
     echo "===== Optimizing Tile Sizes for 1D Convolution ====="
-    echo "Testing various tile sizes to find the optimal configuration..."
+    echo "Searching tile sizes with the in-process autotuner..."
     
     # Define input sizes
     size_A=50000
     size_B=2000
     
-    # Define tile sizes to test
-    tile_sizes=(16 32 64 128 256)
-    
-    best_time=999999
-    best_tile_A=0
-    best_tile_B=0
-    
-    for tile_A in "${tile_sizes[@]}"; do
-        for tile_B in "${tile_sizes[@]}"; do
-            # Skip if tile_B is larger than size_B
-            if [ $tile_B -gt $size_B ]; then
-                continue
-            fi
-            
-            # Create input for this configuration
-            cat > temp_input.txt << EOF
-$size_A
-$size_B
-$tile_A
-$tile_B
-EOF
-            
-            echo -n "Testing tile_A=$tile_A, tile_B=$tile_B... "
-            
-            # Capture the output to extract timing information
-            output=$($BIN_DIR/convolution_comparison < temp_input.txt)
-            
-            # Extract the time for tiled implementation
-            tiled_time=$(echo "$output" | grep "Tiled implementation" | awk '{print $3}')
-            
-            echo "Time: $tiled_time seconds"
-            
-            # Compare and update best time
-            if (( $(echo "$tiled_time < $best_time" | bc -l) )); then
-                best_time=$tiled_time
-                best_tile_A=$tile_A
-                best_tile_B=$tile_B
-            fi
-        done
-    done
-    
-    rm -f temp_input.txt
+    # Tune in-process, once; --quiet prints only the winning tiles. The winner
+    # is stored in the tuning database, so later runs (and library plans of
+    # this shape) reuse it without searching again.
+    read best_tile_A best_tile_B < <($BIN_DIR/tune --quiet conv $size_A $size_B)
+    if [ -z "$best_tile_A" ]; then
+        echo "Tile search failed"
+        return
+    fi
     
     echo "===== Optimization Results ====="
     echo "Optimal tile sizes for 1D Convolution:"
     echo "  - Tile A size: $best_tile_A"
     echo "  - Tile B size: $best_tile_B"
-    echo "  - Execution time: $best_time seconds"
     
     # Run one more time with the optimal configuration
     cat > temp_input.txt << EOF
@@ -315,7 +271,7 @@ EOF
 # Function to optimize tile size for 2D convolution
 optimize_2d_convolution_tiles() {
     echo "===== Optimizing Tile Sizes for 2D Convolution ====="
-    echo "Testing various tile sizes to find the optimal configuration..."
+    echo "Searching tile sizes with the in-process autotuner..."
     
     # Define input sizes
     height_A=500
@@ -323,51 +279,19 @@ optimize_2d_convolution_tiles() {
     height_B=5
     width_B=5
     
-    # Define tile sizes to test
-    tile_sizes=(8 16 32 64)
-    
-    best_time=999999
-    best_tile_height=0
-    best_tile_width=0
-    
-    for tile_height in "${tile_sizes[@]}"; do
-        for tile_width in "${tile_sizes[@]}"; do
-            # Create input for this configuration
-            cat > temp_input.txt << EOF
-$height_A
-$width_A
-$height_B
-$width_B
-$tile_height
-$tile_width
-EOF
-            
-            echo -n "Testing tile_height=$tile_height, tile_width=$tile_width... "
-            
-            # Capture the output to extract timing information
-            output=$($BIN_DIR/convolution_2d_comparison < temp_input.txt)
-            
-            # Extract the time for tiled implementation
-            tiled_time=$(echo "$output" | grep "Tiled implementation" | awk '{print $3}')
-            
-            echo "Time: $tiled_time seconds"
-            
-            # Compare and update best time
-            if (( $(echo "$tiled_time < $best_time" | bc -l) )); then
-                best_time=$tiled_time
-                best_tile_height=$tile_height
-                best_tile_width=$tile_width
-            fi
-        done
-    done
-    
-    rm -f temp_input.txt
+    # Tune in-process, once; --quiet prints only the winning tiles. The winner
+    # is stored in the tuning database, so later runs (and library plans of
+    # this shape) reuse it without searching again.
+    read best_tile_height best_tile_width < <($BIN_DIR/tune --quiet conv ${height_A}x${width_A} ${height_B}x${width_B})
+    if [ -z "$best_tile_height" ]; then
+        echo "Tile search failed"
+        return
+    fi
     
     echo "===== Optimization Results ====="
     echo "Optimal tile sizes for 2D Convolution:"
     echo "  - Tile height: $best_tile_height"
     echo "  - Tile width: $best_tile_width"
-    echo "  - Execution time: $best_time seconds"
     
     # Run one more time with the optimal configuration
     cat > temp_input.txt << EOF
@@ -387,7 +311,7 @@ EOF
 # Function to optimize tile size for 3D convolution
 optimize_3d_convolution_tiles() {
     echo "===== Optimizing Tile Sizes for 3D Convolution ====="
-    echo "Testing various tile sizes to find the optimal configuration..."
+    echo "Searching tile sizes with the in-process autotuner..."
     
     # Define input sizes
     size_A_x=20
@@ -405,12 +329,7 @@ $size_A_z
 $size_B_x
 $size_B_y
 $size_B_z
-4
-4
-4
-2
-2
-2
+1
 1
 EOF
     
@@ -577,6 +496,8 @@ run_complete_mode() {
         echo "11. Optimize 2D Convolution Tile Sizes"
         echo "12. Optimize 3D Convolution Tile Sizes"
         echo "13. Run All Optimizations"
+        echo "14. Run 2D Cross-Correlation Interactively"
+        echo "15. Run 3D Cross-Correlation Interactively"
         echo "0. Return to Main Menu"
         read -p "Enter choice: " complete_choice
         echo ""
@@ -624,6 +545,12 @@ run_complete_mode() {
                 optimize_2d_convolution_tiles
                 optimize_3d_convolution_tiles
                 ;;
+            14)
+                $BIN_DIR/cross_correlation_2d_comparison
+                ;;
+            15)
+                $BIN_DIR/cross_correlation_3d_comparison
+                ;;
             0)
                 break
                 ;;
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tileconv.h"
+
+/*
+ * Regression tests for the tile autotuner on outputs other than 'valid': the
+ * tuner must time plans into a buffer of their real output size, return
+ * tiles that give the same result as the default plan, and keep database
+ * entries apart by every option in their key (output mode, boundary,
+ * stride, dilation, accumulator and requested engine). Run under
+ * AddressSanitizer (make test CFLAGS="-Wall -O1 -g -fsanitize=address") to
+ * catch writes past the output.
+ */
+
+static int failures = 0;
+
+static void check(int condition, const char *what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+/**
+ * Tunes one 2D shape with the given base options, then runs the tuned and the
+ * default plan and compares their outputs.
+ */
+static void tune_2d(const char *name, int height_A, int width_A, int height_B, int width_B,
+                    const tc_options *base) {
+    int size_A[3] = {width_A, height_A, 1};
+    int size_B[3] = {width_B, height_B, 1};
+    tc_tune_result result;
+    int status = tc_tune(TC_CROSS_CORRELATION, 2, size_A, size_B, base, 0.2, 1, &result);
+    check(status == 0, name);
+    if (status != 0) return;
+
+    int *A = (int *)malloc((size_t)height_A * width_A * sizeof(int));
+    int *B = (int *)malloc((size_t)height_B * width_B * sizeof(int));
+    for (int i = 0; i < height_A * width_A; i++) A[i] = rand() % 100;
+    for (int i = 0; i < height_B * width_B; i++) B[i] = rand() % 10;
+
+    tc_plan *tuned = tc_plan_create_2d(TC_CROSS_CORRELATION, height_A, width_A, B, height_B, width_B,
+                                       &result.options);
+    tc_plan *plain = tc_plan_create_2d(TC_CROSS_CORRELATION, height_A, width_A, B, height_B, width_B, base);
+    check(tuned && plain, name);
+    if (tuned && plain) {
+        long count = tc_plan_output_count(plain);
+        check(tc_plan_output_count(tuned) == count, name);
+        int *C_tuned = (int *)malloc((size_t)count * sizeof(int));
+        int *C_plain = (int *)malloc((size_t)count * sizeof(int));
+        tc_execute(tuned, A, C_tuned);
+        tc_execute(plain, A, C_plain);
+        check(memcmp(C_tuned, C_plain, (size_t)count * sizeof(int)) == 0, name);
+        free(C_tuned);
+        free(C_plain);
+    }
+    tc_plan_destroy(tuned);
+    tc_plan_destroy(plain);
+    free(A);
+    free(B);
+}
+
+/**
+ * Checks that database entries only apply to plans with the options they were
+ * tuned for: a line in the old format (no output, boundary, stride, dilation
+ * or accumulator fields) stands for the defaults only.
+ */
+static void lookup_keys(void) {
+    char path[] = "/tmp/test_tune_XXXXXX";
+    int fd = mkstemp(path);
+    check(fd >= 0, "temporary database");
+    if (fd < 0) return;
+    FILE *f = fdopen(fd, "w");
+    fprintf(f, "%s\t%s\txcorr\t2\t100x80x1\t3x3x1\t1\t48x8x1\t3x3x1\tdirect\t0.001\n",
+            tc_cpu_model(), tc_isa());
+    fclose(f);
+    tc_tune_set_db_path(path);
+
+    int size_A[3] = {100, 80, 1}, size_B[3] = {3, 3, 1};
+    tc_options opts;
+    tc_options_init(&opts);
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 2, size_A, size_B, &opts) == 1 && opts.tile_A[0] == 48,
+          "old entry applies to the defaults");
+    tc_options_init(&opts);
+    opts.output = TC_OUTPUT_SAME;
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 2, size_A, size_B, &opts) == 0, "old entry skips 'same'");
+    tc_options_init(&opts);
+    opts.stride[1] = 2;
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 2, size_A, size_B, &opts) == 0, "old entry skips strides");
+    tc_options_init(&opts);
+    opts.boundary = TC_BOUNDARY_REFLECT;
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 2, size_A, size_B, &opts) == 0, "old entry skips boundaries");
+    tc_options_init(&opts);
+    opts.accum = TC_ACCUM_INT64;
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 2, size_A, size_B, &opts) == 0, "old entry skips accumulators");
+
+    // A tuned 'same' shape is found again under its own options only
+    tc_options_init(&opts);
+    opts.output = TC_OUTPUT_SAME;
+    opts.dilation[0] = 2;
+    tc_tune_result result;
+    check(tc_tune(TC_CROSS_CORRELATION, 2, size_A, size_B, &opts, 0.1, 1, &result) == 0 && result.saved,
+          "tune and save 'same'");
+    tc_tune_set_db_path(path);
+    tc_options again = opts;
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 2, size_A, size_B, &again) == 1 &&
+          again.tile_A[0] == result.options.tile_A[0], "'same' entry found after reloading");
+    again = opts;
+    again.boundary = TC_BOUNDARY_WRAP;
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 2, size_A, size_B, &again) == 0,
+          "'same' entry skips another boundary");
+    again = opts;
+    again.accum = TC_ACCUM_SAT32;
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 2, size_A, size_B, &again) == 0,
+          "'same' entry skips another accumulator");
+    tc_options_init(&opts);
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 2, size_A, size_B, &opts) == 1 && opts.tile_A[0] == 48,
+          "'same' entry leaves the defaults alone");
+
+    tc_tune_set_db_path("");
+    remove(path);
+}
+
+/**
+ * 1D entries record the engine they picked; only an entry tuned with
+ * TC_ENGINE_AUTO may pick the engine of an AUTO plan.
+ */
+static void lookup_engines(void) {
+    char path[] = "/tmp/test_tune_XXXXXX";
+    int fd = mkstemp(path);
+    check(fd >= 0, "temporary database");
+    if (fd < 0) return;
+    FILE *f = fdopen(fd, "w");
+    // An old line whose engine choice cannot be trusted, and a line tuned with
+    // the FFT engine left out
+    fprintf(f, "%s\t%s\txcorr\t1\t5000x1x1\t100x1x1\t1\t512x1x1\t100x1x1\tdirect\t0.001\n",
+            tc_cpu_model(), tc_isa());
+    fprintf(f, "%s\t%s\txcorr\t1\t6000x1x1\t100x1x1\t1\t512x1x1\t100x1x1\tdirect\t0.001"
+               "\tvalid\tzero\t1x1x1\t1x1x1\tauto\tdirect\n", tc_cpu_model(), tc_isa());
+    fprintf(f, "%s\t%s\txcorr\t1\t7000x1x1\t100x1x1\t1\t512x1x1\t100x1x1\tfft\t0.001"
+               "\tvalid\tzero\t1x1x1\t1x1x1\tauto\tauto\n", tc_cpu_model(), tc_isa());
+    fclose(f);
+    tc_tune_set_db_path(path);
+
+    int size_A[3] = {5000, 1, 1}, size_B[3] = {100, 1, 1};
+    tc_options opts;
+    tc_options_init(&opts);
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 1, size_A, size_B, &opts) == 1 &&
+          opts.tile_A[0] == 512 && opts.engine == TC_ENGINE_AUTO, "old entry keeps the engine to the plan");
+
+    size_A[0] = 6000;
+    tc_options_init(&opts);
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 1, size_A, size_B, &opts) == 0,
+          "direct-only entry skips AUTO plans");
+    opts.engine = TC_ENGINE_DIRECT;
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 1, size_A, size_B, &opts) == 1 && opts.tile_A[0] == 512,
+          "direct-only entry applies to direct plans");
+
+    size_A[0] = 7000;
+    tc_options_init(&opts);
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 1, size_A, size_B, &opts) == 1 && opts.engine == TC_ENGINE_FFT,
+          "AUTO entry picks the engine");
+    opts.engine = TC_ENGINE_DIRECT;
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 1, size_A, size_B, &opts) == 0,
+          "AUTO entry skips direct plans");
+
+    // A tuning restricted to direct does not leak into later AUTO plans
+    size_A[0] = 8192;
+    tc_options_init(&opts);
+    opts.engine = TC_ENGINE_DIRECT;
+    tc_tune_result result;
+    check(tc_tune(TC_CROSS_CORRELATION, 1, size_A, size_B, &opts, 0.05, 1, &result) == 0 && result.saved,
+          "tune and save direct-only");
+    tc_options_init(&opts);
+    check(tc_tune_lookup(TC_CROSS_CORRELATION, 1, size_A, size_B, &opts) == 0,
+          "direct-only tuning skips AUTO plans");
+
+    tc_tune_set_db_path("");
+    remove(path);
+}
+
+int main(void) {
+    // Keep the user's database out of the test
+    tc_tune_set_db_path("");
+
+    tc_options opts;
+    tc_options_init(&opts);
+    opts.output = TC_OUTPUT_FULL;
+    tune_2d("full 2D", 61, 77, 5, 7, &opts);
+    tune_2d("full 2D, kernel larger than the input", 6, 9, 11, 13, &opts);
+
+    tc_options_init(&opts);
+    opts.output = TC_OUTPUT_SAME;
+    opts.boundary = TC_BOUNDARY_REFLECT;
+    tune_2d("same 2D", 64, 90, 3, 5, &opts);
+
+    tc_options_init(&opts);
+    opts.output = TC_OUTPUT_SAME;
+    opts.stride[0] = opts.stride[1] = 2;
+    opts.dilation[0] = 3;
+    tune_2d("same 2D, strided and dilated", 70, 81, 3, 3, &opts);
+
+    lookup_keys();
+    lookup_engines();
+
+    if (failures == 0) printf("test_tune: ok\n");
+    return failures ? 1 : 0;
+}